@@ -103,6 +103,15 @@ FIRM_API void be_set_after_transform_func(after_transform_func func);
  */
 FIRM_API void be_main(FILE *output, const char *compilation_unit_name);
 
+/**
+ * Like be_main(), but writes a relocatable ELF object file instead of
+ * assembler text, so no separate assembler run is necessary.
+ * Returns 0 without writing anything if the target does not support writing
+ * object files or the program contains global or inline assembler statements.
+ * The caller then has to fall back to be_main() and an assembler.
+ */
+FIRM_API int be_main_object(FILE *output, const char *compilation_unit_name);
+
 /**
  * parse assembler constraint strings and returns flags (so the frontend knows
  * which operands are inputs/outputs and whether memory is required)
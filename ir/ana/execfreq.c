@@ -24,11 +24,18 @@
  * no path to the end node, which produces undesired results (0, infinite
  * execution frequencies). We alleviate that by adding artificial edges from
  * kept blocks with a path to end.
+ *
+ * The system is sparse: Walking the blocks in reverse postorder, the frequency
+ * of each block is expressed as a linear combination of the frequencies of
+ * the start block and the targets of retreating edges, which stay unknown.
+ * Only the equations of these unknowns are solved, by sparse elimination.
+ * Graphs where the elimination fills in too much are solved with Gauss-Seidel
+ * iterations on the sparse system of all blocks instead.
  */
 #include "execfreq_t.h"
 
 #include "dfs_t.h"
-#include "gaussjordan.h"
+#include "gaussseidel.h"
 #include "hashptr.h"
 #include "iredges_t.h"
 #include "irgraph_t.h"
@@ -53,124 +60,12 @@
 
 #define MAX_INT_FREQ 1000000
 
-static hook_entry_t hook;
-
-typedef struct {
-	unsigned size;
-	double   entries[];
-} square_matrix;
-
-static square_matrix *mat_create(int n)
-{
-	square_matrix *result = xmalloc(sizeof(square_matrix) + n * n * sizeof(double));
-	result->size = n;
-	return result;
-}
-
-/*
- * Algorithm for QR decomposition taken from JAMA/C++ Linear Algebra
- * Library.
- * See http://math.nist.gov/tnt/jama_doxygen/jama_qr_h-source.html.
- * License: Public domain (U.S. government work).
- */
-static inline void setm(square_matrix *a, unsigned row, unsigned col, double val)
-{
-	a->entries[row * a->size + col] = val;
-}
-
-static inline double getm(const square_matrix *a, unsigned row, unsigned col)
-{
-	return a->entries[row * a->size + col];
-}
+/* Upper bound on the terms of all linear combinations, before the sparse
+ * elimination gives up in favour of Gauss-Seidel iterations. */
+#define MAX_LIN_TERMS    (1 << 23)
+#define MAX_GS_ITERS     1000
 
-/**
- * Use QR decomposition to find the nullspace of a (size n * n). This
- * function assumes that rank(a) = n-1.
- */
-static void nullspace(square_matrix *a, double *result)
-{
-	// The nullspace of a is the n-th column of q, where q * r is
-	// the QR decomposition of transpose(a).
-
-	unsigned       n  = a->size;
-	square_matrix *qr = mat_create(n);
-
-	// Transpose a
-	for (unsigned x = 0; x < n; x++) {
-		for (unsigned y = 0; y < n; y++) {
-			double val = getm(a, y, x);
-			setm(qr, x, y, val);
-		}
-	}
-
-	// In-place computation of qr.
-	for (unsigned k = 0; k < n; k++) {
-		// Compute 2-norm of k-th column without under/overflow.
-		double nrm = 0;
-		for (unsigned i = k; i < n; i++) {
-			nrm = hypot(nrm, getm(qr, i, k));
-		}
-
-		if (nrm == 0.0)
-			continue;
-		// Form k-th Householder vector.
-		if (getm(qr, k, k) < 0)
-			nrm = -nrm;
-		for (unsigned i = k; i < n; i++) {
-			double val = getm(qr, i, k);
-			val /= nrm;
-			setm(qr, i, k, val);
-		}
-		double val = getm(qr, k, k);
-		val += 1.0;
-		setm(qr, k, k, val);
-
-		// Apply transformation to remaining columns.
-		for (unsigned j = k+1; j < n; j++) {
-			double s = 0.0;
-			for (unsigned i = k; i < n; i++) {
-				s += getm(qr, i, k) * getm(qr, i, j);
-			}
-			s = -s / getm(qr, k, k);
-			for (unsigned i = k; i < n; i++) {
-				double val = getm(qr, i, j);
-				val += s * getm(qr, i, k);
-				setm(qr, i, j, val);
-			}
-		}
-	}
-
-	square_matrix *q = mat_create(n);
-
-	// Computation of Q from QR.
-	for (unsigned k = n; k-- > 0; ) {
-		for (unsigned i = 0; i < n; i++) {
-			setm(q, i, k, 0.0);
-		}
-		setm(q, k, k, 1.0);
-		for (unsigned j = k; j < n; j++) {
-			if (getm(qr, k, k) == 0)
-				continue;
-			double s = 0.0;
-			for (unsigned i = k; i < n; i++) {
-				s += getm(qr, i, k) * getm(q, i, j);
-			}
-			s = -s / getm(qr, k, k);
-			for (unsigned i = k; i < n; i++) {
-				double val = getm(q, i, j);
-				val += s * getm(qr, i, k);
-				setm(q, i, j, val);
-			}
-		}
-	}
-
-	// Fill nullspace with required information
-	for (unsigned i = 0; i < n; i++) {
-		result[i] = getm(q, i, n-1);
-	}
-	free(qr);
-	free(q);
-}
+static hook_entry_t hook;
 
 double get_block_execfreq(const ir_node *block)
 {
@@ -359,37 +254,395 @@ static void block_walk_no_keeps(ir_node *block)
 }
 
 /**
- * Computes (matrix row r_acc) += (matrix row r_x) * weight.
+ * A term fac * y[var] of a linear combination of the unknowns.
+ * Linear combinations are flexible arrays sorted by var.
  */
-static void add_weighted(square_matrix *mat, unsigned r_acc, unsigned r_x,
-                         double weight)
+typedef struct lin_term_t {
+	unsigned var;
+	double   fac;
+} lin_term_t;
+
+typedef struct execfreq_env_t {
+	lin_term_t **rows;     /**< the frequency of each block by DFS index */
+	unsigned    *var_idx;  /**< DFS index of the block of each unknown */
+	size_t       n_terms;  /**< terms in all linear combinations */
+} execfreq_env_t;
+
+static lin_term_t *lin_new(void)
 {
-	for (unsigned c = 0; c < mat->size; c++) {
-		double val = getm(mat, r_acc, c);
-		val += getm(mat, r_x, c) * weight;
-		setm(mat, r_acc, c, val);
+	return NEW_ARR_F(lin_term_t, 0);
+}
+
+static lin_term_t *lin_find(lin_term_t *lin, unsigned var)
+{
+	size_t lo = 0;
+	size_t hi = ARR_LEN(lin);
+	while (lo < hi) {
+		size_t const mid = lo + (hi - lo) / 2;
+		if (lin[mid].var < var)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+	return lo < ARR_LEN(lin) && lin[lo].var == var ? &lin[lo] : NULL;
 }
 
 /**
- * Computes the row-th entry of mat . vec.
- *
- * The elements in vec must be finite unless mat has a 0 at the
- * corresponding position.
+ * Returns acc + weight * x and frees acc. If @p new_vars is given, the
+ * unknowns only in x are appended to it.
  */
-static double mat_dot_vec_entry(square_matrix *mat, double *vec, int row)
+static lin_term_t *lin_add_weighted(execfreq_env_t *env, lin_term_t *acc,
+                                    lin_term_t const *x, size_t n_x,
+                                    double weight, unsigned **new_vars)
+{
+	size_t const n_acc = ARR_LEN(acc);
+	lin_term_t  *res   = NEW_ARR_F(lin_term_t, n_acc + n_x);
+	size_t       i     = 0;
+	size_t       j     = 0;
+	size_t       n     = 0;
+	while (i < n_acc || j < n_x) {
+		if (j == n_x || (i < n_acc && acc[i].var < x[j].var)) {
+			res[n++] = acc[i++];
+		} else if (i == n_acc || x[j].var < acc[i].var) {
+			if (new_vars)
+				ARR_APP1(unsigned, *new_vars, x[j].var);
+			res[n++] = (lin_term_t){ x[j].var, weight * x[j].fac };
+			++j;
+		} else {
+			res[n++] = (lin_term_t){ acc[i].var, acc[i].fac + weight * x[j].fac };
+			++i;
+			++j;
+		}
+	}
+	ARR_SHRINKLEN(res, n);
+	env->n_terms += n - n_acc;
+	DEL_ARR_F(acc);
+	return res;
+}
+
+static lin_term_t *lin_add_var(execfreq_env_t *env, lin_term_t *acc,
+                               unsigned var, double weight)
+{
+	lin_term_t const term = { var, 1.0 };
+	return lin_add_weighted(env, acc, &term, 1, weight, NULL);
+}
+
+static lin_term_t *lin_remove(lin_term_t *lin, lin_term_t *term)
+{
+	size_t const n = ARR_LEN(lin);
+	memmove(term, term + 1, (char*)&lin[n] - (char*)(term + 1));
+	ARR_SHRINKLEN(lin, n - 1);
+	return lin;
+}
+
+static double lin_eval(lin_term_t const *lin, double const *y)
 {
 	double acc = 0.0;
-	for (unsigned i = 0; i < mat->size; i++) {
-		double val = getm(mat, row, i);
-		if (val == 0)
-			continue;
-		assert(isfinite(vec[i]));
-		acc += val * vec[i];
+	for (size_t i = 0, n = ARR_LEN(lin); i < n; ++i) {
+		assert(isfinite(y[lin[i].var]));
+		acc += lin[i].fac * y[lin[i].var];
 	}
 	return acc;
 }
 
+/**
+ * Solves y[v] = eqs[v] . y for all unknowns v with y[fixed_var] = 1, the
+ * equation of fixed_var is dropped as it depends on the others. The unknowns
+ * are eliminated in reverse order of their creation, i.e. inner loops first,
+ * which keeps the fill-in small. Frees the equations.
+ *
+ * Returns false if the elimination is numerically unstable or fills in too
+ * many terms.
+ */
+static bool solve_lgs(execfreq_env_t *env, lin_term_t **eqs,
+                      unsigned fixed_var, double *y)
+{
+	unsigned const n_vars = ARR_LEN(env->var_idx);
+	/* users[v] contains the equations, which (once) contained v */
+	unsigned     **users  = XMALLOCN(unsigned*, n_vars);
+	bool          *done   = XMALLOCNZ(bool, n_vars);
+	for (unsigned v = 0; v < n_vars; ++v)
+		users[v] = NEW_ARR_F(unsigned, 0);
+	for (unsigned v = 0; v < n_vars; ++v) {
+		for (size_t i = 0, n = ARR_LEN(eqs[v]); i < n; ++i)
+			ARR_APP1(unsigned, users[eqs[v][i].var], v);
+	}
+
+	bool      ok       = true;
+	unsigned *new_vars = NEW_ARR_F(unsigned, 0);
+	for (unsigned p = n_vars; ok && p-- > 0; ) {
+		if (p == fixed_var)
+			continue;
+
+		/* y[p] = fac * y[p] + rest  <=>  y[p] = rest / (1 - fac) */
+		lin_term_t *eq_p  = eqs[p];
+		lin_term_t *self  = lin_find(eq_p, p);
+		double      denom = 1.0 - (self ? self->fac : 0.0);
+		if (!(denom > 0.0)) {
+			ok = false;
+			break;
+		}
+		if (self) {
+			eq_p = eqs[p] = lin_remove(eq_p, self);
+			--env->n_terms;
+		}
+		for (size_t i = 0, n = ARR_LEN(eq_p); i < n; ++i)
+			eq_p[i].fac /= denom;
+		done[p] = true;
+
+		/* substitute y[p] in the remaining equations */
+		for (size_t u = 0; u < ARR_LEN(users[p]); ++u) {
+			unsigned const r = users[p][u];
+			if (done[r] || r == fixed_var)
+				continue;
+			lin_term_t *const term = lin_find(eqs[r], p);
+			if (term == NULL)
+				continue;
+			double const weight = term->fac;
+			eqs[r] = lin_remove(eqs[r], term);
+			--env->n_terms;
+			ARR_SHRINKLEN(new_vars, 0);
+			eqs[r] = lin_add_weighted(env, eqs[r], eq_p, ARR_LEN(eq_p), weight,
+			                          &new_vars);
+			for (size_t i = 0, n = ARR_LEN(new_vars); i < n; ++i)
+				ARR_APP1(unsigned, users[new_vars[i]], r);
+		}
+		if (env->n_terms > MAX_LIN_TERMS)
+			ok = false;
+	}
+	DEL_ARR_F(new_vars);
+
+	if (ok) {
+		/* back substitution, each equation only refers to unknowns
+		 * eliminated later and the fixed one */
+		y[fixed_var] = 1.0;
+		for (unsigned v = 0; v < n_vars; ++v) {
+			if (v != fixed_var)
+				y[v] = lin_eval(eqs[v], y);
+		}
+	}
+
+	for (unsigned v = 0; v < n_vars; ++v) {
+		DEL_ARR_F(eqs[v]);
+		DEL_ARR_F(users[v]);
+	}
+	free(eqs);
+	free(users);
+	free(done);
+	return ok;
+}
+
+static void gs_matrix_add(gs_matrix_t *m, unsigned row, unsigned col,
+                          double val)
+{
+	gs_matrix_set(m, row, col, gs_matrix_get(m, row, col) + val);
+}
+
+/**
+ * Solves the sparse system of all blocks with Gauss-Seidel iterations,
+ * this needs no additional memory but converges slowly for deep loop nests.
+ */
+static bool solve_gauss_seidel(dfs_t *const dfs, ir_graph *irg,
+                               double inv_loop_weight)
+{
+	unsigned const size        = dfs_get_n_nodes(dfs);
+	ir_node *const start_block = get_irg_start_block(irg);
+	ir_node *const end_block   = get_irg_end_block(irg);
+	unsigned const end_idx     = size - dfs_get_post_num(dfs, end_block) - 1;
+	ir_node *const end         = get_irg_end(irg);
+	gs_matrix_t   *m           = gs_new_matrix(size, 4);
+
+	for (unsigned idx = 0; idx < size; ++idx) {
+		ir_node *const bb   = dfs_get_post_num_node(dfs, size - idx - 1);
+		double         diag = -1.0;
+		for (int i = get_Block_n_cfgpreds(bb) - 1; i >= 0; --i) {
+			ir_node *const pred     = get_Block_cfgpred_block(bb, i);
+			unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+			double   const prob     = get_cf_probability(bb, i, inv_loop_weight);
+			if (pred_idx == idx)
+				diag += prob;
+			else
+				gs_matrix_add(m, idx, pred_idx, prob);
+		}
+		if (bb == start_block)
+			gs_matrix_add(m, idx, end_idx, 1.0);
+		if (bb == end_block) {
+			for (unsigned k = get_End_n_keepalives(end); k-- > 0; ) {
+				ir_node *keep = get_End_keepalive(end, k);
+				if (!is_Block(keep) || has_path_to_end(keep))
+					continue;
+				double   sum      = get_sum_succ_factors(keep, inv_loop_weight);
+				unsigned keep_idx = size - dfs_get_post_num(dfs, keep) - 1;
+				gs_matrix_add(m, idx, keep_idx, KEEP_FAC / sum);
+			}
+		}
+		if (diag > -EPSILON) {
+			gs_delete_matrix(m);
+			return false;
+		}
+		gs_matrix_set(m, idx, idx, diag);
+	}
+
+	double *x = NEW_ARR_F(double, size);
+	for (unsigned idx = 0; idx < size; ++idx)
+		x[idx] = 1.0;
+	for (unsigned i = 0; i < MAX_GS_ITERS; ++i) {
+		double const res = gs_matrix_gauss_seidel(m, x);
+		if (res < EPSILON * x[end_idx])
+			break;
+	}
+	gs_delete_matrix(m);
+
+	double const end_freq = x[end_idx];
+	bool         valid    = end_freq > 0.0 && isfinite(end_freq);
+	for (unsigned idx = 0; valid && idx < size; ++idx) {
+		ir_node *const bb   = dfs_get_post_num_node(dfs, size - idx - 1);
+		double   const freq = x[idx] / end_freq;
+		if (isinf(freq) || !(freq >= 0)) {
+			valid = false;
+			break;
+		}
+		set_block_execfreq(bb, freq);
+	}
+	DEL_ARR_F(x);
+	return valid;
+}
+
+/**
+ * Returns the sum of the frequencies of all predecessors of @p bb scaled by
+ * their probability to continue to @p bb, in terms of the unknowns.
+ */
+static lin_term_t *sum_preds(execfreq_env_t *env, dfs_t *const dfs,
+                             ir_node const *bb, double inv_loop_weight)
+{
+	unsigned const size = dfs_get_n_nodes(dfs);
+	lin_term_t    *row  = lin_new();
+	for (int i = get_Block_n_cfgpreds(bb) - 1; i >= 0; --i) {
+		ir_node *const pred           = get_Block_cfgpred_block(bb, i);
+		unsigned const pred_idx       = size - dfs_get_post_num(dfs, pred) - 1;
+		double   const cf_probability = get_cf_probability(bb, i, inv_loop_weight);
+		lin_term_t const *pred_row    = env->rows[pred_idx];
+		row = lin_add_weighted(env, row, pred_row, ARR_LEN(pred_row),
+		                       cf_probability, NULL);
+	}
+	return row;
+}
+
+static bool has_retreating_pred(dfs_t *const dfs, ir_node const *bb,
+                                unsigned idx)
+{
+	unsigned const size = dfs_get_n_nodes(dfs);
+	for (int i = get_Block_n_cfgpreds(bb) - 1; i >= 0; --i) {
+		ir_node *const pred     = get_Block_cfgpred_block(bb, i);
+		unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+		if (pred_idx >= idx)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Expresses the frequency of each block in terms of the unknowns, solves for
+ * them and sets the block frequencies.
+ *
+ * The unknowns are the frequencies of the start block and of the targets of
+ * retreating edges, i.e. the loop headers. Walking the blocks in reverse
+ * postorder, the frequency of every other block is the sum of its
+ * predecessors, so blocks only depend on the headers of their enclosing
+ * loops and of the loops right before them.
+ */
+static bool solve_sparse(dfs_t *const dfs, ir_graph *irg,
+                         double inv_loop_weight)
+{
+	unsigned const size        = dfs_get_n_nodes(dfs);
+	ir_node *const start_block = get_irg_start_block(irg);
+	ir_node *const end_block   = get_irg_end_block(irg);
+	unsigned const end_idx     = size - dfs_get_post_num(dfs, end_block) - 1;
+	ir_node *const end         = get_irg_end(irg);
+
+	execfreq_env_t env;
+	env.rows    = XMALLOCNZ(lin_term_t*, size);
+	env.var_idx = NEW_ARR_F(unsigned, 0);
+	env.n_terms = 0;
+
+	bool ok = true;
+	for (unsigned idx = 0; ok && idx < size; ++idx) {
+		ir_node const *const bb = dfs_get_post_num_node(dfs, size-idx-1);
+		/* The end block is handled properly later, when all the kept blocks
+		 * are done. */
+		if (bb == end_block)
+			continue;
+
+		if (bb == start_block || has_retreating_pred(dfs, bb, idx)) {
+			unsigned const var = ARR_LEN(env.var_idx);
+			ARR_APP1(unsigned, env.var_idx, idx);
+			env.rows[idx] = lin_add_var(&env, lin_new(), var, 1.0);
+		} else {
+			env.rows[idx] = sum_preds(&env, dfs, bb, inv_loop_weight);
+		}
+		if (env.n_terms > MAX_LIN_TERMS)
+			ok = false;
+	}
+
+	double *y = NULL;
+	if (ok) {
+		/* handle end block */
+		lin_term_t *row = sum_preds(&env, dfs, end_block, inv_loop_weight);
+
+		/* add artifical edges from "kept blocks without a path to end"
+		 * to end */
+		for (unsigned k = get_End_n_keepalives(end); k-- > 0; ) {
+			ir_node *keep = get_End_keepalive(end, k);
+			if (!is_Block(keep) || has_path_to_end(keep))
+				continue;
+
+			double   sum      = get_sum_succ_factors(keep, inv_loop_weight);
+			double   fac      = KEEP_FAC/sum;
+			unsigned keep_idx = size - dfs_get_post_num(dfs, keep)-1;
+			lin_term_t const *keep_row = env.rows[keep_idx];
+			row = lin_add_weighted(&env, row, keep_row, ARR_LEN(keep_row), fac,
+			                       NULL);
+		}
+		env.rows[end_idx] = row;
+
+		/* The start block is entered once for each time the end block is
+		 * left, the solution is normalized to a start frequency of 1. */
+		unsigned const n_vars = ARR_LEN(env.var_idx);
+		lin_term_t   **eqs    = XMALLOCN(lin_term_t*, n_vars);
+		for (unsigned v = 0; v < n_vars; ++v) {
+			ir_node const *const bb = dfs_get_post_num_node(dfs, size - env.var_idx[v] - 1);
+			if (bb == start_block)
+				eqs[v] = lin_add_weighted(&env, lin_new(), row, ARR_LEN(row), 1.0, NULL);
+			else
+				eqs[v] = sum_preds(&env, dfs, bb, inv_loop_weight);
+		}
+		y  = NEW_ARR_F(double, n_vars);
+		ok = solve_lgs(&env, eqs, 0, y);
+	}
+
+	/* the frequencies of the blocks follow from the unknowns */
+	for (unsigned idx = 0; ok && idx < size; ++idx) {
+		ir_node *const bb   = dfs_get_post_num_node(dfs, size - idx - 1);
+		double   const freq = lin_eval(env.rows[idx], y);
+		/* Check for inf, nan and negative values. */
+		if (isinf(freq) || !(freq >= 0)) {
+			ok = false;
+			break;
+		}
+		set_block_execfreq(bb, freq);
+	}
+
+	for (unsigned idx = 0; idx < size; ++idx) {
+		if (env.rows[idx])
+			DEL_ARR_F(env.rows[idx]);
+	}
+	free(env.rows);
+	DEL_ARR_F(env.var_idx);
+	if (y)
+		DEL_ARR_F(y);
+	return ok;
+}
+
 /**
  * Fallback solution 1: Use loop weight.
  *
@@ -446,35 +699,10 @@ void ir_estimate_execfreq(ir_graph *irg)
 		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE);
 
 	/* compute a DFS.
-	 * using a toposort on the CFG (without back edges) will propagate
-	 * the values better for the gauss/seidel iteration.
-	 * => they can "flow" from start to end. */
+	 * Walking the blocks in reverse postorder, all predecessors except the
+	 * sources of retreating edges are visited before the block itself. */
 	dfs_t *const dfs = dfs_new(irg);
 
-	unsigned       size   = dfs_get_n_nodes(dfs);
-
-	/* It is undesirable to allocate more than 2GB for the matrix */
-	if (size*size*sizeof(double) > 1 << 30) {
-		if (!fallback_loop_weight(dfs, loop_weight)) {
-			fallback_all_ones(dfs);
-		}
-		dfs_free(dfs);
-		return;
-	}
-
-
-	square_matrix *in_fac = mat_create(size);
-	for (unsigned r = 0; r < size; r++) {
-		for (unsigned c = 0; c < size; c++) {
-			setm(in_fac, r, c, 0.0);
-		}
-	}
-
-
-	ir_node *const start_block = get_irg_start_block(irg);
-	ir_node *const end_block   = get_irg_end_block(irg);
-	const int      end_idx     = size - dfs_get_post_num(dfs, end_block) - 1;
-
 	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED
 	                          | IR_RESOURCE_IRN_VISITED
 	                          | IR_RESOURCE_IRN_LINK);
@@ -483,7 +711,7 @@ void ir_estimate_execfreq(ir_graph *irg)
 	/* mark all blocks reachable from end_block as (block)visited
 	 * (so we can detect places like endless-loops/noreturn calls which
 	 *  do not reach the End block) */
-	block_walk_no_keeps(end_block);
+	block_walk_no_keeps(get_irg_end_block(irg));
 	/* mark all kept blocks as (node)visited */
 	inc_irg_visited(irg);
 	const ir_node *end          = get_irg_end(irg);
@@ -496,158 +724,11 @@ void ir_estimate_execfreq(ir_graph *irg)
 	}
 
 	double const inv_loop_weight = 1.0 / loop_weight;
-	/* lgs_to_mat[i] is the index of the block represented by the
-	 * i-th row/column in the LGS matrix. */
-	int *lgs_to_mat = NEW_ARR_F(int, 0);
-
-	for (unsigned idx = 0; idx < size; ++idx) {
-		ir_node const *const bb = dfs_get_post_num_node(dfs, size-idx-1);
-		/* The end block is handled properly later, when all the kept blocks
-		 * are done. */
-		if (bb == end_block)
-			continue;
-
-		for (int i = get_Block_n_cfgpreds(bb) - 1; i >= 0; --i) {
-			ir_node *const pred           = get_Block_cfgpred_block(bb, i);
-			unsigned const pred_idx       = size - dfs_get_post_num(dfs, pred) - 1;
-			double   const cf_probability = get_cf_probability(bb, i, inv_loop_weight);
-			bool     const pred_visited   = pred_idx < idx;
-
-			if (pred_visited) {
-				add_weighted(in_fac, idx, pred_idx, cf_probability);
-			} else {
-				ARR_APP1(int, lgs_to_mat, pred_idx);
-				setm(in_fac, idx, pred_idx, cf_probability);
-			}
-		}
-
-		if (bb == start_block)
-			setm(in_fac, idx, end_idx, 1.0);
-	}
-
-	/* handle end block */
-	ARR_APP1(int, lgs_to_mat, end_idx);
-	for (int i = get_Block_n_cfgpreds(end_block) - 1; i >= 0; --i) {
-		ir_node *const pred           = get_Block_cfgpred_block(end_block, i);
-		int      const pred_idx       = size - dfs_get_post_num(dfs, pred) - 1;
-		double   const cf_probability = get_cf_probability(end_block, i, inv_loop_weight);
-		add_weighted(in_fac, end_idx, pred_idx, cf_probability);
-	}
-
-	/* add artifical edges from "kept blocks without a path to end"
-	 * to end */
-	for (unsigned k = n_keepalives; k-- > 0; ) {
-		ir_node *keep = get_End_keepalive(end, k);
-		if (!is_Block(keep) || has_path_to_end(keep))
-			continue;
-
-		double sum      = get_sum_succ_factors(keep, inv_loop_weight);
-		double fac      = KEEP_FAC/sum;
-		int    keep_idx = size - dfs_get_post_num(dfs, keep)-1;
-		add_weighted(in_fac, end_idx, keep_idx, fac);
-	}
-
-	/* mat_to_lgs[i] is the index of node i in the LGS matrix, or
-	 * -1 if the node can be solved by simple substitution. */
-	int *mat_to_lgs = NEW_ARR_F(int, size);
-	for (unsigned x = 0; x < size; x++) {
-		mat_to_lgs[x] = -1;
-	}
-	for (unsigned b = 0; b < ARR_LEN(lgs_to_mat); b++) {
-		mat_to_lgs[lgs_to_mat[b]] = b;
-	}
-
-#ifdef DEBUG
-	/* Check that all values in in_fac are only given in terms of nodes with backedges */
-	for (int y = 0; y < size; y++) {
-		if (mat_to_lgs[y] == -1)
-			continue;
-		for (int x = 0; x < size; x++) {
-			if (getm(in_fac, x, y) != 0)
-				panic("expect entry at (%d, %d) to be 0", x, y);
-		}
-	}
-#endif
-
-	/* Build the LGS matrix with only the indices in lgs_to_mat. */
-	unsigned lgs_size = ARR_LEN(lgs_to_mat);
-	square_matrix *lgs_matrix = mat_create(lgs_size);
-	double *lgs_x = NEW_ARR_F(double, size);
-
-	for (unsigned x = 0; x < lgs_size; x++) {
-		int bx = lgs_to_mat[x];
-		for (unsigned y = 0; y < lgs_size; y++) {
-			int by = lgs_to_mat[y];
-			double val = getm(in_fac, bx, by);
-			setm(lgs_matrix, x, y, val);
-		}
-		/* RHS of the equation */
-		double val = getm(lgs_matrix, x, x);
-		val -= 1.0;
-		setm(lgs_matrix, x, x, val);
-	}
-
-	if (lgs_size == 1) {
-		lgs_x[0] = 1.0;
-	} else {
-		nullspace(lgs_matrix, lgs_x);
-	}
-
-	/* compute the normalization factor.
-	 * 1.0 / exec freq of end block.
-	 */
-	double  end_freq   = lgs_x[mat_to_lgs[end_idx]];
-	double  norm       = end_freq != 0.0 ? 1.0 / end_freq : 1.0;
-	double *freqs      = NEW_ARR_F(double, size);
-	bool    valid_freq = true;
-
-	/* First get the frequency for the nodes which were
-	 * explicitly computed. */
-	for (unsigned idx = size; idx-- > 0; ) {
-		ir_node *const bb = dfs_get_post_num_node(dfs, size - idx - 1);
-
-		if (mat_to_lgs[idx] != -1) {
-			double freq = lgs_x[mat_to_lgs[idx]] * norm;
-			/* Check for inf, nan and negative values. */
-			if (isinf(freq) || !(freq >= 0)) {
-				valid_freq = false;
-				break;
-			}
-			set_block_execfreq(bb, freq);
-			freqs[idx] = freq;
-		} else {
-			freqs[idx] = nan("");
-		}
-	}
-
-	if (valid_freq) {
-		/* Now get the rest of the frequencies using the factors in in_fac */
-		for (unsigned idx = size; idx-- > 0; ) {
-			ir_node *const bb = dfs_get_post_num_node(dfs, size - idx - 1);
-
-			if (mat_to_lgs[idx] == -1) {
-				double freq = mat_dot_vec_entry(in_fac, freqs, idx);
-				/* Check for inf, nan and negative values. */
-				if (isinf(freq) || freq < 0) {
-					valid_freq = false;
-					break;
-				}
-				set_block_execfreq(bb, freq);
-			}
-		}
-	}
-
-	DEL_ARR_F(freqs);
-
-	/* Fallbacks in case some frequencies were invalid */
-	if (!valid_freq && !fallback_loop_weight(dfs, loop_weight)) {
+	if (!solve_sparse(dfs, irg, inv_loop_weight)
+	    && !solve_gauss_seidel(dfs, irg, inv_loop_weight)
+	    && !fallback_loop_weight(dfs, loop_weight)) {
 		fallback_all_ones(dfs);
 	}
 
 	free_properties_and_dfs(irg, dfs);
-	DEL_ARR_F(lgs_to_mat);
-	DEL_ARR_F(mat_to_lgs);
-	free(in_fac);
-	free(lgs_matrix);
-	DEL_ARR_F(lgs_x);
 }
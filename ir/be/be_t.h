@@ -145,6 +145,13 @@ bool be_set_arch(char const *arch);
 void be_begin(FILE *output, const char *cup_name);
 void be_finish(void);
 
+/**
+ * Like be_begin() and be_finish(), but for writing an object file, which
+ * the target produces itself. No assembler text is emitted.
+ */
+void be_begin_object(const char *cup_name);
+void be_finish_object(void);
+
 bool be_step_first(ir_graph *irg);
 void be_step_regalloc(ir_graph *irg, const regalloc_if_t *regif);
 void be_step_schedule(ir_graph *irg);
@@ -291,6 +291,12 @@ struct arch_isa_if_t {
 	 */
 	void (*generate_code)(FILE *output, const char *cup_name);
 
+	/**
+	 * Generate a relocatable object file for the current firm program.
+	 * May be NULL if the target only produces assembler text.
+	 */
+	void (*generate_object)(FILE *output, const char *cup_name);
+
 	ir_jit_function_t* (*jit_compile)(ir_jit_segment_t *segment, ir_graph *irg);
 
 	void (*emit_function)(char *buffer, ir_jit_function_t *function);
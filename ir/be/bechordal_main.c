@@ -134,6 +134,15 @@ static void memory_operand_walker(ir_node *irn, void *env)
 		if (get_irn_n_edges(in) > 1)
 			continue;
 		regif->perform_memory_operand(irn, i);
+
+		/* The reload was only used in its block, so it was not live anywhere,
+		 * but the new operands of the folding node may be. */
+		be_lv_t *const lv = be_get_irg_liveness(get_irn_irg(irn));
+		if (lv->sets_valid && get_irn_n(irn, i) != in) {
+			foreach_irn_in(irn, j, op) {
+				be_liveness_update(lv, op);
+			}
+		}
 	}
 }
 
@@ -145,6 +154,10 @@ void check_for_memory_operands(ir_graph *irg, const regalloc_if_t *regif)
 	if (regif->perform_memory_operand == NULL)
 		return;
 	irg_walk_graph(irg, NULL, memory_operand_walker, (void*)regif);
+
+	be_lv_t *const lv = be_get_irg_liveness(irg);
+	if (be_options.do_verify && lv->sets_valid)
+		be_liveness_check(lv);
 }
 
 static be_node_stats_t last_node_stats;
@@ -297,7 +310,8 @@ static void be_ra_chordal_main(ir_graph *irg, const regalloc_if_t *regif)
 	}
 
 	be_timer_push(T_RA_EPILOG);
-	lower_nodes_after_ra(irg, options.lower_perm_opt == BE_CH_LOWER_PERM_COPY);
+	lower_nodes_after_ra(irg, options.lower_perm_opt == BE_CH_LOWER_PERM_COPY,
+	                     regif);
 	be_chordal_dump(BE_CH_DUMP_LOWER, irg, NULL, "belower-after-ra");
 
 	obstack_free(&chordal_env.obst, NULL);
@@ -78,4 +78,11 @@ void be_chordal_dump(unsigned mask, ir_graph *irg, arch_register_class_t const *
 
 void check_for_memory_operands(ir_graph *irg, const regalloc_if_t *regif);
 
+/**
+ * Inserts Perms in front of nodes with register constraints and assigns
+ * registers to all values of the current register class at these nodes.
+ * Requires dominance and liveness sets.
+ */
+void be_chordal_handle_constraints(be_chordal_env_t *env);
+
 #endif
@@ -316,6 +316,16 @@ void be_dwarf_location(dbg_info *dbgi)
 	be_emit_write_line();
 }
 
+bool be_dwarf_enabled(void)
+{
+	return debug_level > LEVEL_NONE;
+}
+
+bool be_dwarf_emits_frameinfo(void)
+{
+	return debug_level >= LEVEL_FRAMEINFO;
+}
+
 void be_dwarf_callframe_register(const arch_register_t *reg)
 {
 	if (debug_level < LEVEL_FRAMEINFO)
@@ -343,6 +353,25 @@ void be_dwarf_callframe_spilloffset(const arch_register_t *reg, int offset)
 	be_emit_write_line();
 }
 
+void be_dwarf_callframe_spillregister(const arch_register_t *reg,
+                                      const arch_register_t *other)
+{
+	if (debug_level < LEVEL_FRAMEINFO)
+		return;
+	be_emit_cstring("\t.cfi_register ");
+	be_emit_irprintf("%d, %d\n", reg->dwarf_number, other->dwarf_number);
+	be_emit_write_line();
+}
+
+void be_dwarf_callframe_restore(const arch_register_t *reg)
+{
+	if (debug_level < LEVEL_FRAMEINFO)
+		return;
+	be_emit_cstring("\t.cfi_restore ");
+	be_emit_irprintf("%d\n", reg->dwarf_number);
+	be_emit_write_line();
+}
+
 static bool is_extern_entity(const ir_entity *entity)
 {
 	ir_visited_t visibility = get_entity_visibility(entity);
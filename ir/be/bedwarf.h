@@ -11,6 +11,8 @@
 #ifndef FIRM_BE_BEDWARF_H
 #define FIRM_BE_BEDWARF_H
 
+#include <stdbool.h>
+
 #include "be_types.h"
 
 typedef struct parameter_dbg_info_t {
@@ -47,6 +49,12 @@ void be_dwarf_variable(const ir_entity *ent);
  * assembly instructions */
 void be_dwarf_location(dbg_info *dbgi);
 
+/** Returns whether any debug information is emitted. */
+bool be_dwarf_enabled(void);
+
+/** Returns whether call frame information is emitted. */
+bool be_dwarf_emits_frameinfo(void);
+
 /** set base register that points to callframe */
 void be_dwarf_callframe_register(const arch_register_t *reg);
 
@@ -62,4 +70,16 @@ void be_dwarf_callframe_offset(int offset);
  */
 void be_dwarf_callframe_spilloffset(const arch_register_t *reg, int offset);
 
+/**
+ * Indicate that a caller saved register has been saved in register @p other.
+ */
+void be_dwarf_callframe_spillregister(const arch_register_t *reg,
+                                      const arch_register_t *other);
+
+/**
+ * Indicate that a caller saved register holds its value from function entry
+ * again.
+ */
+void be_dwarf_callframe_restore(const arch_register_t *reg);
+
 #endif
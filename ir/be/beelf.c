@@ -0,0 +1,838 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Writes relocatable ELF object files.
+ *
+ * The code of the functions comes from the binary emitter, global variables
+ * and constants are laid out like begnuas.c does it for the assembler.
+ * Without section groups, COMDAT definitions are weak symbols in the normal
+ * sections.
+ */
+#include "beelf.h"
+
+#include "array.h"
+#include "begnuas.h"
+#include "bitfiddle.h"
+#include "entity_t.h"
+#include "irprog_t.h"
+#include "obst.h"
+#include "panic.h"
+#include "pmap.h"
+#include "target_t.h"
+#include "tv.h"
+#include "util.h"
+#include <string.h>
+
+enum {
+	ELFCLASS64    = 2,
+	ELFDATA2LSB   = 1,
+	ELFDATA2MSB   = 2,
+	EV_CURRENT    = 1,
+	ET_REL        = 1,
+	EHDR_SIZE     = 64,
+	SHDR_SIZE     = 64,
+	SYM_SIZE      = 24,
+	RELA_SIZE     = 24,
+
+	SHT_PROGBITS  = 1,
+	SHT_SYMTAB    = 2,
+	SHT_STRTAB    = 3,
+	SHT_RELA      = 4,
+	SHT_NOBITS    = 8,
+
+	SHF_WRITE     = 0x1,
+	SHF_ALLOC     = 0x2,
+	SHF_EXECINSTR = 0x4,
+	SHF_INFO_LINK = 0x40,
+	SHF_TLS       = 0x400,
+
+	SHN_UNDEF     = 0,
+	SHN_ABS       = 0xFFF1,
+	SHN_COMMON    = 0xFFF2,
+
+	STB_LOCAL     = 0,
+	STB_GLOBAL    = 1,
+	STB_WEAK      = 2,
+
+	STT_NOTYPE    = 0,
+	STT_OBJECT    = 1,
+	STT_FUNC      = 2,
+	STT_FILE      = 4,
+	STT_TLS       = 6,
+
+	STV_DEFAULT   = 0,
+	STV_HIDDEN    = 2,
+	STV_PROTECTED = 3,
+};
+
+typedef struct elf_relocation_t {
+	uint64_t   offset;
+	uint32_t   type;
+	ir_entity *entity;
+	int64_t    addend;
+} elf_relocation_t;
+
+typedef struct elf_section_t {
+	char const       *name;
+	uint32_t          type;
+	uint64_t          flags;
+	uint64_t          alignment;
+	uint64_t          size;
+	char             *data;        /**< contents, NULL for SHT_NOBITS */
+	elf_relocation_t *relocations;
+	uint32_t          index;
+	uint32_t          link;
+	uint32_t          info;
+	uint64_t          entsize;
+	uint32_t          name_offset;
+	uint64_t          file_offset;
+} elf_section_t;
+
+typedef struct elf_symbol_t {
+	ir_entity const *entity;
+	ir_entity const *alias;   /**< aliased entity, if any */
+	elf_section_t   *section; /**< NULL for undefined and common symbols */
+	uint64_t         value;
+	uint64_t         size;
+	uint8_t          type;
+	bool             common;
+	uint32_t         index;
+} elf_symbol_t;
+
+typedef struct elf_sectioninfo_t {
+	char const *name;
+	uint32_t    type;
+	uint64_t    flags;
+} elf_sectioninfo_t;
+
+static const elf_sectioninfo_t elf_sectioninfos[] = {
+	[GAS_SECTION_TEXT]         = { "text",              SHT_PROGBITS, SHF_ALLOC | SHF_EXECINSTR },
+	[GAS_SECTION_DATA]         = { "data",              SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_RODATA]       = { "rodata",            SHT_PROGBITS, SHF_ALLOC                 },
+	[GAS_SECTION_REL_RO_LOCAL] = { "data.rel.ro.local", SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_REL_RO]       = { "data.rel.ro",       SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_BSS]          = { "bss",               SHT_NOBITS,   SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_CONSTRUCTORS] = { "ctors",             SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_DESTRUCTORS]  = { "dtors",             SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+	[GAS_SECTION_JCR]          = { "jcr",               SHT_PROGBITS, SHF_ALLOC | SHF_WRITE     },
+};
+
+static be_elf_target_t const *target;
+static char const            *cup_name;
+static struct obstack         obst;
+/** all sections in the order of their indices, index 0 is the null section */
+static elf_section_t        **sections;
+/** sections for global data and code, indexed by TLS flag and base section */
+static elf_section_t         *content_sections[2][ARRAY_SIZE(elf_sectioninfos)];
+/** all symbols in the order of their creation */
+static elf_symbol_t         **symbols;
+static pmap                  *entity_symbols;
+
+/* the function currently written by be_elf_emit_function() */
+static elf_section_t *function_section;
+static char const    *function_buffer;
+static uint64_t       function_offset;
+
+static uint64_t align_offset(uint64_t const offset, uint64_t const alignment)
+{
+	assert(is_po2_or_zero(alignment) && alignment > 0);
+	return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+/** Stores the lowest @p size bytes of @p value in target byte order. */
+static void write_value(char *const dst, uint64_t const value,
+                        unsigned const size)
+{
+	bool const big_endian = ir_target_big_endian();
+	for (unsigned i = 0; i < size; ++i) {
+		unsigned const shift = 8 * (big_endian ? size - 1 - i : i);
+		dst[i] = shift < 64 ? (char)(value >> shift) : 0;
+	}
+}
+
+static void put_value(char **const buffer, uint64_t const value,
+                      unsigned const size)
+{
+	size_t const offset = ARR_LEN(*buffer);
+	ARR_RESIZE(char, *buffer, offset + size);
+	write_value(*buffer + offset, value, size);
+}
+
+static uint32_t put_string(char **const buffer, char const *const prefix,
+                           char const *const string)
+{
+	size_t const offset     = ARR_LEN(*buffer);
+	size_t const prefix_len = strlen(prefix);
+	size_t const len        = strlen(string);
+	ARR_RESIZE(char, *buffer, offset + prefix_len + len + 1);
+	memcpy(*buffer + offset, prefix, prefix_len);
+	memcpy(*buffer + offset + prefix_len, string, len + 1);
+	return offset;
+}
+
+static elf_section_t *new_section(char const *const name, uint32_t const type,
+                                  uint64_t const flags)
+{
+	elf_section_t *const section = OALLOCZ(&obst, elf_section_t);
+	section->name        = name;
+	section->type        = type;
+	section->flags       = flags;
+	section->alignment   = 1;
+	section->data        = type != SHT_NOBITS ? NEW_ARR_F(char, 0) : NULL;
+	section->relocations = NEW_ARR_F(elf_relocation_t, 0);
+	section->index       = ARR_LEN(sections);
+	ARR_APP1(elf_section_t*, sections, section);
+	return section;
+}
+
+static elf_section_t *get_content_section(be_gas_section_t const section)
+{
+	be_gas_section_t const base = section & GAS_SECTION_TYPE_MASK;
+	bool             const tls  = section & GAS_SECTION_FLAG_TLS;
+	if (base >= ARRAY_SIZE(elf_sectioninfos) || !elf_sectioninfos[base].name)
+		panic("section %u not supported in object files", (unsigned)base);
+
+	elf_section_t **const slot = &content_sections[tls][base];
+	if (*slot == NULL) {
+		elf_sectioninfo_t const *const info = &elf_sectioninfos[base];
+		obstack_printf(&obst, ".%s%s", tls ? "t" : "", info->name);
+		obstack_1grow(&obst, '\0');
+		char const *const name  = (char const*)obstack_finish(&obst);
+		uint64_t    const flags = info->flags | (tls ? SHF_TLS : 0);
+		*slot = new_section(name, info->type, flags);
+	}
+	return *slot;
+}
+
+/**
+ * Reserves @p size zeroed bytes with the given alignment at the end of
+ * @p section and returns their offset.
+ */
+static uint64_t allocate(elf_section_t *const section,
+                         unsigned const alignment, uint64_t const size)
+{
+	section->alignment = MAX(section->alignment, alignment);
+	uint64_t const offset = align_offset(section->size, alignment);
+	section->size = offset + size;
+	if (section->data != NULL) {
+		size_t const old_len = ARR_LEN(section->data);
+		ARR_RESIZE(char, section->data, section->size);
+		memset(section->data + old_len, 0, section->size - old_len);
+	}
+	return offset;
+}
+
+static elf_symbol_t *get_symbol(ir_entity const *const entity)
+{
+	elf_symbol_t *symbol = pmap_get(elf_symbol_t, entity_symbols, entity);
+	if (symbol == NULL) {
+		if (get_entity_kind(entity) == IR_ENTITY_LABEL)
+			panic("address of label %+F not supported in object files",
+			      entity);
+		symbol = OALLOCZ(&obst, elf_symbol_t);
+		symbol->entity = entity;
+		symbol->type   = get_entity_owner(entity) == get_tls_type()
+		               ? STT_TLS : STT_NOTYPE;
+		pmap_insert(entity_symbols, entity, symbol);
+		ARR_APP1(elf_symbol_t*, symbols, symbol);
+	}
+	return symbol;
+}
+
+static void define_symbol(ir_entity const *const entity,
+                          elf_section_t *const section, uint64_t const value,
+                          uint64_t const size, uint8_t const type)
+{
+	elf_symbol_t *const symbol = get_symbol(entity);
+	assert(symbol->section == NULL && !symbol->common);
+	symbol->section = section;
+	symbol->value   = value;
+	symbol->size    = size;
+	symbol->type    = type;
+}
+
+static void add_relocation(elf_section_t *const section, uint64_t const offset,
+                           uint32_t const type, ir_entity *const entity,
+                           int64_t const addend)
+{
+	get_symbol(entity);
+	elf_relocation_t const relocation = {
+		.offset = offset,
+		.type   = type,
+		.entity = entity,
+		.addend = addend,
+	};
+	ARR_APP1(elf_relocation_t, section->relocations, relocation);
+}
+
+void be_elf_begin(be_elf_target_t const *const elf_target,
+                  char const *const name)
+{
+	assert(ir_target.isa->pointer_size == 8);
+	target   = elf_target;
+	cup_name = name;
+	obstack_init(&obst);
+	sections       = NEW_ARR_F(elf_section_t*, 1);
+	sections[0]    = NULL;
+	symbols        = NEW_ARR_F(elf_symbol_t*, 0);
+	entity_symbols = pmap_create();
+	memset(content_sections, 0, sizeof(content_sections));
+}
+
+void be_elf_emit_function(ir_entity const *const entity, unsigned const p2align,
+                          ir_jit_function_t *const function,
+                          be_jit_emit_interface_t const *const emitter)
+{
+	be_gas_section_t const section = be_gas_determine_section(NULL, entity);
+	elf_section_t   *const text    = get_content_section(section);
+	uint64_t         const end     = text->size;
+	unsigned         const size    = be_get_function_size(function);
+	uint64_t         const offset  = allocate(text, 1U << p2align, size);
+	if (offset > end)
+		emitter->nops(text->data + end, offset - end);
+
+	function_section = text;
+	function_buffer  = text->data + offset;
+	function_offset  = offset;
+	be_jit_emit_memory(text->data + offset, function, emitter);
+	function_section = NULL;
+
+	define_symbol(entity, text, offset, size, STT_FUNC);
+}
+
+void be_elf_add_relocation(char const *const where, uint32_t const type,
+                           ir_entity *const entity, int64_t const addend)
+{
+	assert(function_section != NULL);
+	assert(function_buffer <= where);
+	uint64_t const offset = function_offset + (where - function_buffer);
+	add_relocation(function_section, offset, type, entity, addend);
+}
+
+static void write_tarval(char *const dst, ir_tarval *const tv,
+                         unsigned const size)
+{
+	bool const big_endian = ir_target_big_endian();
+	for (unsigned i = 0; i < size; ++i) {
+		dst[big_endian ? size - 1 - i : i] = get_tarval_sub_bits(tv, i);
+	}
+}
+
+/**
+ * Evaluates an initializer expression. An entity, whose address is part of
+ * the value, is returned in @p entity.
+ */
+static uint64_t eval_expression(ir_node *const node, ir_entity **const entity)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Conv:
+		return eval_expression(get_Conv_op(node), entity);
+
+	case iro_Const: {
+		ir_tarval *const tv    = get_Const_tarval(node);
+		uint64_t         value = 0;
+		for (unsigned i = get_mode_size_bytes(get_tarval_mode(tv)); i-- != 0;) {
+			value = value << 8 | get_tarval_sub_bits(tv, i);
+		}
+		return value;
+	}
+
+	case iro_Address:
+		*entity = get_Address_entity(node);
+		return 0;
+
+	case iro_Offset:
+		return get_entity_offset(get_Offset_entity(node));
+
+	case iro_Align:
+		return get_type_alignment(get_Align_type(node));
+
+	case iro_Size:
+		return get_type_size(get_Size_type(node));
+
+	case iro_Add:
+	case iro_Sub:
+	case iro_Mul: {
+		ir_entity     *left_entity  = NULL;
+		ir_entity     *right_entity = NULL;
+		uint64_t const left  = eval_expression(get_binop_left(node), &left_entity);
+		uint64_t const right = eval_expression(get_binop_right(node), &right_entity);
+		if (is_Sub(node)) {
+			/* the difference of two addresses needs no relocation only
+			 * within the same entity */
+			if (right_entity != NULL && right_entity != left_entity)
+				panic("unsupported address difference in %+F", node);
+			*entity = right_entity != NULL ? NULL : left_entity;
+			return left - right;
+		}
+		if (is_Mul(node) && (left_entity != NULL || right_entity != NULL))
+			panic("cannot multiply address in %+F", node);
+		if (left_entity != NULL && right_entity != NULL)
+			panic("cannot add two addresses in %+F", node);
+		*entity = left_entity != NULL ? left_entity : right_entity;
+		return is_Mul(node) ? left * right : left + right;
+	}
+
+	case iro_Unknown:
+		return 0;
+
+	default:
+		panic("unsupported IR-node %+F", node);
+	}
+}
+
+static void write_node(elf_section_t *const section, uint64_t const offset,
+                       ir_node *const node, ir_type *const type)
+{
+	unsigned const size = get_type_size(type);
+	char    *const dst  = section->data + offset;
+	if (size > 8) {
+		if (!is_Const(node))
+			panic("%u byte initializers only support Const nodes yet", size);
+		write_tarval(dst, get_Const_tarval(node), size);
+		return;
+	}
+
+	ir_entity     *entity = NULL;
+	uint64_t const value  = eval_expression(node, &entity);
+	if (entity == NULL) {
+		write_value(dst, value, size);
+		return;
+	}
+
+	uint32_t reloc_type;
+	switch (size) {
+	case 4:  reloc_type = target->reloc_abs32; break;
+	case 8:  reloc_type = target->reloc_abs64; break;
+	default: panic("unsupported %u byte address in initializer", size);
+	}
+	add_relocation(section, offset, reloc_type, entity, (int64_t)value);
+}
+
+static void write_bitfield(char *const dst, unsigned const offset_bits,
+                           unsigned const bitfield_size,
+                           ir_initializer_t const *const initializer,
+                           ir_type *const type)
+{
+	ir_tarval *tv = NULL;
+	switch (get_initializer_kind(initializer)) {
+	case IR_INITIALIZER_NULL:
+		return;
+	case IR_INITIALIZER_TARVAL:
+		tv = get_initializer_tarval_value(initializer);
+		break;
+	case IR_INITIALIZER_CONST: {
+		ir_node *const node = get_initializer_const_value(initializer);
+		if (!is_Const(node))
+			panic("bitfield initializer not a Const node");
+		tv = get_Const_tarval(node);
+		break;
+	}
+	case IR_INITIALIZER_COMPOUND:
+		panic("bitfield initializer is compound");
+	}
+	if (!tv || tv == tarval_bad)
+		panic("couldn't get numeric value for bitfield initializer");
+
+	unsigned const value_len  = get_type_size(type);
+	bool     const big_endian = ir_target_big_endian();
+	for (unsigned bit = 0; bit < bitfield_size; ++bit) {
+		if (!(get_tarval_sub_bits(tv, bit / 8) >> bit % 8 & 1))
+			continue;
+		unsigned const dst_bit  = offset_bits + bit;
+		unsigned const dst_byte = big_endian ? value_len - dst_bit / 8 - 1
+		                                     : dst_bit / 8;
+		dst[dst_byte] |= 1 << dst_bit % 8;
+	}
+}
+
+static void write_initializer(elf_section_t *const section,
+                              uint64_t const offset,
+                              ir_initializer_t const *const initializer,
+                              ir_type *const type)
+{
+	switch (get_initializer_kind(initializer)) {
+	case IR_INITIALIZER_NULL:
+		return;
+
+	case IR_INITIALIZER_TARVAL:
+		write_tarval(section->data + offset,
+		             get_initializer_tarval_value(initializer),
+		             get_type_size(type));
+		return;
+
+	case IR_INITIALIZER_CONST:
+		write_node(section, offset, get_initializer_const_value(initializer),
+		           type);
+		return;
+
+	case IR_INITIALIZER_COMPOUND:
+		if (is_Array_type(type)) {
+			ir_type *element_type = get_array_element_type(type);
+			size_t   skip         = get_type_size(element_type);
+			size_t   alignment    = get_type_alignment(element_type);
+			size_t   misalign     = skip % alignment;
+			if (misalign != 0)
+				skip += alignment - misalign;
+
+			for (size_t i = 0,
+			     n = get_initializer_compound_n_entries(initializer);
+			     i < n; ++i) {
+				ir_initializer_t const *const sub_initializer
+					= get_initializer_compound_value(initializer, i);
+				write_initializer(section, offset + i * skip, sub_initializer,
+				                  element_type);
+			}
+		} else {
+			assert(is_compound_type(type));
+			for (size_t i = 0, n_members = get_compound_n_members(type);
+			     i < n_members; ++i) {
+				ir_entity *const member        = get_compound_member(type, i);
+				uint64_t   const member_offset = offset + get_entity_offset(member);
+
+				assert(i < get_initializer_compound_n_entries(initializer));
+				ir_initializer_t const *const sub_initializer
+					= get_initializer_compound_value(initializer, i);
+
+				ir_type *const subtype       = get_entity_type(member);
+				unsigned const bitfield_size = get_entity_bitfield_size(member);
+				if (bitfield_size > 0) {
+					write_bitfield(section->data + member_offset,
+					               get_entity_bitfield_offset(member),
+					               bitfield_size, sub_initializer, subtype);
+					continue;
+				}
+
+				write_initializer(section, member_offset, sub_initializer,
+				                  subtype);
+			}
+		}
+		return;
+	}
+	panic("invalid ir_initializer kind found");
+}
+
+/**
+ * Adds a global entity, like emit_global() in begnuas.c does.
+ */
+static void emit_global(ir_entity *const entity)
+{
+	ir_entity_kind const kind = get_entity_kind(entity);
+
+	/* Block labels are part of the code, functions were emitted with it. */
+	if (kind == IR_ENTITY_LABEL || kind == IR_ENTITY_METHOD)
+		return;
+
+	be_gas_section_t const section = be_gas_determine_section(NULL, entity);
+	ir_visibility    const visibility       = get_entity_visibility(entity);
+	ir_linkage       const linkage          = get_entity_linkage(entity);
+	bool             const zero_initializer = be_gas_entity_is_zero_initialized(entity);
+	unsigned         const alignment        = be_gas_get_effective_entity_alignment(entity);
+	unsigned long          size             = be_gas_compute_entity_size(entity);
+	if (size == 0)
+		size = 1;
+	if (!is_po2_or_zero(alignment))
+		panic("alignment not a power of 2");
+
+	ir_type *const type     = get_entity_type(entity);
+	uint8_t  const sym_type = section & GAS_SECTION_FLAG_TLS
+	                        ? STT_TLS : STT_OBJECT;
+	if ((linkage & IR_LINKAGE_MERGE || zero_initializer)
+	  && !(section & GAS_SECTION_FLAG_TLS)) {
+		switch (visibility) {
+		case ir_visibility_external:
+		case ir_visibility_external_private:
+		case ir_visibility_external_protected:
+			if (linkage & IR_LINKAGE_MERGE) {
+				elf_symbol_t *const symbol = get_symbol(entity);
+				symbol->common = true;
+				symbol->value  = MAX(alignment, 1);
+				symbol->size   = size;
+				symbol->type   = STT_OBJECT;
+				return;
+			}
+			break;
+		case ir_visibility_local:
+		case ir_visibility_private:
+			if (!(linkage & IR_LINKAGE_CONSTANT)) {
+				/* local common symbols end up in the bss section */
+				elf_section_t *const bss    = get_content_section(GAS_SECTION_BSS);
+				uint64_t       const offset = allocate(bss, MAX(alignment, 1), size);
+				define_symbol(entity, bss, offset, get_type_size(type), sym_type);
+				return;
+			}
+			break;
+		}
+	}
+
+	/* nothing left to do without an initializer */
+	if (!entity_has_definition(entity))
+		return;
+
+	if (kind == IR_ENTITY_ALIAS) {
+		get_symbol(entity)->alias = get_entity_alias(entity);
+		return;
+	}
+
+	elf_section_t *const elf_section = get_content_section(section);
+	uint64_t       const offset      = allocate(elf_section, MAX(alignment, 1), size);
+	define_symbol(entity, elf_section, offset, get_type_size(type), sym_type);
+	if (!zero_initializer)
+		write_initializer(elf_section, offset, get_entity_initializer(entity),
+		                  type);
+}
+
+static void emit_globals(ir_type *const gt)
+{
+	for (size_t i = 0, n = get_compound_n_members(gt); i < n; i++) {
+		ir_entity *const ent = get_compound_member(gt, i);
+		if (!(get_entity_linkage(ent) & IR_LINKAGE_NO_CODEGEN))
+			emit_global(ent);
+	}
+}
+
+static void resolve_aliases(void)
+{
+	for (size_t i = 0, n = ARR_LEN(symbols); i < n; ++i) {
+		elf_symbol_t *const symbol = symbols[i];
+		if (symbol->alias == NULL)
+			continue;
+		elf_symbol_t const *const aliased
+			= pmap_get(elf_symbol_t const, entity_symbols, symbol->alias);
+		if (aliased == NULL || aliased->section == NULL)
+			panic("alias %+F of %+F, which is not defined in this file",
+			      symbol->entity, symbol->alias);
+		symbol->section = aliased->section;
+		symbol->value   = aliased->value;
+		symbol->size    = aliased->size;
+		symbol->type    = aliased->type;
+	}
+}
+
+static uint8_t get_binding(elf_symbol_t const *const symbol)
+{
+	ir_entity const *const entity = symbol->entity;
+	switch (get_entity_visibility(entity)) {
+	case ir_visibility_local:
+	case ir_visibility_private:
+		return STB_LOCAL;
+	default:
+		break;
+	}
+	ir_linkage const linkage = get_entity_linkage(entity);
+	if (linkage & IR_LINKAGE_WEAK)
+		return STB_WEAK;
+	/* definitions of COMDAT entities may appear in several object files */
+	if (symbol->section != NULL && linkage & IR_LINKAGE_MERGE
+	 && linkage & IR_LINKAGE_GARBAGE_COLLECT)
+		return STB_WEAK;
+	return STB_GLOBAL;
+}
+
+static uint8_t get_other(ir_entity const *const entity)
+{
+	switch (get_entity_visibility(entity)) {
+	case ir_visibility_external_private:   return STV_HIDDEN;
+	case ir_visibility_external_protected: return STV_PROTECTED;
+	default:                               return STV_DEFAULT;
+	}
+}
+
+static void put_symbol(char **const buffer, uint32_t const name,
+                       uint8_t const binding, uint8_t const type,
+                       uint8_t const other, uint16_t const shndx,
+                       uint64_t const value, uint64_t const size)
+{
+	put_value(buffer, name, 4);
+	put_value(buffer, binding << 4 | type, 1);
+	put_value(buffer, other, 1);
+	put_value(buffer, shndx, 2);
+	put_value(buffer, value, 8);
+	put_value(buffer, size, 8);
+}
+
+/**
+ * Fills the symbol and string tables. Local symbols have to come first.
+ */
+static void write_symbols(elf_section_t *const symtab,
+                          elf_section_t *const strtab)
+{
+	put_string(&strtab->data, "", "");
+	put_symbol(&symtab->data, 0, STB_LOCAL, STT_NOTYPE, STV_DEFAULT,
+	           SHN_UNDEF, 0, 0);
+	uint32_t index = 1;
+	if (cup_name != NULL) {
+		uint32_t const name = put_string(&strtab->data, "", cup_name);
+		put_symbol(&symtab->data, name, STB_LOCAL, STT_FILE, STV_DEFAULT,
+		           SHN_ABS, 0, 0);
+		++index;
+	}
+
+	for (int local = 1; local >= 0; --local) {
+		if (!local)
+			symtab->info = index;
+		for (size_t i = 0, n = ARR_LEN(symbols); i < n; ++i) {
+			elf_symbol_t *const symbol  = symbols[i];
+			uint8_t       const binding = get_binding(symbol);
+			if ((binding == STB_LOCAL) != local)
+				continue;
+
+			ir_entity const *const entity = symbol->entity;
+			char const      *const prefix
+				= get_entity_visibility(entity) == ir_visibility_private
+				? be_gas_get_private_prefix() : "";
+			uint32_t const name
+				= put_string(&strtab->data, prefix, get_entity_ld_name(entity));
+			uint16_t const shndx
+				= symbol->section != NULL ? symbol->section->index
+				: symbol->common          ? SHN_COMMON
+				:                           SHN_UNDEF;
+			put_symbol(&symtab->data, name, binding, symbol->type,
+			           get_other(entity), shndx, symbol->value, symbol->size);
+			symbol->index = index++;
+		}
+	}
+}
+
+static void write_relocations(elf_section_t *const rela,
+                              elf_section_t const *const section)
+{
+	for (size_t i = 0, n = ARR_LEN(section->relocations); i < n; ++i) {
+		elf_relocation_t const *const relocation = &section->relocations[i];
+		elf_symbol_t const *const symbol
+			= pmap_get(elf_symbol_t const, entity_symbols, relocation->entity);
+		put_value(&rela->data, relocation->offset, 8);
+		put_value(&rela->data, (uint64_t)symbol->index << 32 | relocation->type, 8);
+		put_value(&rela->data, (uint64_t)relocation->addend, 8);
+	}
+}
+
+static void write_file(FILE *const output, uint16_t const shstrndx)
+{
+	char *file = NEW_ARR_F(char, 0);
+
+	/* ELF header, the offset of the section headers is patched below */
+	static char const ident[] = { 0x7F, 'E', 'L', 'F' };
+	for (size_t i = 0; i < ARRAY_SIZE(ident); ++i)
+		put_value(&file, ident[i], 1);
+	put_value(&file, ELFCLASS64, 1);
+	put_value(&file, ir_target_big_endian() ? ELFDATA2MSB : ELFDATA2LSB, 1);
+	put_value(&file, EV_CURRENT, 1);
+	put_value(&file, 0, 9);
+	put_value(&file, ET_REL, 2);
+	put_value(&file, target->machine, 2);
+	put_value(&file, EV_CURRENT, 4);
+	put_value(&file, 0, 8);  /* e_entry */
+	put_value(&file, 0, 8);  /* e_phoff */
+	put_value(&file, 0, 8);  /* e_shoff */
+	put_value(&file, target->flags, 4);
+	put_value(&file, EHDR_SIZE, 2);
+	put_value(&file, 0, 2);  /* e_phentsize */
+	put_value(&file, 0, 2);  /* e_phnum */
+	put_value(&file, SHDR_SIZE, 2);
+	put_value(&file, ARR_LEN(sections), 2);
+	put_value(&file, shstrndx, 2);
+	assert(ARR_LEN(file) == EHDR_SIZE);
+
+	for (size_t i = 1, n = ARR_LEN(sections); i < n; ++i) {
+		elf_section_t *const section = sections[i];
+		if (section->data == NULL)
+			continue;
+		size_t const offset = align_offset(ARR_LEN(file), section->alignment);
+		put_value(&file, 0, offset - ARR_LEN(file));
+		section->file_offset = offset;
+		size_t const len = ARR_LEN(section->data);
+		ARR_RESIZE(char, file, offset + len);
+		memcpy(file + offset, section->data, len);
+	}
+
+	size_t const shoff = align_offset(ARR_LEN(file), 8);
+	put_value(&file, 0, shoff - ARR_LEN(file));
+	write_value(file + 40, shoff, 8);
+
+	put_value(&file, 0, SHDR_SIZE);
+	for (size_t i = 1, n = ARR_LEN(sections); i < n; ++i) {
+		elf_section_t const *const section = sections[i];
+		uint64_t const size = section->data != NULL ? ARR_LEN(section->data)
+		                                            : section->size;
+		put_value(&file, section->name_offset, 4);
+		put_value(&file, section->type, 4);
+		put_value(&file, section->flags, 8);
+		put_value(&file, 0, 8);  /* sh_addr */
+		put_value(&file, section->file_offset, 8);
+		put_value(&file, size, 8);
+		put_value(&file, section->link, 4);
+		put_value(&file, section->info, 4);
+		put_value(&file, section->alignment, 8);
+		put_value(&file, section->entsize, 8);
+	}
+
+	fwrite(file, 1, ARR_LEN(file), output);
+	DEL_ARR_F(file);
+}
+
+void be_elf_finish(FILE *const output)
+{
+	emit_globals(get_glob_type());
+	emit_globals(get_tls_type());
+	emit_globals(get_segment_type(IR_SEGMENT_CONSTRUCTORS));
+	emit_globals(get_segment_type(IR_SEGMENT_DESTRUCTORS));
+	emit_globals(get_segment_type(IR_SEGMENT_JCR));
+	resolve_aliases();
+
+	/* relocation sections follow the sections they apply to */
+	size_t const n_content = ARR_LEN(sections);
+	for (size_t i = 1; i < n_content; ++i) {
+		elf_section_t *const section = sections[i];
+		if (ARR_LEN(section->relocations) == 0)
+			continue;
+		obstack_printf(&obst, ".rela%s", section->name);
+		obstack_1grow(&obst, '\0');
+		char const    *const name = (char const*)obstack_finish(&obst);
+		elf_section_t *const rela = new_section(name, SHT_RELA, SHF_INFO_LINK);
+		rela->alignment = 8;
+		rela->entsize   = RELA_SIZE;
+		rela->info      = section->index;
+	}
+	size_t const n_rela = ARR_LEN(sections);
+
+	/* no executable stack */
+	new_section(".note.GNU-stack", SHT_PROGBITS, 0);
+
+	elf_section_t *const symtab   = new_section(".symtab", SHT_SYMTAB, 0);
+	elf_section_t *const strtab   = new_section(".strtab", SHT_STRTAB, 0);
+	elf_section_t *const shstrtab = new_section(".shstrtab", SHT_STRTAB, 0);
+	symtab->alignment = 8;
+	symtab->entsize   = SYM_SIZE;
+	symtab->link      = strtab->index;
+
+	write_symbols(symtab, strtab);
+	for (size_t i = n_content; i < n_rela; ++i) {
+		elf_section_t *const rela = sections[i];
+		rela->link = symtab->index;
+		write_relocations(rela, sections[rela->info]);
+	}
+
+	put_string(&shstrtab->data, "", "");
+	for (size_t i = 1, n = ARR_LEN(sections); i < n; ++i) {
+		elf_section_t *const section = sections[i];
+		section->name_offset = put_string(&shstrtab->data, "", section->name);
+	}
+
+	write_file(output, shstrtab->index);
+
+	for (size_t i = 1, n = ARR_LEN(sections); i < n; ++i) {
+		elf_section_t *const section = sections[i];
+		if (section->data != NULL)
+			DEL_ARR_F(section->data);
+		DEL_ARR_F(section->relocations);
+	}
+	DEL_ARR_F(sections);
+	DEL_ARR_F(symbols);
+	pmap_destroy(entity_symbols);
+	obstack_free(&obst, NULL);
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Writes relocatable ELF object files.
+ */
+#ifndef FIRM_BE_BEELF_H
+#define FIRM_BE_BEELF_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bejit.h"
+#include "firm_types.h"
+
+/**
+ * Target specific description of the object file.
+ */
+typedef struct be_elf_target_t {
+	uint16_t machine;     /**< e_machine of the ELF header */
+	uint32_t flags;       /**< e_flags of the ELF header */
+	uint32_t reloc_abs32; /**< relocation type of 32 bit addresses in data */
+	uint32_t reloc_abs64; /**< relocation type of 64 bit addresses in data */
+} be_elf_target_t;
+
+/**
+ * Starts a new object file for a 64 bit @p target.
+ */
+void be_elf_begin(be_elf_target_t const *target, char const *cup_name);
+
+/**
+ * Appends the code of @p function for @p entity to the text section.
+ * The relocation callback of @p emitter resolves relocations between
+ * fragments itself and passes relocations of entities to
+ * be_elf_add_relocation().
+ *
+ * @param p2align  the function is aligned to 2^p2align bytes
+ */
+void be_elf_emit_function(ir_entity const *entity, unsigned p2align,
+                          ir_jit_function_t *function,
+                          be_jit_emit_interface_t const *emitter);
+
+/**
+ * Records a relocation of type @p type at @p where, which has to point into
+ * the buffer of the function currently emitted by be_elf_emit_function().
+ */
+void be_elf_add_relocation(char const *where, uint32_t type,
+                           ir_entity *entity, int64_t addend);
+
+/**
+ * Adds the global variables and constants of the program and writes the
+ * object file to @p output.
+ */
+void be_elf_finish(FILE *output);
+
+#endif
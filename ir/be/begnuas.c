@@ -379,7 +379,7 @@ static bool entity_is_string_const(const ir_entity *ent, bool only_suffix_null)
 	return initializer_is_string_const(init, only_suffix_null);
 }
 
-static bool entity_is_zero_initialized(ir_entity const *entity)
+bool be_gas_entity_is_zero_initialized(ir_entity const *entity)
 {
 	if (is_alias_entity(entity))
 		return false;
@@ -475,13 +475,13 @@ static be_gas_section_t determine_basic_section(const ir_entity *entity)
 			return GAS_SECTION_RODATA;
 		}
 	}
-	if (entity_is_zero_initialized(entity))
+	if (be_gas_entity_is_zero_initialized(entity))
 		return GAS_SECTION_BSS;
 
 	return GAS_SECTION_DATA;
 }
 
-static be_gas_section_t determine_section(be_main_env_t const *const main_env, ir_entity const *const entity)
+be_gas_section_t be_gas_determine_section(be_main_env_t const *const main_env, ir_entity const *const entity)
 {
 	ir_type *owner = get_entity_owner(entity);
 
@@ -597,7 +597,7 @@ void be_gas_emit_function_prolog(const ir_entity *entity, unsigned po2alignment,
 {
 	be_dwarf_function_before(entity, parameter_infos);
 
-	be_gas_section_t const section = determine_section(NULL, entity);
+	be_gas_section_t const section = be_gas_determine_section(NULL, entity);
 	emit_section(section, entity);
 
 	/* write the begin line (makes the life easier for scripts parsing the
@@ -898,7 +898,7 @@ static size_t get_initializer_size(const ir_initializer_t *initializer,
 	panic("found invalid initializer");
 }
 
-static unsigned long compute_entity_size(ir_entity const *const entity)
+unsigned long be_gas_compute_entity_size(ir_entity const *const entity)
 {
 	ir_type *const type = get_entity_type(entity);
 	unsigned long  size = get_type_size(type);
@@ -1190,7 +1190,7 @@ static void emit_align(unsigned p2alignment)
 	be_emit_write_line();
 }
 
-static unsigned get_effective_entity_alignment(const ir_entity *entity)
+unsigned be_gas_get_effective_entity_alignment(const ir_entity *entity)
 {
 	unsigned alignment = get_entity_alignment(entity);
 	if (alignment == 0) {
@@ -1203,7 +1203,7 @@ static unsigned get_effective_entity_alignment(const ir_entity *entity)
 static void emit_common(const ir_entity *entity, unsigned long size,
                         bool is_local)
 {
-	unsigned const alignment = get_effective_entity_alignment(entity);
+	unsigned const alignment = be_gas_get_effective_entity_alignment(entity);
 
 	switch (ir_platform.object_format) {
 	case OBJECT_FORMAT_MACH_O:
@@ -1238,7 +1238,7 @@ static void emit_zerofill(const ir_entity *entity, const char *section_segment,
 	be_emit_string(section_segment);
 	be_emit_char(',');
 	be_gas_emit_entity(entity);
-	unsigned const alignment = get_effective_entity_alignment(entity);
+	unsigned const alignment = be_gas_get_effective_entity_alignment(entity);
 	be_emit_irprintf(",%lu,%u\n", size, log2_floor(alignment));
 	be_emit_write_line();
 }
@@ -1403,7 +1403,7 @@ static void emit_global(be_main_env_t const *const main_env,
 
 	/* we already emitted all functions with graphs in other functions like
 	 * be_gas_emit_function_prolog(). All others don't need to be emitted. */
-	be_gas_section_t const section = determine_section(main_env, entity);
+	be_gas_section_t const section = be_gas_determine_section(main_env, entity);
 	if (kind == IR_ENTITY_METHOD && section != GAS_SECTION_PIC_TRAMPOLINES)
 		return;
 
@@ -1418,8 +1418,8 @@ static void emit_global(be_main_env_t const *const main_env,
 
 	ir_visibility const visibility       = get_entity_visibility(entity);
 	ir_linkage    const linkage          = get_entity_linkage(entity);
-	bool          const zero_initializer = entity_is_zero_initialized(entity);
-	unsigned long       size             = compute_entity_size(entity);
+	bool          const zero_initializer = be_gas_entity_is_zero_initialized(entity);
+	unsigned long       size             = be_gas_compute_entity_size(entity);
 
 	/* We need to output at least 1 byte, otherwise macho will merge
 	 * the label with the next thing */
@@ -1475,7 +1475,7 @@ static void emit_global(be_main_env_t const *const main_env,
 	}
 
 	/* alignment */
-	unsigned alignment = get_effective_entity_alignment(entity);
+	unsigned alignment = be_gas_get_effective_entity_alignment(entity);
 	if (!is_po2_or_zero(alignment))
 		panic("alignment not a power of 2");
 	if (alignment > 1)
@@ -1544,7 +1544,7 @@ static void emit_global_decls(be_main_env_t const *const main_env)
 	}
 }
 
-void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const swtch, ir_mode *const entry_mode, emit_target_func const emit_target)
+ir_node const **be_get_jump_table_targets(ir_node const *const node, be_switch_attr_t const *const swtch, unsigned long *const length_out)
 {
 	/* go over all proj's and collect their jump targets */
 	unsigned        n_outs  = arch_get_irn_n_outs(node);
@@ -1604,6 +1604,21 @@ void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const
 		}
 	}
 
+	for (unsigned long i = 0; i < length; ++i) {
+		if (labels[i] == NULL)
+			labels[i] = targets[0];
+	}
+	free(targets);
+
+	*length_out = length;
+	return labels;
+}
+
+void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const swtch, ir_mode *const entry_mode, emit_target_func const emit_target)
+{
+	unsigned long         length;
+	ir_node const **const labels = be_get_jump_table_targets(node, swtch, &length);
+
 	/* emit table */
 	unsigned         const pointer_size = get_mode_size_bytes(entry_mode);
 	ir_entity const *const entity       = swtch->table_entity;
@@ -1616,11 +1631,8 @@ void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const
 	}
 
 	for (unsigned long i = 0; i < length; ++i) {
-		ir_node const *target = labels[i];
-		if (target == NULL)
-			target = targets[0];
 		emit_size_type(pointer_size);
-		emit_target(entity, target);
+		emit_target(entity, labels[i]);
 		be_emit_char('\n');
 		be_emit_write_line();
 	}
@@ -1629,7 +1641,6 @@ void be_emit_jump_table(ir_node const *const node, be_switch_attr_t const *const
 		be_gas_emit_switch_section(GAS_SECTION_TEXT);
 
 	free(labels);
-	free(targets);
 }
 
 static void emit_global_asms(void)
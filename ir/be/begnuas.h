@@ -63,6 +63,29 @@ extern char                 be_gas_elf_type_char;
  */
 void be_gas_emit_switch_section(be_gas_section_t section);
 
+/**
+ * Returns the section, which the definition of @p entity belongs to.
+ * @p main_env may be NULL if the entity is no PIC trampoline or symbol.
+ */
+be_gas_section_t be_gas_determine_section(be_main_env_t const *main_env,
+                                          ir_entity const *entity);
+
+/**
+ * Returns true if @p entity has an initializer consisting only of zeros.
+ */
+bool be_gas_entity_is_zero_initialized(ir_entity const *entity);
+
+/**
+ * Returns the number of bytes of @p entity including the initialized part
+ * of a trailing array of flexible size.
+ */
+unsigned long be_gas_compute_entity_size(ir_entity const *entity);
+
+/**
+ * Returns the alignment of @p entity, or the one of its type if it has none.
+ */
+unsigned be_gas_get_effective_entity_alignment(ir_entity const *entity);
+
 /**
  * emit assembler instructions necessary before starting function code
  */
@@ -124,6 +147,13 @@ const char *be_gas_insn_label_prefix(void);
 
 typedef void (*emit_target_func)(ir_entity const *table, ir_node const *proj_x);
 
+/**
+ * Returns the jump targets of a switch operation, indexed by the normalized
+ * switch value. Values not in the table jump to the default target. The
+ * @p length entries have to be freed by the caller.
+ */
+ir_node const **be_get_jump_table_targets(ir_node const *node, be_switch_attr_t const *swtch, unsigned long *length);
+
 /**
  * Emits a jump table for switch operations
  */
@@ -322,32 +322,29 @@ void be_jit_emit_as_asm(ir_jit_function_t *const function,
 }
 
 static void emit_fragment(ir_jit_function_t const *const function,
-						  fragment_info_t const *const fragment,
+                          fragment_info_t const *const fragment,
                           char const *const fragment_code, char *const buffer,
                           emit_relocation_func const emit)
 {
-	unsigned        const fragment_address = fragment->address;
-	char     const *      b                = fragment_code;
-	char           *      d                = buffer;
-	unsigned              last_offset      = 0;
+	/* Copy the whole fragment first, so relocations may patch fields of
+	 * instructions already present in the code instead of overwriting a
+	 * placeholder. */
+	memcpy(buffer, fragment_code, fragment->len);
+
+	unsigned const fragment_address = fragment->address;
+	unsigned       last_offset      = 0;
 	for (unsigned r = 0, n = fragment->n_relocations; r < n; ++r) {
 		relocation_t const *const relocation = &fragment->relocations[r];
 		unsigned            const offset     = relocation->offset;
-		unsigned            const len        = offset - last_offset;
 		assert(last_offset <= offset);
-		memcpy(d, b, len);
-		d += len;
-		b += len;
 		unsigned const reloc_address = fragment_address + offset;
 		unsigned const reloc_size
-			= emit_relocation(function, relocation, reloc_address, d, emit);
-		d += reloc_size;
-		b += reloc_size;
+			= emit_relocation(function, relocation, reloc_address,
+			                  buffer + offset, emit);
 		last_offset = offset + reloc_size;
 	}
-	char const *const end = fragment_code + fragment->len;
-	assert(b <= end);
-	memcpy(d, b, end-b);
+	assert(last_offset <= fragment->len);
+	(void)last_offset;
 }
 
 void be_jit_emit_memory(char *const buffer, ir_jit_function_t *const function,
@@ -360,7 +357,7 @@ void be_jit_emit_memory(char *const buffer, ir_jit_function_t *const function,
 	for (size_t i = 0, n = function->n_fragments; i < n; ++i) {
 		fragment_info_t const *const fragment  = function->fragment_infos[i];
 		unsigned               const address   = fragment->address;
-		unsigned               const nop_bytes = last_address - address;
+		unsigned               const nop_bytes = address - last_address;
 		assert(address >= last_address);
 		if (nop_bytes > 0)
 			emitter->nops(buffer + last_address, nop_bytes);
@@ -0,0 +1,422 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Linear scan register allocator.
+ * @date        17.10.2026
+ *
+ * A register allocator for compile time sensitive settings (-O0, JIT). It
+ * builds neither an interference graph nor does it coalesce copies:
+ * 1. The selected spiller lowers the register pressure to the number of
+ *    available registers. An evicted value gets a second chance: it is
+ *    reloaded right before its next use into whatever register is free there.
+ * 2. A Perm in front of each node with register constraints splits all live
+ *    ranges at the node. The values at the node are assigned by a bipartite
+ *    matching, as in the chordal allocator.
+ * 3. The blocks are scanned in dominator tree preorder, which is a linear
+ *    order placing each definition before its uses. The lifetime intervals
+ *    are not materialized: the live-in values are the active intervals at
+ *    the start of a block and an interval ends at the last use of its value
+ *    in the block, unless the value is live at the block end. In SSA form,
+ *    an interval which is in a lifetime hole at the start of another one never
+ *    intersects it. So it suffices to know the active intervals and binpacking
+ *    the registers greedily always finds a free register.
+ * 4. SSA destruction resolves differing registers of Phis and their
+ *    arguments at the control flow edges.
+ */
+#include "be_t.h"
+#include "bechordal_t.h"
+#include "beirg.h"
+#include "belive.h"
+#include "belower.h"
+#include "bemodule.h"
+#include "benode.h"
+#include "bera.h"
+#include "besched.h"
+#include "bespill.h"
+#include "bespillutil.h"
+#include "bessadestr.h"
+#include "beverify.h"
+#include "debug.h"
+#include "irdom.h"
+#include "iredges_t.h"
+#include "irgraph_t.h"
+#include "irnode_t.h"
+#include "raw_bitset.h"
+#include "target_t.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+typedef struct be_linearscan_env_t {
+	be_lv_t                     *lv;
+	arch_register_class_t const *cls;
+	unsigned                     n_regs;
+	unsigned const              *allocatable_regs;
+	unsigned                    *free_regs; /**< registers of no active interval */
+} be_linearscan_env_t;
+
+/**
+ * Records for each value, whose interval ends in @p block, where it ends in
+ * the link field: the node with the last use of the value or the value itself,
+ * if it is not used at all. The values live at the end of @p block get NULL.
+ */
+static void determine_interval_ends(be_linearscan_env_t const *const env,
+                                    ir_node *const block)
+{
+	arch_register_class_t const *const cls = env->cls;
+
+	inc_irg_visited(get_irn_irg(block));
+	be_lv_foreach_cls(env->lv, block, be_lv_state_end, cls, value) {
+		mark_irn_visited(value);
+		set_irn_link(value, NULL);
+	}
+
+	sched_foreach_reverse(block, node) {
+		be_foreach_definition(node, cls, value, req,
+			if (!irn_visited_else_mark(value))
+				set_irn_link(value, value);
+		);
+		if (is_Phi(node))
+			continue;
+		be_foreach_use(node, cls, in_req, value, value_req,
+			if (!irn_visited_else_mark(value))
+				set_irn_link(value, node);
+		);
+	}
+}
+
+/**
+ * Marks the @p width registers starting at @p reg as free or not in @p regs.
+ */
+static void set_regs(unsigned *const regs, arch_register_t const *const reg,
+                     unsigned const width, bool const is_free)
+{
+	for (unsigned i = reg->index, end = i + width; i != end; ++i) {
+		if (is_free)
+			rbitset_set(regs, i);
+		else
+			rbitset_clear(regs, i);
+	}
+}
+
+static void occupy_reg(be_linearscan_env_t const *const env,
+                       ir_node const *const value)
+{
+	arch_register_t     const *const reg = arch_get_irn_register(value);
+	arch_register_req_t const *const req = arch_get_irn_register_req(value);
+	assert(reg != NULL && "value must have been assigned a register");
+	set_regs(env->free_regs, reg, req->width, false);
+}
+
+static void release_reg(be_linearscan_env_t const *const env,
+                        ir_node const *const value)
+{
+	arch_register_t     const *const reg = arch_get_irn_register(value);
+	arch_register_req_t const *const req = arch_get_irn_register_req(value);
+	set_regs(env->free_regs, reg, req->width, true);
+}
+
+static bool is_free_reg(be_linearscan_env_t const *const env,
+                        arch_register_t const *const reg)
+{
+	return reg != NULL && reg->cls == env->cls
+	    && rbitset_is_set(env->free_regs, reg->index);
+}
+
+/**
+ * Returns a free register, which saves a copy when assigned to @p value:
+ * A register of an argument of a Phi or of the operand of a Copy, the
+ * register of a Phi using the value or a register required by a user of the
+ * value. Returns NULL if there is none.
+ */
+static arch_register_t const *get_hint(be_linearscan_env_t const *const env,
+                                       ir_node const *const value)
+{
+	if (is_Phi(value)) {
+		foreach_irn_in(value, i, op) {
+			arch_register_t const *const reg = arch_get_irn_register(op);
+			if (is_free_reg(env, reg))
+				return reg;
+		}
+	} else if (be_is_Copy(value)) {
+		arch_register_t const *const reg
+			= arch_get_irn_register(be_get_Copy_op(value));
+		if (is_free_reg(env, reg))
+			return reg;
+	}
+
+	foreach_out_edge(value, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_Phi(user)) {
+			arch_register_t const *const reg = arch_get_irn_register(user);
+			if (is_free_reg(env, reg))
+				return reg;
+			continue;
+		}
+
+		/* The Perm in front of a constrained node carries the constraints of
+		 * the node's operands. */
+		int                  const pos = get_edge_src_pos(edge);
+		arch_register_req_t const *req = be_is_Perm(user)
+			? arch_get_irn_register_req_out(user, pos)
+			: arch_get_irn_register_req_in(user, pos);
+		if (req->cls != env->cls)
+			continue;
+		if (req->limited != NULL) {
+			rbitset_foreach(req->limited, env->n_regs, idx) {
+				if (rbitset_is_set(env->free_regs, idx))
+					return arch_register_for_index(env->cls, idx);
+			}
+		} else if (be_is_Perm(user)) {
+			/* The value lives through the constrained node, so prefer a
+			 * register, which the node does not overwrite. */
+			ir_node  *const constrained = sched_next(user);
+			unsigned *const regs        = rbitset_alloca(env->n_regs);
+			rbitset_copy(regs, env->free_regs, env->n_regs);
+			be_foreach_definition(constrained, env->cls, def, def_req,
+				arch_register_t const *const def_reg
+					= arch_get_irn_register(def);
+				if (def_reg != NULL)
+					rbitset_clear(regs, def_reg->index);
+			);
+			size_t const idx = rbitset_next_max(regs, 0, env->n_regs, true);
+			if (idx != (size_t)-1)
+				return arch_register_for_index(env->cls, idx);
+		}
+	}
+	return NULL;
+}
+
+static void assign_reg(be_linearscan_env_t const *const env,
+                       ir_node *const value)
+{
+	/* Values at constrained nodes are precolored. */
+	arch_register_t const *reg = arch_get_irn_register(value);
+	if (reg != NULL) {
+		assert(rbitset_is_set(env->free_regs, reg->index)
+		       && "precolored register must be free");
+	} else {
+		reg = get_hint(env, value);
+		if (reg == NULL) {
+			size_t const idx = rbitset_next_max(env->free_regs, 0, env->n_regs,
+			                                    true);
+			assert(idx != (size_t)-1 && "register pressure too high");
+			reg = arch_register_for_index(env->cls, idx);
+		}
+		arch_set_irn_register(value, reg);
+	}
+	DBG((dbg, LEVEL_2, "\tassigning register %s to %+F\n", reg->name, value));
+	occupy_reg(env, value);
+}
+
+static bool is_live_through(ir_node const *const proj,
+                            ir_node const *const constrained)
+{
+	arch_register_req_t const *const req = arch_get_irn_register_req(proj);
+	if (req->limited != NULL || req->width != 1)
+		return false;
+	foreach_irn_in(constrained, i, op) {
+		if (op == proj)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * The matching at a constrained node assigns arbitrary registers to the values
+ * which just live through the node. Reassign them any register, which is
+ * neither occupied at the Perm nor by another value of the Perm nor defined by
+ * the node, so that most of them keep the register they have in front of the
+ * Perm, which saves copies when lowering the Perm.
+ */
+static void keep_live_through_regs(be_linearscan_env_t const *const env,
+                                   ir_node *const perm)
+{
+	ir_node  *const constrained = sched_next(perm);
+	ir_node **const projs       = ALLOCAN(ir_node*, get_irn_arity(perm));
+	unsigned *const regs        = rbitset_alloca(env->n_regs);
+	unsigned        n_projs     = 0;
+	rbitset_copy(regs, env->free_regs, env->n_regs);
+	foreach_out_edge(perm, edge) {
+		ir_node               *const proj = get_edge_src_irn(edge);
+		arch_register_t const *const reg  = arch_get_irn_register(proj);
+		/* Only the Perms of constrained nodes are precolored. */
+		if (reg == NULL)
+			return;
+		if (is_live_through(proj, constrained)) {
+			projs[n_projs++] = proj;
+		} else {
+			unsigned const width = arch_get_irn_register_req(proj)->width;
+			set_regs(regs, reg, width, false);
+		}
+	}
+	be_foreach_definition(constrained, env->cls, value, req,
+		arch_register_t const *const reg = arch_get_irn_register(value);
+		if (reg != NULL)
+			set_regs(regs, reg, req->width, false);
+	);
+
+	unsigned n_moved = 0;
+	for (unsigned i = 0; i < n_projs; ++i) {
+		ir_node               *const proj = projs[i];
+		ir_node               *const op   = get_irn_n(perm, get_Proj_num(proj));
+		arch_register_t const *const reg  = arch_get_irn_register(op);
+		if (rbitset_is_set(regs, reg->index)) {
+			rbitset_clear(regs, reg->index);
+			arch_set_irn_register(proj, reg);
+		} else {
+			projs[n_moved++] = proj;
+		}
+	}
+	for (unsigned i = 0; i < n_moved; ++i) {
+		size_t const idx = rbitset_next_max(regs, 0, env->n_regs, true);
+		assert(idx != (size_t)-1);
+		rbitset_clear(regs, idx);
+		arch_set_irn_register_idx(projs[i], idx);
+	}
+}
+
+static void scan_block(ir_node *const block, void *const data)
+{
+	be_linearscan_env_t   const *const env = (be_linearscan_env_t const*)data;
+	arch_register_class_t const *const cls = env->cls;
+	DBG((dbg, LEVEL_1, "Scanning %+F\n", block));
+
+	determine_interval_ends(env, block);
+
+	rbitset_copy(env->free_regs, env->allocatable_regs, env->n_regs);
+	be_lv_foreach_cls(env->lv, block, be_lv_state_in, cls, value) {
+		occupy_reg(env, value);
+	}
+
+	/* The Phis are defined in parallel at the block start, so unused Phis
+	 * release their registers only after all Phis got one. */
+	sched_foreach_phi(block, phi) {
+		if (arch_irn_consider_in_reg_alloc(cls, phi))
+			assign_reg(env, phi);
+	}
+	sched_foreach_phi(block, phi) {
+		if (arch_irn_consider_in_reg_alloc(cls, phi) && get_irn_link(phi) == phi)
+			release_reg(env, phi);
+	}
+
+	sched_foreach_non_phi(block, node) {
+		/* The operands, whose intervals end here, leave their registers to
+		 * the definitions of the node. */
+		be_foreach_use(node, cls, in_req, value, value_req,
+			if (get_irn_link(value) == node) {
+				set_irn_link(value, NULL);
+				release_reg(env, value);
+			}
+		);
+		if (be_is_Perm(node) && arch_get_irn_register_req_in(node, 0)->cls == cls)
+			keep_live_through_regs(env, node);
+		be_foreach_definition(node, cls, value, req,
+			assign_reg(env, value);
+		);
+		be_foreach_definition(node, cls, value, req,
+			if (get_irn_link(value) == value)
+				release_reg(env, value);
+		);
+	}
+}
+
+static void linearscan_cls(be_chordal_env_t *const chordal_env,
+                           const regalloc_if_t *const regif)
+{
+	ir_graph                    *const irg = chordal_env->irg;
+	arch_register_class_t const *const cls = chordal_env->cls;
+
+	be_assure_live_chk(irg);
+	be_timer_push(T_RA_SPILL);
+	be_do_spill(irg, cls, regif);
+	be_timer_pop(T_RA_SPILL);
+
+	be_timer_push(T_RA_SPILL_APPLY);
+	check_for_memory_operands(irg, regif);
+	be_timer_pop(T_RA_SPILL_APPLY);
+
+	/* verify schedule and register pressure */
+	if (be_options.do_verify) {
+		be_timer_push(T_VERIFY);
+		bool check_schedule = be_verify_schedule(irg);
+		be_check_verify_result(check_schedule, irg);
+		bool check_pressure = be_verify_register_pressure(irg, cls);
+		be_check_verify_result(check_pressure, irg);
+		be_timer_pop(T_VERIFY);
+	}
+
+	be_timer_push(T_RA_COLOR);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	be_assure_live_sets(irg);
+	be_chordal_handle_constraints(chordal_env);
+
+	unsigned const      n_regs = cls->n_regs;
+	be_linearscan_env_t env    = {
+		.lv               = be_get_irg_liveness(irg),
+		.cls              = cls,
+		.n_regs           = n_regs,
+		.allocatable_regs = chordal_env->allocatable_regs->data,
+		.free_regs        = rbitset_alloca(n_regs),
+	};
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
+	dom_tree_walk_irg(irg, scan_block, NULL, &env);
+	ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
+	be_timer_pop(T_RA_COLOR);
+
+	be_timer_push(T_RA_SSA);
+	be_ssa_destruction(irg, cls);
+	be_timer_pop(T_RA_SSA);
+}
+
+/**
+ * Performs linear scan register allocation for each register class on the
+ * given irg.
+ */
+static void be_ra_linearscan(ir_graph *irg, const regalloc_if_t *regif)
+{
+	be_timer_push(T_RA_OTHER);
+
+	be_spill_prepare_for_constraints(irg);
+
+	be_chordal_env_t chordal_env;
+	obstack_init(&chordal_env.obst);
+	chordal_env.irg          = irg;
+	chordal_env.border_heads = NULL;
+	chordal_env.ifg          = NULL;
+
+	arch_register_class_t const *const reg_classes
+		= ir_target.isa->register_classes;
+	for (int j = 0, m = ir_target.isa->n_register_classes; j < m; ++j) {
+		arch_register_class_t const *const cls = &reg_classes[j];
+		if (cls->manual_ra)
+			continue;
+
+		chordal_env.cls              = cls;
+		chordal_env.allocatable_regs = bitset_malloc(cls->n_regs);
+		be_get_allocatable_regs(irg, cls, chordal_env.allocatable_regs->data);
+
+		linearscan_cls(&chordal_env, regif);
+
+		free(chordal_env.allocatable_regs);
+	}
+
+	be_timer_push(T_RA_EPILOG);
+	lower_nodes_after_ra(irg, true, regif);
+
+	obstack_free(&chordal_env.obst, NULL);
+	be_invalidate_live_sets(irg);
+	be_timer_pop(T_RA_EPILOG);
+
+	be_timer_pop(T_RA_OTHER);
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_linearscan)
+void be_init_linearscan(void)
+{
+	be_register_allocator("linearscan", be_ra_linearscan);
+	FIRM_DBG_REGISTER(dbg, "firm.be.linearscan");
+}
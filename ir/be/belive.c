@@ -12,6 +12,7 @@
 /* statev is expensive here, only enable when needed */
 #define DISABLE_STATEV
 
+#include "bitset.h"
 #include "debug.h"
 #include "iredges_t.h"
 #include "irgwalk.h"
@@ -25,110 +26,161 @@
 #include "besched.h"
 #include "bemodule.h"
 #include "beirg.h"
+#include "target_t.h"
+#include "util.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
 
-#define LV_STD_SIZE             63
-
-static unsigned _be_liveness_bsearch(be_lv_info_t const *const arr, ir_node const *const node)
+/**
+ * Returns the number record of @p irn, enlarging the records if necessary.
+ */
+static be_lv_value_t *lv_get_value(be_lv_t *const lv, ir_node const *const irn)
 {
-	unsigned const n = arr->n_members;
-	if (n == 0)
-		return 0;
-
-	unsigned lo = 0;
-	unsigned hi = n;
-	unsigned res;
-	do {
-		unsigned md      = lo + ((hi - lo) >> 1);
-		ir_node *md_node = arr->nodes[md].node;
+	unsigned const idx = get_irn_idx(irn);
+	size_t   const len = ARR_LEN(lv->values);
+	if (idx >= len) {
+		size_t const new_len = MAX(2 * len, (size_t)get_irg_last_idx(lv->irg));
+		ARR_RESIZE(be_lv_value_t, lv->values, new_len);
+		memset(&lv->values[len], 0, (new_len - len) * sizeof(*lv->values));
+	}
+	return &lv->values[idx];
+}
 
-		if (node > md_node) {
-			lo = md + 1;
-		} else if (node < md_node) {
-			hi = md;
-		} else {
-			res = md;
-			break;
-		}
+static be_lv_value_t const *lv_find_value(be_lv_t const *const lv,
+                                          ir_node const *const irn)
+{
+	unsigned const idx = get_irn_idx(irn);
+	if (idx >= ARR_LEN(lv->values) || lv->values[idx].nr == 0)
+		return NULL;
+	return &lv->values[idx];
+}
 
-		res = lo;
-	} while (lo < hi);
+/**
+ * Doubles the length of the bitsets of value class @p cls in all blocks.
+ */
+static void lv_grow_class(be_lv_t *const lv, be_lv_class_t *const cls,
+                          unsigned const cls_idx)
+{
+	unsigned const n_words   = cls->n_words;
+	unsigned const new_words = n_words == 0 ? 2 : 2 * n_words;
+
+	ir_nodehashmap_iterator_t iter;
+	ir_nodehashmap_iterator_init(&iter, &lv->map);
+	for (ir_nodehashmap_entry_t entry; (entry = ir_nodehashmap_iterator_next(&iter)).node != NULL;) {
+		be_lv_info_t *const info = (be_lv_info_t*)entry.data;
+		unsigned     *const sets = info->sets[cls_idx];
+		if (sets == NULL)
+			continue;
+		unsigned *const nw = rbitset_obstack_alloc(&lv->obst, 3 * new_words * BITS_PER_ELEM);
+		for (unsigned i = 0; i < 3; ++i)
+			memcpy(&nw[i * new_words], &sets[i * n_words], n_words * sizeof(*sets));
+		info->sets[cls_idx] = nw;
+	}
+	cls->n_words = new_words;
+}
 
-	return res;
+/**
+ * Assigns a number to @p irn, which becomes live at some block.
+ */
+static be_lv_value_t *lv_number_value(be_lv_t *const lv, ir_node *const irn)
+{
+	be_lv_value_t *const value = lv_get_value(lv, irn);
+	if (value->nr != 0)
+		return value;
+
+	arch_register_req_t const *const req     = arch_get_irn_register_req(irn);
+	unsigned                   const cls_idx = be_lv_get_value_class(lv, req->cls);
+	be_lv_class_t *const cls = &lv->classes[cls_idx];
+
+	unsigned nr;
+	size_t const n_free = ARR_LEN(cls->free);
+	if (n_free > 0) {
+		nr = cls->free[n_free - 1];
+		ARR_SHRINKLEN(cls->free, n_free - 1);
+	} else {
+		nr = ARR_LEN(cls->values);
+		ARR_APP1(ir_node*, cls->values, NULL);
+		if (nr >= cls->n_words * BITS_PER_ELEM)
+			lv_grow_class(lv, cls, cls_idx);
+	}
+	cls->values[nr] = irn;
+	value->cls      = cls_idx;
+	value->nr       = nr + 1;
+	return value;
 }
 
-be_lv_info_node_t *be_lv_get(const be_lv_t *li, const ir_node *bl,
-                             const ir_node *irn)
+be_lv_state_t be_lv_get(const be_lv_t *li, const ir_node *bl,
+                        const ir_node *irn)
 {
 	stat_ev_tim_push();
-	be_lv_info_t      *irn_live = ir_nodehashmap_get(be_lv_info_t, &li->map, bl);
-	be_lv_info_node_t *res      = NULL;
-	if (irn_live != NULL) {
-		/* Get the position of the index in the array. */
-		unsigned pos = _be_liveness_bsearch(irn_live, irn);
-
-		/* Get the record in question. */
-		be_lv_info_node_t *const rec = &irn_live->nodes[pos];
-
-		/* Check, if the irn is in deed in the array. */
-		if (rec->node == irn)
-			res = rec;
+	be_lv_state_t              res   = be_lv_state_none;
+	be_lv_value_t const *const value = lv_find_value(li, irn);
+	if (value != NULL) {
+		be_lv_info_t const *const info = ir_nodehashmap_get(be_lv_info_t, &li->map, bl);
+		if (info != NULL && info->sets[value->cls] != NULL) {
+			unsigned const *const sets    = info->sets[value->cls];
+			unsigned        const n_words = li->classes[value->cls].n_words;
+			unsigned        const nr      = value->nr - 1;
+			if (rbitset_is_set(sets, nr))
+				res |= be_lv_state_in;
+			if (rbitset_is_set(&sets[n_words], nr))
+				res |= be_lv_state_end;
+			if (rbitset_is_set(&sets[2 * n_words], nr))
+				res |= be_lv_state_out;
+		}
 	}
 	stat_ev_tim_pop("be_lv_get");
 
 	return res;
 }
 
-static be_lv_info_node_t *be_lv_get_or_set(be_lv_t *li, ir_node *bl,
-                                           ir_node *irn)
+/**
+ * Adds the liveness state @p state of @p irn at block @p bl.
+ * @return the liveness state before
+ */
+static be_lv_state_t be_lv_add_state(be_lv_t *const li, ir_node *const bl,
+                                     ir_node *const irn,
+                                     be_lv_state_t const state)
 {
 	assert(get_irn_mode(irn) != mode_T);
 
-	be_lv_info_t *irn_live = ir_nodehashmap_get(be_lv_info_t, &li->map, bl);
-	if (irn_live == NULL) {
-		irn_live = OALLOCFZ(&li->obst, be_lv_info_t, nodes, LV_STD_SIZE);
-		irn_live->n_size = LV_STD_SIZE;
-		ir_nodehashmap_insert(&li->map, bl, irn_live);
+	be_lv_info_t *info = ir_nodehashmap_get(be_lv_info_t, &li->map, bl);
+	if (info == NULL) {
+		info = OALLOCFZ(&li->obst, be_lv_info_t, sets, li->n_classes);
+		info->block = bl;
+		ir_nodehashmap_insert(&li->map, bl, info);
 	}
 
-	/* Get the position of the index in the array. */
-	unsigned pos = _be_liveness_bsearch(irn_live, irn);
-
-	/* Get the record in question. */
-	be_lv_info_node_t *res = &irn_live->nodes[pos];
-
-	/* Check, if the irn is in deed in the array. */
-	if (res->node != irn) {
-		unsigned n_members = irn_live->n_members;
-		unsigned n_size    = irn_live->n_size;
-		if (n_members + 1 >= n_size) {
-			/* double the array size. */
-			unsigned      const new_size = 2 * n_size;
-			be_lv_info_t *const nw       = OALLOCF(&li->obst, be_lv_info_t, nodes, new_size);
-			memcpy(nw, irn_live, sizeof(*irn_live) + n_size * sizeof(*irn_live->nodes));
-			memset(&nw->nodes[n_size], 0, (new_size - n_size) * sizeof(*irn_live->nodes));
-			nw->n_size = new_size;
-			irn_live = nw;
-			ir_nodehashmap_insert(&li->map, bl, nw);
-		}
-
-		for (unsigned i = n_members; i > pos; --i) {
-			irn_live->nodes[i] = irn_live->nodes[i - 1];
-		}
-
-		++irn_live->n_members;
-		res        = &irn_live->nodes[pos];
-		res->node  = irn;
-		res->flags = 0;
+	be_lv_value_t *const value   = lv_number_value(li, irn);
+	unsigned       const n_words = li->classes[value->cls].n_words;
+	unsigned            *sets    = info->sets[value->cls];
+	if (sets == NULL) {
+		sets = rbitset_obstack_alloc(&li->obst, 3 * n_words * BITS_PER_ELEM);
+		info->sets[value->cls] = sets;
 	}
 
-	return res;
+	unsigned const nr = value->nr - 1;
+	be_lv_state_t  before = be_lv_state_none;
+	if (rbitset_is_set(sets, nr))
+		before |= be_lv_state_in;
+	if (rbitset_is_set(&sets[n_words], nr))
+		before |= be_lv_state_end;
+	if (rbitset_is_set(&sets[2 * n_words], nr))
+		before |= be_lv_state_out;
+
+	if (state & be_lv_state_in)
+		rbitset_set(sets, nr);
+	if (state & be_lv_state_end)
+		rbitset_set(&sets[n_words], nr);
+	if (state & be_lv_state_out)
+		rbitset_set(&sets[2 * n_words], nr);
+	return before;
 }
 
 typedef struct lv_remove_walker_t {
-	be_lv_t       *lv;
-	ir_node const *irn;
+	be_lv_t  *lv;
+	unsigned  cls;
+	unsigned  nr;
 } lv_remove_walker_t;
 
 /**
@@ -136,27 +188,16 @@ typedef struct lv_remove_walker_t {
  */
 static void lv_remove_irn_walker(ir_node *const bl, void *const data)
 {
-	lv_remove_walker_t *const w        = (lv_remove_walker_t*)data;
-	be_lv_info_t       *const irn_live = ir_nodehashmap_get(be_lv_info_t, &w->lv->map, bl);
-	if (irn_live == NULL)
-		return;
-
-	unsigned           const n   = irn_live->n_members;
-	ir_node     const *const irn = w->irn;
-	unsigned           const pos = _be_liveness_bsearch(irn_live, irn);
-	be_lv_info_node_t *const res = &irn_live->nodes[pos];
-	if (res->node != irn)
+	lv_remove_walker_t *const w    = (lv_remove_walker_t*)data;
+	be_lv_info_t       *const info = ir_nodehashmap_get(be_lv_info_t, &w->lv->map, bl);
+	if (info == NULL || info->sets[w->cls] == NULL)
 		return;
 
-	/* The node is indeed in the block's array. Let's remove it. */
-	for (unsigned i = pos + 1; i < n; ++i)
-		irn_live->nodes[i - 1] = irn_live->nodes[i];
-
-	irn_live->nodes[n - 1].node  = NULL;
-	irn_live->nodes[n - 1].flags = 0;
-
-	--irn_live->n_members;
-	DBG((dbg, LEVEL_3, "\tdeleting %+F from %+F at pos %d\n", irn, bl, pos));
+	unsigned *const sets    = info->sets[w->cls];
+	unsigned  const n_words = w->lv->classes[w->cls].n_words;
+	rbitset_clear(sets, w->nr);
+	rbitset_clear(&sets[n_words], w->nr);
+	rbitset_clear(&sets[2 * n_words], w->nr);
 }
 
 static struct {
@@ -174,13 +215,10 @@ static struct {
  */
 static void live_end_at_block(ir_node *const block, be_lv_state_t const state)
 {
-	be_lv_info_node_t *const n      = be_lv_get_or_set(re.lv, block, re.def);
-	be_lv_state_t      const before = n->flags;
-
 	assert(state == be_lv_state_end || state == (be_lv_state_end | be_lv_state_out));
 	DBG((dbg, LEVEL_2, "marking %+F live %s at %+F\n", re.def,
 	     state & be_lv_state_out ? "end+out" : "end", block));
-	n->flags |= state;
+	be_lv_state_t const before = be_lv_add_state(re.lv, block, re.def, state);
 
 	/* There is no need to recurse further, if we where here before (i.e., any
 	 * live state bits were set before). */
@@ -192,7 +230,7 @@ static void live_end_at_block(ir_node *const block, be_lv_state_t const state)
 		return;
 
 	DBG((dbg, LEVEL_2, "marking %+F live in at %+F\n", re.def, block));
-	n->flags |= be_lv_state_in;
+	be_lv_add_state(re.lv, block, re.def, be_lv_state_in);
 
 	for (unsigned i = get_Block_n_cfgpreds(block); i-- > 0;) {
 		ir_node *const pred_block = get_Block_cfgpred_block(block, i);
@@ -235,9 +273,8 @@ static void liveness_for_node(ir_node *irn)
 		} else if (def_block != use_block) {
 			/* Else, the value is live in at this block. Mark it and call live
 			 * out on the predecessors. */
-			be_lv_info_node_t *const n = be_lv_get_or_set(re.lv, use_block, irn);
 			DBG((dbg, LEVEL_2, "marking %+F live in at %+F\n", irn, use_block));
-			n->flags |= be_lv_state_in;
+			be_lv_add_state(re.lv, use_block, irn, be_lv_state_in);
 
 			for (unsigned i = get_Block_n_cfgpreds(use_block); i-- > 0; ) {
 				ir_node *pred_block = get_Block_cfgpred_block(use_block, i);
@@ -271,9 +308,16 @@ void be_liveness_compute_sets(be_lv_t *lv)
 	unsigned n = get_irg_last_idx(irg);
 	ir_node **const nodes = NEW_ARR_FZ(ir_node*, n);
 
-	/* inserting the variables sorted by their ID is probably
-	 * more efficient since the binary sorted set insertion
-	 * will not need to move around the data. */
+	lv->n_classes = ir_target.isa->n_register_classes + 1;
+	lv->classes   = XMALLOCNZ(be_lv_class_t, lv->n_classes);
+	for (unsigned i = 0; i < lv->n_classes; ++i) {
+		lv->classes[i].values = NEW_ARR_F(ir_node*, 0);
+		lv->classes[i].free   = NEW_ARR_F(unsigned, 0);
+	}
+	lv->values = NEW_ARR_FZ(be_lv_value_t, n);
+
+	/* processing the variables sorted by their ID numbers them in this order,
+	 * which makes the iteration order of the live sets deterministic. */
 	irg_walk_graph(irg, NULL, collect_liveness_nodes, nodes);
 
 	re.lv = lv;
@@ -301,6 +345,12 @@ void be_liveness_invalidate_sets(be_lv_t *lv)
 		return;
 	obstack_free(&lv->obst, NULL);
 	ir_nodehashmap_destroy(&lv->map);
+	for (unsigned i = 0; i < lv->n_classes; ++i) {
+		DEL_ARR_F(lv->classes[i].values);
+		DEL_ARR_F(lv->classes[i].free);
+	}
+	free(lv->classes);
+	DEL_ARR_F(lv->values);
 	lv->sets_valid = false;
 }
 
@@ -332,11 +382,23 @@ void be_liveness_remove(be_lv_t *lv, const ir_node *irn)
 {
 	assert(lv->sets_valid);
 
+	/* Values without a number are not live anywhere. */
+	if (lv_find_value(lv, irn) == NULL)
+		return;
+
 	/* Removes a single irn from the liveness information.
 	 * Since an irn can only be live at blocks dominated by the block of its
 	 * definition, we only have to process that dominance subtree. */
-	lv_remove_walker_t w = { lv, irn };
+	be_lv_value_t      *const value = &lv->values[get_irn_idx(irn)];
+	unsigned            const nr    = value->nr - 1;
+	lv_remove_walker_t        w     = { lv, value->cls, nr };
 	dom_tree_walk(get_nodes_block(irn), lv_remove_irn_walker, NULL, &w);
+
+	/* The number is free for reuse now. */
+	be_lv_class_t *const cls = &lv->classes[value->cls];
+	cls->values[nr] = NULL;
+	ARR_APP1(unsigned, cls->free, nr);
+	value->nr = 0;
 }
 
 void be_liveness_introduce(be_lv_t *lv, ir_node *irn)
@@ -355,6 +417,62 @@ void be_liveness_update(be_lv_t *lv, ir_node *irn)
 	be_liveness_introduce(lv, irn);
 }
 
+typedef struct lv_new_nodes_env_t {
+	unsigned   first_new_idx;
+	bitset_t  *marked;
+	ir_node  **nodes;
+} lv_new_nodes_env_t;
+
+static void mark_for_update(lv_new_nodes_env_t *const env, ir_node *const irn)
+{
+	if (bitset_is_set(env->marked, get_irn_idx(irn)))
+		return;
+	bitset_set(env->marked, get_irn_idx(irn));
+	ARR_APP1(ir_node*, env->nodes, irn);
+}
+
+/**
+ * Walker, collects new nodes and the old nodes they use.
+ */
+static void collect_new_nodes(ir_node *const irn, void *const data)
+{
+	lv_new_nodes_env_t *const env = (lv_new_nodes_env_t*)data;
+	if (get_irn_idx(irn) < env->first_new_idx || !is_liveness_node(irn))
+		return;
+
+	mark_for_update(env, irn);
+	foreach_irn_in(irn, i, op) {
+		if (get_irn_idx(op) < env->first_new_idx && is_liveness_node(op))
+			mark_for_update(env, op);
+	}
+}
+
+void be_liveness_update_new_nodes(be_lv_t *const lv,
+                                  unsigned const first_new_idx,
+                                  ir_node *const *const changed,
+                                  size_t const n_changed)
+{
+	assert(lv->sets_valid);
+	be_timer_push(T_LIVE);
+
+	ir_graph *const irg = lv->irg;
+	lv_new_nodes_env_t env = {
+		.first_new_idx = first_new_idx,
+		.marked        = bitset_malloc(get_irg_last_idx(irg)),
+		.nodes         = NEW_ARR_F(ir_node*, 0),
+	};
+	for (size_t i = 0; i < n_changed; ++i)
+		mark_for_update(&env, changed[i]);
+	irg_walk_graph(irg, NULL, collect_new_nodes, &env);
+
+	for (size_t i = 0, n = ARR_LEN(env.nodes); i < n; ++i)
+		be_liveness_update(lv, env.nodes[i]);
+
+	DEL_ARR_F(env.nodes);
+	free(env.marked);
+	be_timer_pop(T_LIVE);
+}
+
 void be_liveness_transfer(const arch_register_class_t *cls,
                           ir_node *node, ir_nodeset_t *nodeset)
 {
@@ -17,6 +17,7 @@
 #include "irnodehashmap.h"
 #include "irlivechk.h"
 #include "bearch.h"
+#include "raw_bitset.h"
 
 typedef enum be_lv_state_t {
 	be_lv_state_none = 0,
@@ -76,6 +77,16 @@ void be_liveness_remove(be_lv_t *lv, const ir_node *irn);
  */
 void be_liveness_introduce(be_lv_t *lv, ir_node *irn);
 
+/**
+ * Updates the liveness information after nodes have been inserted into the
+ * graph: All nodes with an index of at least @p first_new_idx, which are
+ * reachable in the graph, are introduced and the liveness of their operands is
+ * updated. Additionally the liveness of the @p n_changed nodes @p changed, whose
+ * users were changed, is updated.
+ */
+void be_liveness_update_new_nodes(be_lv_t *lv, unsigned first_new_idx,
+                                  ir_node *const *changed, size_t n_changed);
+
 /**
  * The liveness transfer function.
  * Updates a live set over a single step from a given node to its predecessor.
@@ -129,34 +140,53 @@ void be_liveness_nodes_live_before(be_lv_t const *lv,
                                    arch_register_class_t const *cls,
                                    ir_node const *pos, ir_nodeset_t *live);
 
+/**
+ * Values live across blocks get a compact number within their value class.
+ * There is one value class per register class and one for values without a
+ * register class (like memory).
+ */
+typedef struct be_lv_class_t {
+	ir_node **values;  /**< values indexed by their number, NULL if unused */
+	unsigned *free;    /**< numbers of removed values for reuse */
+	unsigned  n_words; /**< length of a liveness bitset of this class */
+} be_lv_class_t;
+
+typedef struct be_lv_value_t {
+	unsigned cls; /**< value class of the value */
+	unsigned nr;  /**< number of the value plus one, 0 if it has none */
+} be_lv_value_t;
+
 struct be_lv_t {
-	ir_nodehashmap_t map;
+	ir_nodehashmap_t map;       /**< maps blocks to their be_lv_info_t */
 	struct obstack   obst;
 	bool             sets_valid;
 	ir_graph        *irg;
 	lv_chk_t        *lvc;
+	unsigned         n_classes; /**< number of value classes */
+	be_lv_class_t   *classes;   /**< the value classes */
+	be_lv_value_t   *values;    /**< value numbers indexed by node index */
 };
 
-typedef struct be_lv_info_node_t be_lv_info_node_t;
-struct be_lv_info_node_t {
-	ir_node      *node;
-	be_lv_state_t flags;
-};
-
+/**
+ * The liveness of a block: For each value class three consecutive bitsets
+ * (live in, live end and live out) indexed by the value numbers, or NULL if no
+ * value of the class is live at the block.
+ */
 struct be_lv_info_t {
-	unsigned          n_members;
-	unsigned          n_size;
-	be_lv_info_node_t nodes[];
+	ir_node const *block;
+	unsigned      *sets[];
 };
 
-be_lv_info_node_t *be_lv_get(const be_lv_t *li, const ir_node *block,
-                             const ir_node *irn);
+/**
+ * Returns the liveness state of @p irn at @p block.
+ */
+be_lv_state_t be_lv_get(const be_lv_t *li, const ir_node *block,
+                        const ir_node *irn);
 
 static inline be_lv_state_t be_get_live_state(be_lv_t const *const li, ir_node const *const block, ir_node const *const irn)
 {
 	if (li->sets_valid) {
-		be_lv_info_node_t *info = be_lv_get(li, block, irn);
-		return info ? info->flags : be_lv_state_none;
+		return be_lv_get(li, block, irn);
 	} else {
 		return lv_chk_bl_xxx(li->lvc, block, irn);
 	}
@@ -200,58 +230,94 @@ static inline bool be_is_live_end(const be_lv_t *li, const ir_node *block,
 
 typedef struct lv_iterator_t
 {
-	be_lv_info_t *info;
-	size_t        i;
+	be_lv_t      const *lv;
+	be_lv_info_t const *info;
+	unsigned            cls;     /**< the current value class */
+	unsigned            cls_end; /**< the value class after the last one */
+	unsigned            word;    /**< the current word of the bitsets */
+	unsigned            bits;    /**< the not yet visited bits of the word */
 } lv_iterator_t;
 
+/**
+ * Returns the value class of the values of register class @p cls.
+ * Generic classes like memory share the last value class.
+ */
+static inline unsigned be_lv_get_value_class(const be_lv_t *lv,
+                                             const arch_register_class_t *cls)
+{
+	unsigned const n_reg_classes = lv->n_classes - 1;
+	return cls->index < n_reg_classes ? cls->index : n_reg_classes;
+}
+
 static inline lv_iterator_t be_lv_iteration_begin(const be_lv_t *lv,
-                                                  const ir_node *block)
+                                                  const ir_node *block,
+                                                  unsigned cls,
+                                                  unsigned cls_end)
 {
 	assert(lv->sets_valid);
 	lv_iterator_t res;
-	res.info  = ir_nodehashmap_get(be_lv_info_t, &lv->map, block);
-	res.i     = res.info ? res.info->n_members : 0;
+	res.lv      = lv;
+	res.info    = ir_nodehashmap_get(be_lv_info_t, &lv->map, block);
+	res.cls     = res.info ? cls - 1 : cls_end - 1;
+	res.cls_end = cls_end;
+	res.word    = 0;
+	res.bits    = 0;
 	return res;
 }
 
 static inline ir_node *be_lv_iteration_next(lv_iterator_t *iterator,
                                             be_lv_state_t flags)
 {
-	while (iterator->i != 0) {
-		be_lv_info_node_t const *const node = &iterator->info->nodes[--iterator->i];
-		assert(get_irn_mode(node->node) != mode_T);
-		if (node->flags & flags)
-			return node->node;
+	while (iterator->bits == 0) {
+		if (iterator->word == 0) {
+			do {
+				if (++iterator->cls >= iterator->cls_end)
+					return NULL;
+			} while (iterator->info->sets[iterator->cls] == NULL);
+			iterator->word = iterator->lv->classes[iterator->cls].n_words;
+		}
+
+		be_lv_class_t  const *const cls  = &iterator->lv->classes[iterator->cls];
+		unsigned       const *const sets = iterator->info->sets[iterator->cls];
+		unsigned              const n    = cls->n_words;
+		unsigned              const w    = --iterator->word;
+		unsigned                    bits = 0;
+		if (flags & be_lv_state_in)
+			bits |= sets[w];
+		if (flags & be_lv_state_end)
+			bits |= sets[n + w];
+		if (flags & be_lv_state_out)
+			bits |= sets[2 * n + w];
+		iterator->bits = bits;
 	}
-	return NULL;
+
+	unsigned const bit = BITS_PER_ELEM - 1 - nlz(iterator->bits);
+	iterator->bits &= ~(1u << bit);
+	be_lv_class_t const *const cls  = &iterator->lv->classes[iterator->cls];
+	ir_node             *const node = cls->values[iterator->word * BITS_PER_ELEM + bit];
+	assert(get_irn_mode(node) != mode_T);
+	return node;
 }
 
 static inline ir_node *be_lv_iteration_cls_next(lv_iterator_t *iterator,
                                                 be_lv_state_t flags,
                                                 const arch_register_class_t *cls)
 {
-	while (iterator->i != 0) {
-		be_lv_info_node_t const *const lnode = &iterator->info->nodes[--iterator->i];
-		assert(get_irn_mode(lnode->node) != mode_T);
-		if (!(lnode->flags & flags))
-			continue;
-
-		ir_node *const node = lnode->node;
-		if (!arch_irn_consider_in_reg_alloc(cls, node))
-			continue;
-		return node;
+	for (ir_node *node; (node = be_lv_iteration_next(iterator, flags)) != NULL;) {
+		if (arch_irn_consider_in_reg_alloc(cls, node))
+			return node;
 	}
 	return NULL;
 }
 
 #define be_lv_foreach(lv, block, flags, node) \
 	for (bool once = true; once;) \
-		for (lv_iterator_t iter = be_lv_iteration_begin((lv), (block)); once; once = false) \
+		for (lv_iterator_t iter = be_lv_iteration_begin((lv), (block), 0, (lv)->n_classes); once; once = false) \
 			for (ir_node *node; (node = be_lv_iteration_next(&iter, (flags))) != NULL;)
 
 #define be_lv_foreach_cls(lv, block, flags, cls, node) \
 	for (bool once = true; once;) \
-		for (lv_iterator_t iter = be_lv_iteration_begin((lv), (block)); once; once = false) \
+		for (lv_iterator_t iter = be_lv_iteration_begin((lv), (block), be_lv_get_value_class((lv), (cls)), be_lv_get_value_class((lv), (cls)) + 1); once; once = false) \
 			for (ir_node *node; (node = be_lv_iteration_cls_next(&iter, (flags), (cls))) != NULL;)
 
 #endif
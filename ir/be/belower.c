@@ -18,10 +18,12 @@
 #include "beirg.h"
 #include "belive.h"
 #include "benode.h"
+#include "bera.h"
 #include "besched.h"
 #include "bessaconstr.h"
 #include "bestat.h"
 #include "debug.h"
+#include "statev_t.h"
 #include "ircons.h"
 #include "iredges_t.h"
 #include "irgmod.h"
@@ -39,11 +41,14 @@ DEBUG_ONLY(static firm_dbg_module_t *dbg_permmove;)
 
 /** Lowering walker environment. */
 typedef struct lower_env_t {
-	bool             use_copies;
-	struct obstack   obst;
-	ir_nodehashmap_t live_regs; /**< maps Perm nodes to a raw bitset that
-	                                 maps register indices to register state
-	                                 at end of Perm's block (used=0, free=1) */
+	bool                 use_copies;
+	regalloc_if_t const *regif;
+	unsigned long        n_copies;  /**< Copies inserted for Perms */
+	unsigned long        n_swaps;   /**< transpositions left for the emitter */
+	struct obstack       obst;
+	ir_nodehashmap_t     live_regs; /**< maps Perm nodes to a raw bitset that
+	                                     maps register indices to register state
+	                                     at end of Perm's block (used=0, free=1) */
 } lower_env_t;
 
 /** Holds a Perm register pair. */
@@ -104,6 +109,18 @@ static arch_register_t const *get_free_register(ir_node *const perm, lower_env_t
 
 	ir_node                     *block     = get_nodes_block(perm);
 	arch_register_class_t const *cls       = arch_get_irn_register(get_irn_n(perm, 0))->cls;
+
+	/* A register reserved as scratch by the backend is always free and saves
+	 * scanning the block. */
+	if (env->regif && env->regif->get_scratch_register) {
+		arch_register_t const *const scratch = env->regif->get_scratch_register(cls);
+		if (scratch) {
+			assert(!rbitset_is_set(be_birg_from_irg(get_irn_irg(perm))->allocatable_regs, scratch->global_index)
+			       && "scratch register must not be allocatable");
+			return scratch;
+		}
+	}
+
 	unsigned                    *free_regs = (unsigned*)ir_nodehashmap_get(arch_register_t const, &env->live_regs, perm);
 
 	sched_foreach_non_phi_reverse(block, node) {
@@ -202,6 +219,7 @@ static void lower_perm_node(ir_node *const perm, arch_register_class_t const *co
 			ir_node *const copy = be_new_Copy_before_reg(p->in_node, perm, p->out_reg);
 			DBG((dbg, LEVEL_2, "%+F: inserting %+F for %+F from %s to %s\n", perm, copy, p->in_node, p->in_reg, p->out_reg));
 			exchange(p->out_node, copy);
+			++env->n_copies;
 
 			const unsigned new_k = p->in_reg->index;
 			if (!oregmap[new_k] && !free_reg) {
@@ -242,6 +260,7 @@ static void lower_perm_node(ir_node *const perm, arch_register_class_t const *co
 			do {
 				ir_node *const copy = be_new_Copy_before_reg(p->in_node, perm, p->out_reg);
 				exchange(p->out_node, copy);
+				++env->n_copies;
 				unsigned const in_idx = p->in_reg->index;
 				rbitset_clear(inregs, in_idx);
 				p = oregmap[in_idx];
@@ -250,10 +269,12 @@ static void lower_perm_node(ir_node *const perm, arch_register_class_t const *co
 			rbitset_clear(inregs, start->in_reg->index);
 			ir_node *const restore_copy = be_new_Copy_before_reg(save_copy, perm, start->out_reg);
 			exchange(start->out_node, restore_copy);
+			env->n_copies += 2;
 		}
 	} else {
 		if (arity == 2) {
 			DBG((dbg, LEVEL_1, "%+F is transposition\n", perm));
+			++env->n_swaps;
 			return;
 		}
 
@@ -300,6 +321,7 @@ static void lower_perm_node(ir_node *const perm, arch_register_class_t const *co
 				ir_node *const new_q = be_new_Proj_reg(xchg, 1, q->out_reg);
 				exchange(q->out_node, new_q);
 				sched_add_before(perm, xchg);
+				++env->n_swaps;
 				/* Prevent that the broken down Perm is visited by the walker. */
 				mark_irn_visited(xchg);
 
@@ -500,7 +522,8 @@ static void lower_nodes_after_ra_walker(ir_node *irn, void *walk_env)
 	}
 }
 
-void lower_nodes_after_ra(ir_graph *irg, bool use_copies)
+void lower_nodes_after_ra(ir_graph *irg, bool use_copies,
+                          regalloc_if_t const *regif)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.be.lower");
 	FIRM_DBG_REGISTER(dbg_permmove, "firm.be.lower.permmove");
@@ -510,6 +533,9 @@ void lower_nodes_after_ra(ir_graph *irg, bool use_copies)
 
 	lower_env_t env;
 	env.use_copies = use_copies;
+	env.regif      = regif;
+	env.n_copies   = 0;
+	env.n_swaps    = 0;
 
 	if (use_copies) {
 		ir_nodehashmap_init(&env.live_regs);
@@ -520,6 +546,15 @@ void lower_nodes_after_ra(ir_graph *irg, bool use_copies)
 
 	irg_walk_graph(irg, NULL, lower_nodes_after_ra_walker, &env);
 
+	if (stat_ev_enabled) {
+		stat_ev_ull("belower_perm_copies", env.n_copies);
+		stat_ev_ull("belower_perm_swaps", env.n_swaps);
+
+		be_node_stats_t node_stats;
+		be_collect_node_stats(&node_stats, irg);
+		be_emit_node_stats(&node_stats, "belower_");
+	}
+
 	if (use_copies) {
 		ir_nodehashmap_destroy(&env.live_regs);
 		obstack_free(&env.obst, NULL);
@@ -14,8 +14,8 @@
 #define FIRM_BE_BELOWER_H
 
 #include <stdbool.h>
+#include "be_types.h"
 #include "firm_types.h"
-#include <stdbool.h>
 
 /**
  * Walks over all blocks in an irg and performs lowering need to be
@@ -23,7 +23,10 @@
  *
  * @param irg         The graph
  * @param use_copies  Implement cycles using copies if a free reg is available
+ * @param regif       The register allocator interface of the backend, which may
+ *                    provide a scratch register to break cycles with
  */
-void lower_nodes_after_ra(ir_graph *irg, bool use_copies);
+void lower_nodes_after_ra(ir_graph *irg, bool use_copies,
+                          regalloc_if_t const *regif);
 
 #endif
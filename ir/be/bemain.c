@@ -37,6 +37,7 @@
 #include "irdump.h"
 #include "iredges_t.h"
 #include "irgopt.h"
+#include "irgwalk.h"
 #include "irloop_t.h"
 #include "iroptimize.h"
 #include "irprofile.h"
@@ -313,7 +314,7 @@ static ir_graph *be_prepare_profile(const char *const cup_name)
 	return prof_init_irg;
 }
 
-void be_begin(FILE *file_handle, const char *cup_name)
+static void begin_compilation_unit(FILE *file_handle, const char *cup_name)
 {
 	memset(be_asm_constraint_flags, 0, sizeof(be_asm_constraint_flags));
 
@@ -381,10 +382,21 @@ void be_begin(FILE *file_handle, const char *cup_name)
 	ir_graph *prof_init_irg = be_prepare_profile(cup_name);
 	if (prof_init_irg != NULL)
 		initialize_birg(&birgs[num_birgs++], prof_init_irg, &env);
+}
 
+void be_begin(FILE *file_handle, const char *cup_name)
+{
+	begin_compilation_unit(file_handle, cup_name);
 	be_gas_begin_compilation_unit(&env);
 }
 
+void be_begin_object(const char *cup_name)
+{
+	if (be_dwarf_enabled())
+		be_warningf(NULL, "no debug information is written to object files");
+	begin_compilation_unit(NULL, cup_name);
+}
+
 void firm_be_finish(void)
 {
 	finish_isa();
@@ -549,10 +561,8 @@ void be_step_last(ir_graph *irg)
 	set_opt_cse(cse_setting);
 }
 
-void be_finish(void)
+static void finish_compilation_unit(void)
 {
-	be_gas_end_compilation_unit(&env);
-
 	if (be_options.timing) {
 		ir_timer_stop(bemain_timer);
 		ir_timer_leave_high_priority();
@@ -577,12 +587,54 @@ void be_finish(void)
 	free_type(env.pic_symbols_type);
 }
 
+void be_finish(void)
+{
+	be_gas_end_compilation_unit(&env);
+	finish_compilation_unit();
+}
+
+void be_finish_object(void)
+{
+	finish_compilation_unit();
+}
+
 void be_main(FILE *file_handle, const char *cup_name)
 {
 	/* Let the target control how the codegeneration works. */
 	ir_target.isa->generate_code(file_handle, cup_name);
 }
 
+static void find_asm_walker(ir_node *const node, void *const data)
+{
+	if (is_ASM(node))
+		*(bool*)data = true;
+}
+
+/**
+ * Checks whether the program contains global or inline assembler statements,
+ * which only the assembler can translate.
+ */
+static bool has_asm(void)
+{
+	if (get_irp_n_asms() > 0)
+		return true;
+	foreach_irp_irg(i, irg) {
+		bool found = false;
+		irg_walk_graph(irg, NULL, find_asm_walker, &found);
+		if (found)
+			return true;
+	}
+	return false;
+}
+
+int be_main_object(FILE *file_handle, const char *cup_name)
+{
+	if (ir_target.isa->generate_object == NULL || has_asm())
+		return 0;
+	ir_target.isa->generate_object(file_handle, cup_name);
+	return 1;
+}
+
 ir_jit_function_t *be_jit_compile(ir_jit_segment_t *const segment,
                                   ir_graph *const irg)
 {
@@ -39,6 +39,7 @@ void be_init_copynone(void);
 void be_init_copyopt(void);
 void be_init_daemelspill(void);
 void be_init_dwarf(void);
+void be_init_linearscan(void);
 void be_init_listsched(void);
 void be_init_live(void);
 void be_init_loopana(void);
@@ -48,6 +49,7 @@ void be_init_peephole(void);
 void be_init_pref_alloc(void);
 void be_init_ra(void);
 void be_init_sched(void);
+void be_init_sched_latency(void);
 void be_init_sched_normal(void);
 void be_init_sched_rand(void);
 void be_init_sched_trivial(void);
@@ -100,11 +102,13 @@ void be_init_modules(void)
 
 	be_init_listsched();
 	be_init_sched_normal();
+	be_init_sched_latency();
 	be_init_sched_rand();
 	be_init_sched_trivial();
 
 	be_init_chordal_main();
 	be_init_pref_alloc();
+	be_init_linearscan();
 
 	be_init_chordal();
 	be_init_pbqp_coloring();
@@ -47,6 +47,16 @@ struct regalloc_if_t {
 	 * be done by targets that support memory addressing modes.
 	 */
 	void (*perform_memory_operand)(ir_node *irn, unsigned i);
+
+	/**
+	 * Returns a register of class @p cls which is never allocated and may be
+	 * clobbered between any two instructions, or NULL if there is none.
+	 * Perm lowering uses it to break register cycles with plain copies.
+	 * The register must never appear in any register requirement, so it has
+	 * to be excluded from the allocatable registers, which also makes asm
+	 * clobbers of it ineffective.
+	 */
+	arch_register_t const *(*get_scratch_register)(arch_register_class_t const *cls);
 };
 
 /**
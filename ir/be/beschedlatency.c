@@ -0,0 +1,199 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief       Latency driven list scheduler.
+ *
+ * Classic critical path list scheduling: Every node gets the length of the
+ * longest latency weighted path from it to the end of its block. The
+ * selector keeps track of an issue cycle and prefers nodes whose operands are
+ * already computed, among them the one with the longest remaining path.
+ * Latencies are taken from the estimated costs of the target isa.
+ */
+#include "array.h"
+#include "bearch.h"
+#include "belistsched.h"
+#include "bemodule.h"
+#include "besched.h"
+#include "debug.h"
+#include "iredges_t.h"
+#include "irgwalk.h"
+#include "irnode_t.h"
+#include "irnodeset.h"
+#include "target_t.h"
+#include "xmalloc.h"
+#include <stdlib.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
+
+typedef struct latency_info_t {
+	unsigned height;    /**< longest latency path to the end of the block */
+	unsigned ready;     /**< cycle in which the result becomes available */
+	bool     visited;   /**< reached by compute_height() */
+} latency_info_t;
+
+static latency_info_t *infos;
+static unsigned        cycle;
+
+static latency_info_t *get_info(const ir_node *node)
+{
+	return &infos[get_irn_idx(node)];
+}
+
+static unsigned get_latency(const ir_node *node)
+{
+	if (arch_is_irn_not_scheduled(node))
+		return 0;
+	return ir_target.isa->get_op_estimated_cost(node);
+}
+
+static bool is_user_in_block(const ir_node *user, const ir_node *block)
+{
+	return !is_Block(user) && !is_Phi(user) && get_nodes_block(user) == block;
+}
+
+typedef struct height_frame_t {
+	ir_node *node;
+	bool     users_done; /**< the heights of all users are known */
+} height_frame_t;
+
+/**
+ * Computes the heights of @p root and its users in the block in post order.
+ * The dependence chains in large generated blocks can be very long, so this
+ * uses an explicit stack instead of recursion.
+ */
+static void compute_height(ir_node *root)
+{
+	if (get_info(root)->visited)
+		return;
+
+	ir_node *const  block = get_nodes_block(root);
+	height_frame_t *stack = NEW_ARR_F(height_frame_t, 0);
+	ARR_APP1(height_frame_t, stack, ((height_frame_t){ root, false }));
+	while (ARR_LEN(stack) > 0) {
+		height_frame_t const frame = stack[ARR_LEN(stack) - 1];
+		ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+		ir_node        *const node = frame.node;
+		latency_info_t *const info = get_info(node);
+
+		if (frame.users_done) {
+			unsigned height = 0;
+			foreach_out_edge(node, edge) {
+				ir_node *const user = get_edge_src_irn(edge);
+				if (!is_user_in_block(user, block))
+					continue;
+				unsigned const user_height = get_info(user)->height;
+				if (user_height > height)
+					height = user_height;
+			}
+			info->height = height + get_latency(node);
+			continue;
+		}
+
+		if (info->visited)
+			continue;
+		info->visited = true;
+		ARR_APP1(height_frame_t, stack, ((height_frame_t){ node, true }));
+		foreach_out_edge(node, edge) {
+			ir_node *const user = get_edge_src_irn(edge);
+			if (is_user_in_block(user, block) && !get_info(user)->visited)
+				ARR_APP1(height_frame_t, stack, ((height_frame_t){ user, false }));
+		}
+	}
+	DEL_ARR_F(stack);
+}
+
+/**
+ * Returns the first cycle in which all operands of @p node from the current
+ * block are available.
+ */
+static unsigned get_operands_ready(const ir_node *node)
+{
+	ir_node *const block = get_nodes_block(node);
+	unsigned       ready = 0;
+	foreach_irn_in(node, i, pred) {
+		ir_node *op = pred;
+		while (is_Proj(op))
+			op = get_Proj_pred(op);
+		if (is_Block(op) || get_nodes_block(op) != block)
+			continue;
+		unsigned const op_ready = get_info(op)->ready;
+		if (op_ready > ready)
+			ready = op_ready;
+	}
+	return ready;
+}
+
+static ir_node *latency_select(ir_nodeset_t *ready_set)
+{
+	ir_node *best         = NULL;
+	unsigned best_height  = 0;
+	ir_node *stall        = NULL;
+	unsigned stall_ready  = 0;
+	unsigned stall_height = 0;
+	foreach_ir_nodeset(ready_set, node, iter) {
+		unsigned const height = get_info(node)->height;
+		unsigned const ready  = get_operands_ready(node);
+		if (ready <= cycle) {
+			if (best == NULL || height > best_height
+			    || (height == best_height && get_irn_idx(node) < get_irn_idx(best))) {
+				best        = node;
+				best_height = height;
+			}
+		} else if (stall == NULL || ready < stall_ready
+		           || (ready == stall_ready && height > stall_height)) {
+			stall        = node;
+			stall_ready  = ready;
+			stall_height = height;
+		}
+	}
+
+	/* nothing can issue without waiting: advance to the earliest candidate */
+	if (best == NULL) {
+		cycle = stall_ready;
+		best  = stall;
+	}
+	return best;
+}
+
+static void sched_block(ir_node *block, void *data)
+{
+	(void)data;
+	foreach_out_edge(block, edge) {
+		ir_node *const node = get_edge_src_irn(edge);
+		if (!is_Block(node))
+			compute_height(node);
+	}
+
+	cycle = 0;
+	ir_nodeset_t *cands = be_list_sched_begin_block(block);
+	while (ir_nodeset_size(cands) > 0) {
+		ir_node *const node = latency_select(cands);
+		DB((dbg, LEVEL_2, "cycle %u: %+F (height %u)\n", cycle, node,
+		    get_info(node)->height));
+		get_info(node)->ready = cycle + get_latency(node);
+		be_list_sched_schedule(node);
+		++cycle;
+	}
+	be_list_sched_end_block();
+}
+
+static void sched_latency(ir_graph *irg)
+{
+	be_list_sched_begin(irg);
+	infos = XMALLOCNZ(latency_info_t, get_irg_last_idx(irg));
+	irg_block_walk_graph(irg, sched_block, NULL, NULL);
+	free(infos);
+	infos = NULL;
+	be_list_sched_finish();
+}
+
+BE_REGISTER_MODULE_CONSTRUCTOR(be_init_sched_latency)
+void be_init_sched_latency(void)
+{
+	be_register_scheduler("latency", sched_latency);
+	FIRM_DBG_REGISTER(dbg, "firm.be.sched.latency");
+}
@@ -16,12 +16,14 @@
 #include "bearch.h"
 #include "bechordal_t.h"
 #include "beirg.h"
+#include "belive.h"
 #include "bemodule.h"
 #include "benode.h"
 #include "besched.h"
 #include "bespill.h"
 #include "bessaconstr.h"
 #include "beutil.h"
+#include "beverify.h"
 #include "debug.h"
 #include "execfreq.h"
 #include "ident_t.h"
@@ -540,6 +542,8 @@ void be_insert_spills_reloads(spill_env_t *env)
 {
 	be_timer_push(T_RA_SPILL_APPLY);
 
+	unsigned const first_new_idx = get_irg_last_idx(env->irg);
+
 	/* create all phi-ms first, this is needed so, that phis, hanging on
 	   spilled phis work correctly */
 	for (spill_info_t *info = env->mem_phis; info != NULL;
@@ -669,12 +673,24 @@ void be_insert_spills_reloads(spill_env_t *env)
 	stat_ev_dbl("spill_remats", env->remat_count);
 	stat_ev_dbl("spill_spilled_phis", env->spilled_phi_count);
 
-	/* Matze: In theory be_ssa_construction should take care of the liveness...
-	 * try to disable this again in the future */
-	be_invalidate_live_sets(env->irg);
+	/* Update the liveness of the spilled values and the inserted nodes instead
+	 * of recomputing it for the coloring. */
+	be_lv_t *const lv = be_get_irg_liveness(env->irg);
+	if (lv->sets_valid) {
+		ir_node **spilled = NEW_ARR_F(ir_node*, 0);
+		for (spill_info_t *si = env->spills; si != NULL; si = si->next)
+			ARR_APP1(ir_node*, spilled, si->to_spill);
+		be_liveness_update_new_nodes(lv, first_new_idx, spilled, ARR_LEN(spilled));
+		DEL_ARR_F(spilled);
+	}
 
 	be_remove_dead_nodes_from_schedule(env->irg);
 
+	/* The nodes made dead by the reloads are not part of the liveness until
+	 * they are removed from the schedule, so check afterwards. */
+	if (be_options.do_verify && lv->sets_valid)
+		be_liveness_check(lv);
+
 	be_timer_pop(T_RA_SPILL_APPLY);
 }
 
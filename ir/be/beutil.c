@@ -109,8 +109,9 @@ ir_node *insert_Perm_before(ir_graph *irg, const arch_register_class_t *cls,
 //---------------------------------------------------------------------------
 
 typedef struct remove_dead_nodes_env_t_ {
-	bitset_t *reachable;
-	be_lv_t  *lv;
+	bitset_t  *reachable;
+	be_lv_t   *lv;
+	ir_node  **operands; /**< reachable operands of removed nodes */
 } remove_dead_nodes_env_t;
 
 /**
@@ -134,8 +135,14 @@ static void remove_dead_nodes_walker(ir_node *block, void *data)
 		if (bitset_is_set(env->reachable, get_irn_idx(node)))
 			continue;
 
-		if (env->lv->sets_valid)
+		if (env->lv->sets_valid) {
 			be_liveness_remove(env->lv, node);
+			/* The operands lose a user, so their liveness may shrink. */
+			foreach_irn_in(node, i, op) {
+				if (bitset_is_set(env->reachable, get_irn_idx(op)))
+					ARR_APP1(ir_node*, env->operands, op);
+			}
+		}
 		sched_remove(node);
 
 		/* kill projs */
@@ -158,12 +165,25 @@ void be_remove_dead_nodes_from_schedule(ir_graph *irg)
 	remove_dead_nodes_env_t env;
 	env.reachable = bitset_alloca(get_irg_last_idx(irg));
 	env.lv        = be_get_irg_liveness(irg);
+	env.operands  = NEW_ARR_F(ir_node*, 0);
 
 	/* mark all reachable nodes */
 	irg_walk_graph(irg, mark_dead_nodes_walker, NULL, &env);
 
 	/* walk schedule and remove non-marked nodes */
 	irg_block_walk_graph(irg, remove_dead_nodes_walker, NULL, &env);
+
+	/* update the liveness of the operands of the removed nodes */
+	for (size_t i = 0, n = ARR_LEN(env.operands); i < n; ++i) {
+		ir_node *const op  = env.operands[i];
+		unsigned const idx = get_irn_idx(op);
+		if (!bitset_is_set(env.reachable, idx))
+			continue;
+		/* only update each operand once */
+		bitset_clear(env.reachable, idx);
+		be_liveness_update(env.lv, op);
+	}
+	DEL_ARR_F(env.operands);
 }
 
 void be_keep_if_unused(ir_node *node)
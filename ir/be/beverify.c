@@ -469,24 +469,28 @@ static const char *lv_flags_to_str(unsigned flags)
 
 static void lv_check_walker(ir_node *bl, void *data)
 {
-	lv_walker_t    *const w       = (lv_walker_t*)data;
-	be_lv_info_t   *const curr    = ir_nodehashmap_get(be_lv_info_t, &w->given->map, bl);
-	be_lv_info_t   *const fresh   = ir_nodehashmap_get(be_lv_info_t, &w->fresh->map, bl);
-	unsigned const        n_curr  = curr  ? curr->n_members  : 0;
-	unsigned const        n_fresh = fresh ? fresh->n_members : 0;
-	if (n_curr != n_fresh) {
-		ir_fprintf(stderr, "%+F: liveness set sizes differ. curr %d, correct %d\n", bl, n_curr, n_fresh);
+	be_lv_state_t const all    = be_lv_state_in | be_lv_state_end | be_lv_state_out;
+	lv_walker_t  *const w      = (lv_walker_t*)data;
+	bool                differ = false;
+	be_lv_foreach(w->fresh, bl, all, node) {
+		if (be_lv_get(w->given, bl, node) != be_lv_get(w->fresh, bl, node))
+			differ = true;
+	}
+	be_lv_foreach(w->given, bl, all, node) {
+		if (be_lv_get(w->given, bl, node) != be_lv_get(w->fresh, bl, node))
+			differ = true;
+	}
+	if (differ) {
+		ir_fprintf(stderr, "%+F: liveness sets differ\n", bl);
 
 		ir_fprintf(stderr, "current:\n");
-		for (unsigned i = 0; i < n_curr; ++i) {
-			be_lv_info_node_t *const n = &curr->nodes[i];
-			ir_fprintf(stderr, "%+F %u %+F %s\n", bl, i, n->node, lv_flags_to_str(n->flags));
+		be_lv_foreach(w->given, bl, all, node) {
+			ir_fprintf(stderr, "%+F %+F %s\n", bl, node, lv_flags_to_str(be_lv_get(w->given, bl, node)));
 		}
 
 		ir_fprintf(stderr, "correct:\n");
-		for (unsigned i = 0; i < n_fresh; ++i) {
-			be_lv_info_node_t *const n = &fresh->nodes[i];
-			ir_fprintf(stderr, "%+F %u %+F %s\n", bl, i, n->node, lv_flags_to_str(n->flags));
+		be_lv_foreach(w->fresh, bl, all, node) {
+			ir_fprintf(stderr, "%+F %+F %s\n", bl, node, lv_flags_to_str(be_lv_get(w->fresh, bl, node)));
 		}
 	}
 }
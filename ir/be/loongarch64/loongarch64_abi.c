@@ -0,0 +1,195 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   aggregate parameter and result lowering for the LoongArch LP64D ABI
+ */
+#include "loongarch64_abi.h"
+
+#include "firm.h"
+#include "panic.h"
+#include "type_t.h"
+#include "util.h"
+
+#define GRLEN 8
+
+static unsigned const max_gp_params  = 8;
+static unsigned const max_fp_params  = 8;
+static unsigned const max_gp_results = 2;
+static unsigned const max_fp_results = 2;
+
+// A scalar member of a flattened aggregate.
+typedef struct leaf_t {
+    ir_mode *mode;
+    unsigned offset;
+} leaf_t;
+
+// Collects the scalar members of `tp` at `offset`, nested structs and arrays
+// are flattened. Returns false if `tp` cannot be passed with the float-point
+// calling convention, i.e. it has more than two members, unions, bitfields or
+// unaligned members.
+static bool flatten_type(ir_type const *const tp, unsigned const offset, leaf_t *const leaves, unsigned *const n) {
+    switch (get_type_opcode(tp)) {
+    case tpo_class:
+    case tpo_struct:
+        for (size_t i = 0, n_members = get_compound_n_members(tp); i != n_members; ++i) {
+            ir_entity *const member = get_compound_member(tp, i);
+            if (get_entity_bitfield_size(member) != 0 || get_entity_aligned(member) == align_non_aligned)
+                return false;
+            if (!flatten_type(get_entity_type(member), offset + get_entity_offset(member), leaves, n))
+                return false;
+        }
+        return true;
+
+    case tpo_array: {
+        ir_type const *const elem_type = get_array_element_type(tp);
+        unsigned const       elem_size = get_type_size(elem_type);
+        for (unsigned i = 0, n_elems = get_array_size(tp); i != n_elems; ++i) {
+            if (!flatten_type(elem_type, offset + i * elem_size, leaves, n))
+                return false;
+        }
+        return true;
+    }
+
+    case tpo_primitive:
+    case tpo_pointer:
+        if (*n == MAX_REGS_PER_AGGREGATE)
+            return false;
+        leaves[*n].mode   = get_type_mode(tp);
+        leaves[*n].offset = offset;
+        ++*n;
+        return true;
+
+    case tpo_union:
+        return false;
+
+    case tpo_code:
+    case tpo_method:
+    case tpo_segment:
+    case tpo_uninitialized:
+    case tpo_unknown:
+        break;
+    }
+    panic("invalid type");
+}
+
+static bool use_register(unsigned *const used, unsigned const max) {
+    if (*used < max) {
+        ++*used;
+        return true;
+    }
+    return false;
+}
+
+// Returns the mode of the first register of a pair, which also has to cover
+// the padding up to the second member.
+static ir_mode *widen_first_mode(ir_mode *const mode, unsigned const size) {
+    if (get_mode_size_bytes(mode) == size)
+        return mode;
+    if (mode_is_float(mode))
+        return size == 8 ? mode_D : NULL;
+    switch (size) {
+    case 2: return mode_Hu;
+    case 4: return mode_Iu;
+    case 8: return mode_Lu;
+    default: return NULL;
+    }
+}
+
+static ir_mode *leaf_mode(ir_mode *const mode) { return mode_is_reference(mode) ? mode_Lu : mode; }
+
+// Tries the float-point calling convention: a single float-point member, two
+// float-point members or one float-point and one integer member are passed in
+// float-point and general purpose registers, if enough of them are left.
+static bool classify_float_aggregate(loongarch64_abi_state *const s, ir_type const *const tp, unsigned const max_gp,
+                                     unsigned const max_fp, aggregate_spec_t *const spec) {
+    leaf_t   leaves[MAX_REGS_PER_AGGREGATE];
+    unsigned n = 0;
+    if (!flatten_type(tp, 0, leaves, &n) || n == 0 || leaves[0].offset != 0)
+        return false;
+
+    unsigned n_fp = 0;
+    for (unsigned i = 0; i != n; ++i) {
+        if (mode_is_float(leaves[i].mode))
+            ++n_fp;
+    }
+    if (n_fp == 0)
+        return false;
+
+    if (n == 1) {
+        if (s->fp >= max_fp)
+            return false;
+        s->fp += 1;
+        *spec = (aggregate_spec_t){ .length = 1, .modes = { leaves[0].mode } };
+        return true;
+    }
+
+    ir_mode *const first = widen_first_mode(leaf_mode(leaves[0].mode), leaves[1].offset);
+    if (!first)
+        return false;
+    unsigned const n_gp = n - n_fp;
+    if (s->fp + n_fp > max_fp || s->gp + n_gp > max_gp)
+        return false;
+    s->fp += n_fp;
+    s->gp += n_gp;
+    *spec = (aggregate_spec_t){ .length = 2, .modes = { first, leaf_mode(leaves[1].mode) } };
+    return true;
+}
+
+// Aggregates up to 2*GRLEN bytes are passed in registers, larger ones by
+// reference.
+static aggregate_spec_t classify_aggregate(loongarch64_abi_state *const s, ir_type const *const tp,
+                                           unsigned const max_gp, unsigned const max_fp) {
+    unsigned const size = get_type_size(tp);
+    if (size > 2 * GRLEN) {
+        use_register(&s->gp, max_gp);
+        return (aggregate_spec_t){ .length = 1, .modes = { mode_P } };
+    }
+
+    aggregate_spec_t spec;
+    if (classify_float_aggregate(s, tp, max_gp, max_fp, &spec))
+        return spec;
+
+    // Integer calling convention, once the registers are exhausted the
+    // remaining words go to the stack.
+    spec.length = 0;
+    for (unsigned offset = 0; offset < size; offset += GRLEN) {
+        use_register(&s->gp, max_gp);
+        spec.modes[spec.length++] = mode_Lu;
+    }
+    return spec;
+}
+
+static void notify_scalar(loongarch64_abi_state *const s, ir_type const *const tp, unsigned const max_gp,
+                          unsigned const max_fp) {
+    ir_mode *const mode = get_type_mode(tp);
+    if (mode && mode_is_float(mode) && use_register(&s->fp, max_fp))
+        return;
+    use_register(&s->gp, max_gp);
+}
+
+void loongarch64_reset_abi_state(void *const param_env, void *const result_env) {
+    loongarch64_abi_state *const param_state  = (loongarch64_abi_state *)param_env;
+    loongarch64_abi_state *const result_state = (loongarch64_abi_state *)result_env;
+    *param_state                              = (loongarch64_abi_state){ 0, 0 };
+    *result_state                             = (loongarch64_abi_state){ 0, 0 };
+}
+
+aggregate_spec_t loongarch64_lower_parameter(void *const env, ir_type const *const type) {
+    loongarch64_abi_state *const state = (loongarch64_abi_state *)env;
+    if (is_aggregate_type(type))
+        return classify_aggregate(state, type, max_gp_params, max_fp_params);
+    notify_scalar(state, type, max_gp_params, max_fp_params);
+    return (aggregate_spec_t){ .length = 1, .modes = { get_type_mode(type) } };
+}
+
+aggregate_spec_t loongarch64_lower_result(void *const env, ir_type const *const type) {
+    loongarch64_abi_state *const state = (loongarch64_abi_state *)env;
+    if (is_aggregate_type(type))
+        return classify_aggregate(state, type, max_gp_results, max_fp_results);
+    notify_scalar(state, type, max_gp_results, max_fp_results);
+    return (aggregate_spec_t){ .length = 1, .modes = { get_type_mode(type) } };
+}
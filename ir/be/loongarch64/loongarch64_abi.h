@@ -0,0 +1,28 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   aggregate parameter and result lowering for the LoongArch LP64D ABI
+ */
+#ifndef FIRM_BE_loongarch64_loongarch64_ABI_H
+#define FIRM_BE_loongarch64_loongarch64_ABI_H
+
+#include "firm_types.h"
+#include "lower_calls.h"
+
+/** Number of general purpose and float-point argument registers in use. */
+typedef struct loongarch64_abi_state {
+    unsigned gp;
+    unsigned fp;
+} loongarch64_abi_state;
+
+aggregate_spec_t loongarch64_lower_parameter(void *env, ir_type const *type);
+
+aggregate_spec_t loongarch64_lower_result(void *env, ir_type const *type);
+
+void loongarch64_reset_abi_state(void *param_env, void *result_env);
+
+#endif
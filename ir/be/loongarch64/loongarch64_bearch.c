@@ -9,29 +9,78 @@
  */
 #include "be2addr.h"
 #include "be_t.h"
+#include "beflags.h"
 #include "beirg.h"
 #include "bemodule.h"
 #include "benode.h"
 #include "bera.h"
 #include "besched.h"
 #include "bespillslots.h"
+#include "bitfiddle.h"
 #include "bestack.h"
 #include "betranshlp.h"
+#include "beutil.h"
 #include "debug.h"
 #include "gen_loongarch64_regalloc_if.h"
 #include "irarch.h"
+#include "ircons_t.h"
+#include "irdom.h"
 #include "iredges_t.h"
+#include "irgmod.h"
 #include "irgwalk.h"
 #include "irprog_t.h"
+#include "irtools.h"
 #include "isas.h"
+#include "lc_opts_enum.h"
 #include "lowering.h"
+#include "loongarch64_abi.h"
+#include "loongarch64_bearch_t.h"
 #include "loongarch64_emitter.h"
+#include "loongarch64_encode.h"
 #include "loongarch64_new_nodes.h"
+#include "loongarch64_optimize.h"
 #include "loongarch64_transform.h"
 #include "lower_builtins.h"
 #include "lower_calls.h"
 #include "panic.h"
+#include "platform_t.h"
 #include "target_t.h"
+#include "util.h"
+
+loongarch64_cpu_t loongarch64_cpu = loongarch64_cpu_la464;
+
+static const lc_opt_enum_int_items_t cpu_items[] = {
+    { "la464",  loongarch64_cpu_la464 },
+    { "3a5000", loongarch64_cpu_la464 },
+    { "la664",  loongarch64_cpu_la664 },
+    { "3a6000", loongarch64_cpu_la664 },
+    { NULL,     0                     },
+};
+
+static int cpu = loongarch64_cpu_la464;
+static lc_opt_enum_int_var_t cpu_var = {
+    &cpu, cpu_items
+};
+
+loongarch64_simd_t loongarch64_simd = loongarch64_simd_lsx;
+
+static const lc_opt_enum_int_items_t simd_items[] = {
+    { "none", loongarch64_simd_none },
+    { "lsx",  loongarch64_simd_lsx  },
+    { "lasx", loongarch64_simd_lasx },
+    { NULL,   0                     },
+};
+
+static int simd = loongarch64_simd_lsx;
+static lc_opt_enum_int_var_t simd_var = {
+    &simd, simd_items
+};
+
+static const lc_opt_table_entry_t loongarch64_options[] = {
+    LC_OPT_ENT_ENUM_INT("cpu", "select the core to tune for", &cpu_var),
+    LC_OPT_ENT_ENUM_INT("simd", "select the vector extension to use", &simd_var),
+    LC_OPT_LAST
+};
 
 /**
  * Transforms the standard firm graph into a loongarch64 firm graph
@@ -47,54 +96,166 @@ static void loongarch64_select_instructions(ir_graph *irg) {
     be_dump(DUMP_BE, irg, "place");
 }
 
+typedef ir_node *(*cons_loadop)(dbg_info *, ir_node *, ir_node *, ir_node *, ir_entity *, int64_t);
+typedef ir_node *(*cons_storeop)(dbg_info *, ir_node *, ir_node *, ir_node *, ir_node *, ir_entity *, int64_t);
+
+// Returns whether @p value is an operand of a Phi. A spilled Phi shares the
+// spill slot with its operands and reloads the whole register.
+static bool is_phi_operand(ir_node const *const value) {
+    foreach_out_edge(value, edge) {
+        if (is_Phi(get_edge_src_irn(edge)))
+            return true;
+    }
+    return false;
+}
+
+// Returns whether only the low 32 bits of the float-point register holding
+// @p value carry its value.
+static bool is_single_fp(ir_node const *const value) {
+    ir_node const *const node = skip_Proj_const(value);
+    if (!is_loongarch64_irn(node))
+        return false;
+    switch ((loongarch64_opcodes)get_loongarch64_irn_opcode(node)) {
+    case iro_loongarch64_fld_s:
+    case iro_loongarch64_fldx_s:
+    case iro_loongarch64_fadd_s:
+    case iro_loongarch64_fsub_s:
+    case iro_loongarch64_fmul_s:
+    case iro_loongarch64_fdiv_s:
+    case iro_loongarch64_fmax_s:
+    case iro_loongarch64_fmin_s:
+    case iro_loongarch64_fabs_s:
+    case iro_loongarch64_fneg_s:
+    case iro_loongarch64_fsqrt_s:
+    case iro_loongarch64_fmadd_s:
+    case iro_loongarch64_fmsub_s:
+    case iro_loongarch64_fnmadd_s:
+    case iro_loongarch64_fnmsub_s:
+    case iro_loongarch64_ffint_s_w:
+    case iro_loongarch64_ffint_s_l:
+    case iro_loongarch64_fcvt_s_d:
+    case iro_loongarch64_ftintrz_w_s:
+    case iro_loongarch64_ftintrz_w_d:
+    case iro_loongarch64_movgr2fr_w:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Returns the load, which restores @p value from a spill slot of the width
+// of the load. Values known to be sign or zero extended from a narrower width
+// only need the low bytes spilled, all others need the whole register.
+static cons_loadop get_reload_cons(ir_node const *const value) {
+    bool const phi_operand = is_phi_operand(value);
+    if (mode_is_float(get_irn_mode(value)))
+        return !phi_operand && is_single_fp(value) ? new_bd_loongarch64_fld_s : new_bd_loongarch64_fld_d;
+    if (!phi_operand) {
+        if (loongarch64_is_sign_extended(value, 8))
+            return new_bd_loongarch64_ld_b;
+        if (loongarch64_is_zero_extended(value, 8))
+            return new_bd_loongarch64_ld_bu;
+        if (loongarch64_is_sign_extended(value, 16))
+            return new_bd_loongarch64_ld_h;
+        if (loongarch64_is_zero_extended(value, 16))
+            return new_bd_loongarch64_ld_hu;
+        if (loongarch64_is_sign_extended(value, 32))
+            return new_bd_loongarch64_ld_w;
+        if (loongarch64_is_zero_extended(value, 32))
+            return new_bd_loongarch64_ld_wu;
+    }
+    return new_bd_loongarch64_ld_d;
+}
+
+// Returns the store, which spills the bytes of @p value its reload restores.
+static cons_storeop get_spill_cons(ir_node const *const value) {
+    cons_loadop const reload = get_reload_cons(value);
+    if (reload == new_bd_loongarch64_ld_b || reload == new_bd_loongarch64_ld_bu)
+        return new_bd_loongarch64_st_b;
+    if (reload == new_bd_loongarch64_ld_h || reload == new_bd_loongarch64_ld_hu)
+        return new_bd_loongarch64_st_h;
+    if (reload == new_bd_loongarch64_ld_w || reload == new_bd_loongarch64_ld_wu)
+        return new_bd_loongarch64_st_w;
+    if (reload == new_bd_loongarch64_fld_s)
+        return new_bd_loongarch64_fst_s;
+    if (reload == new_bd_loongarch64_fld_d)
+        return new_bd_loongarch64_fst_d;
+    return new_bd_loongarch64_st_d;
+}
+
 static ir_node *loongarch64_new_spill(ir_node *value, ir_node *after) {
     ir_mode *const mode = get_irn_mode(value);
-    if (be_mode_needs_gp_reg(mode)) {
-        ir_node *const  block = get_block(after);
-        ir_graph *const irg   = get_irn_irg(after);
-        ir_node *const  nomem = get_irg_no_mem(irg);
-        ir_node *const  frame = get_irg_frame(irg);
-        ir_node *const  store = new_bd_loongarch64_st_d(NULL, block, nomem, frame, value, NULL, 0);
-        sched_add_after(after, store);
-        return store;
-    }
-    TODO(value);
+    if (!be_mode_needs_gp_reg(mode) && !mode_is_float(mode))
+        TODO(value);
+
+    ir_node *const  block = get_block(after);
+    ir_graph *const irg   = get_irn_irg(after);
+    ir_node *const  nomem = get_irg_no_mem(irg);
+    ir_node *const  frame = get_irg_frame(irg);
+    ir_node *const  store = get_spill_cons(value)(NULL, block, nomem, frame, value, NULL, 0);
+    sched_add_after(after, store);
+    return store;
 }
 
 static ir_node *loongarch64_new_reload(ir_node *value, ir_node *spill, ir_node *before) {
     ir_mode *const mode = get_irn_mode(value);
-    if (be_mode_needs_gp_reg(mode)) {
-        ir_node *const  block = get_block(before);
-        ir_graph *const irg   = get_irn_irg(before);
-        ir_node *const  frame = get_irg_frame(irg);
-        ir_node *const  load  = new_bd_loongarch64_ld_d(NULL, block, spill, frame, NULL, 0);
-        sched_add_before(before, load);
-        return be_new_Proj(load, pn_loongarch64_ld_d_res);
-    }
-    TODO(value);
+    if (!be_mode_needs_gp_reg(mode) && !mode_is_float(mode))
+        TODO(value);
+
+    ir_node *const  block = get_block(before);
+    ir_graph *const irg   = get_irn_irg(before);
+    ir_node *const  frame = get_irg_frame(irg);
+    ir_node *const  load  = get_reload_cons(value)(NULL, block, spill, frame, NULL, 0);
+    sched_add_before(before, load);
+    // All loads have their result at the same position.
+    return be_new_Proj(load, pn_loongarch64_ld_d_res);
+}
+
+// $r21 is never allocated, so Perm cycles of gp registers can always be broken
+// with plain moves through it.
+static arch_register_t const *loongarch64_get_scratch_register(arch_register_class_t const *const cls) {
+    if (cls == &loongarch64_reg_classes[CLASS_loongarch64_gp])
+        return &loongarch64_registers[REG_R21];
+    return NULL;
 }
 
-static const regalloc_if_t loongarch64_regalloc_if = {
-    .spill_cost  = 1,
-    .reload_cost = 1,
-    .new_spill   = loongarch64_new_spill,
-    .new_reload  = loongarch64_new_reload,
+static regalloc_if_t loongarch64_regalloc_if = {
+    .spill_cost           = 1, // set from the store/load latencies on init
+    .reload_cost          = 1,
+    .new_spill            = loongarch64_new_spill,
+    .new_reload           = loongarch64_new_reload,
+    .get_scratch_register = loongarch64_get_scratch_register,
 };
 
+// Returns the number of bytes a load from the stack frame accesses, 0 for all
+// other nodes.
+static unsigned loongarch64_get_frame_load_size(ir_node const *const node) {
+    if (is_loongarch64_ld_b(node) || is_loongarch64_ld_bu(node))
+        return 1;
+    if (is_loongarch64_ld_h(node) || is_loongarch64_ld_hu(node))
+        return 2;
+    if (is_loongarch64_ld_w(node) || is_loongarch64_ld_wu(node) || is_loongarch64_fld_s(node))
+        return 4;
+    if (is_loongarch64_ld_d(node) || is_loongarch64_fld_d(node))
+        return 8;
+    return 0;
+}
+
+// Reloads get a slot as large and aligned as their access.
 static void loongarch64_collect_frame_entity_nodes(ir_node *const node, void *const data) {
     be_fec_env_t *const env = (be_fec_env_t *)data;
 
-    if (is_loongarch64_ld_w(node) || is_loongarch64_ld_h(node) || is_loongarch64_ld_b(node) ||
-        is_loongarch64_ld_wu(node) || is_loongarch64_ld_hu(node) || is_loongarch64_ld_bu(node) ||
-        is_loongarch64_ld_d(node)) {
-        ir_node *const  base  = get_irn_n(node, 1);
-        ir_graph *const irg   = get_irn_irg(node);
-        ir_node *const  frame = get_irg_frame(irg);
-        if (base == frame) {
-            loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
-            if (!attr->ent) {
-                be_load_needs_frame_entity(env, node, 16, 4);
-            }
+    unsigned const size = loongarch64_get_frame_load_size(node);
+    if (size == 0)
+        return;
+    // All loads take their base at the same position.
+    ir_node *const  base  = get_irn_n(node, n_loongarch64_ld_d_base);
+    ir_graph *const irg   = get_irn_irg(node);
+    ir_node *const  frame = get_irg_frame(irg);
+    if (base == frame) {
+        loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+        if (!attr->ent) {
+            be_load_needs_frame_entity(env, node, size, log2_floor(size));
         }
     }
 }
@@ -114,13 +275,48 @@ static void loongarch64_assign_spill_slots(ir_graph *const irg) {
     be_free_frame_entity_coalescer(fec_env);
 }
 
-static void loongarch64_introduce_prologue(ir_graph *const irg, unsigned const size) {
-    ir_node *const start    = get_irg_start(irg);
-    ir_node *const block    = get_nodes_block(start);
-    ir_node *const start_sp = be_get_Start_proj(irg, &loongarch64_registers[REG_SP]);
-    ir_node *const inc_sp   = be_new_IncSP(block, start_sp, size, 0);
-    sched_add_after(start, inc_sp);
-    edges_reroute_except(start_sp, inc_sp, inc_sp);
+static void loongarch64_introduce_prologue(ir_node *const block, unsigned const size) {
+    ir_graph *const irg      = get_irn_irg(block);
+    ir_node *const  start_sp = be_get_Start_proj(irg, &loongarch64_registers[REG_SP]);
+    ir_node *const  inc_sp   = be_new_IncSP(block, start_sp, size, 0);
+    if (block == get_irg_start_block(irg)) {
+        sched_add_after(get_irg_start(irg), inc_sp);
+        edges_reroute_except(start_sp, inc_sp, inc_sp);
+        return;
+    }
+
+    ir_node *first = sched_first(block);
+    while (is_Phi(first))
+        first = sched_next(first);
+    sched_add_before(first, inc_sp);
+    foreach_out_edge_safe(start_sp, edge) {
+        ir_node *const user = get_edge_src_irn(edge);
+        if (user != inc_sp && !is_Anchor(user) && !is_End(user) && block_dominates(block, get_nodes_block(user)))
+            set_irn_n(user, get_edge_src_pos(edge), inc_sp);
+    }
+}
+
+bool loongarch64_is_got_entity(ir_entity const *const entity) {
+    if (ir_platform.pic_style == BE_PIC_NONE)
+        return false;
+    switch (get_entity_visibility(entity)) {
+    case ir_visibility_private:
+    case ir_visibility_local:
+    case ir_visibility_external_private:
+        // Hidden symbols are resolved within the module, a PC relative access
+        // suffices.
+        return false;
+    case ir_visibility_external:
+    case ir_visibility_external_protected:
+        return true;
+    }
+    panic("invalid visibility in %+F", entity);
+}
+
+// Returns and tail calls leave the function, they all take the stack pointer
+// at the same input.
+static bool loongarch64_is_function_exit(ir_node const *const node) {
+    return is_loongarch64_return(node) || is_loongarch64_tail_call(node) || is_loongarch64_tail_call_pointer(node);
 }
 
 static void loongarch64_introduce_epilogue(ir_node *const ret, unsigned const size) {
@@ -131,18 +327,99 @@ static void loongarch64_introduce_epilogue(ir_node *const ret, unsigned const si
     set_irn_n(ret, n_loongarch64_return_stack, inc_sp);
 }
 
+// Calls and everything addressing memory relative to `sp` need the frame.
+static bool loongarch64_needs_frame(ir_node const *const node) {
+    if (be_is_IncSP(node) || loongarch64_is_function_exit(node))
+        return false;
+    if (is_loongarch64_call(node) || is_loongarch64_call_pointer(node))
+        return true;
+    arch_register_t const *const sp = &loongarch64_registers[REG_SP];
+    foreach_irn_in(node, i, pred) {
+        if (arch_get_irn_register(pred) == sp)
+            return true;
+    }
+    return false;
+}
+
+// The frame may only be set up in `block`, if `block` is not part of a loop
+// and dominates every block reachable from it. Then all paths leaving the
+// frame go through one of the epilogues.
+static bool loongarch64_is_frame_block(ir_node *const block) {
+    ir_graph *const irg       = get_irn_irg(block);
+    ir_node *const  end_block = get_irg_end_block(irg);
+    ir_node       **worklist  = NEW_ARR_F(ir_node *, 0);
+    bool            valid     = true;
+
+    ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED);
+    inc_irg_block_visited(irg);
+    ARR_APP1(ir_node *, worklist, block);
+    while (valid && ARR_LEN(worklist) > 0) {
+        ir_node *const cur = worklist[ARR_LEN(worklist) - 1];
+        ARR_SHRINKLEN(worklist, ARR_LEN(worklist) - 1);
+        foreach_block_succ(cur, edge) {
+            ir_node *const succ = get_edge_src_irn(edge);
+            if (succ == end_block || Block_block_visited(succ))
+                continue;
+            if (succ == block || !block_dominates(block, succ)) {
+                valid = false;
+                break;
+            }
+            mark_Block_block_visited(succ);
+            ARR_APP1(ir_node *, worklist, succ);
+        }
+    }
+    ir_free_resources(irg, IR_RESOURCE_BLOCK_VISITED);
+    DEL_ARR_F(worklist);
+    return valid;
+}
+
+// Shrink-wrapping: Returns the block, which dominates all uses of the frame,
+// or NULL if the frame is not used at all. Falls back to the start block, if
+// that block is part of a loop or some paths could leave it without an
+// epilogue, e.g. an early exit taken after the frame was set up.
+static ir_node *loongarch64_find_frame_block(ir_graph *const irg) {
+    ir_node        *frame_block = NULL;
+    ir_node **const blocks      = be_get_cfgpostorder(irg);
+    for (size_t i = 0, n = ARR_LEN(blocks); i != n; ++i) {
+        ir_node *const block = blocks[i];
+        sched_foreach(block, node) {
+            if (loongarch64_needs_frame(node)) {
+                frame_block = frame_block ? ir_deepest_common_dominator(frame_block, block) : block;
+                break;
+            }
+        }
+    }
+    DEL_ARR_F(blocks);
+
+    ir_node *const start_block = get_irg_start_block(irg);
+    if (frame_block && frame_block != start_block && !loongarch64_is_frame_block(frame_block))
+        return start_block;
+    return frame_block;
+}
+
 static void loongarch64_introduce_prologue_epilogue(ir_graph *const irg) {
-    ir_type *const frame = get_irg_frame_type(irg);
-    unsigned const size  = get_type_size(frame);
+    ir_type *const frame    = get_irg_frame_type(irg);
+    ir_type *const fun_type = get_entity_type(get_irg_entity(irg));
+    unsigned       size     = get_type_size(frame);
+    // Variadic functions store the unnamed argument registers in a save area
+    // right below the stack arguments.
+    if (is_method_variadic(fun_type))
+        size += LOONGARCH64_N_PARAM_REGS * 8;
     if (size == 0)
         return;
 
+    assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+    ir_node *const frame_block = loongarch64_find_frame_block(irg);
+    if (!frame_block)
+        return;
+
     foreach_irn_in(get_irg_end_block(irg), i, ret) {
-        assert(is_loongarch64_return(ret));
-        loongarch64_introduce_epilogue(ret, size);
+        assert(loongarch64_is_function_exit(ret));
+        if (block_dominates(frame_block, get_nodes_block(ret)))
+            loongarch64_introduce_epilogue(ret, size);
     }
 
-    loongarch64_introduce_prologue(irg, size);
+    loongarch64_introduce_prologue(frame_block, size);
 }
 
 static void loongarch64_sp_sim(ir_node *const node, stack_pointer_state_t *const state) {
@@ -159,7 +436,11 @@ static void loongarch64_sp_sim(ir_node *const node, stack_pointer_state_t *const
         case iro_loongarch64_st_d:
         case iro_loongarch64_st_w:
         case iro_loongarch64_st_h:
-        case iro_loongarch64_st_b: {
+        case iro_loongarch64_st_b:
+        case iro_loongarch64_fld_s:
+        case iro_loongarch64_fld_d:
+        case iro_loongarch64_fst_s:
+        case iro_loongarch64_fst_d: {
             loongarch64_immediate_attr_t *const imm = get_loongarch64_immediate_attr(node);
             ir_entity *const                    ent = imm->ent;
             if (ent && is_frame_type(get_entity_owner(ent))) {
@@ -174,59 +455,303 @@ static void loongarch64_sp_sim(ir_node *const node, stack_pointer_state_t *const
     }
 }
 
+// Runs the backend up to the point where the graph is ready for emission.
+static bool lower_for_emit(ir_graph *const irg, unsigned *const sp_is_non_ssa) {
+    if (!be_step_first(irg))
+        return false;
+
+    // Skip checking SSA property for `sp` register.
+    be_birg_from_irg(irg)->non_ssa_regs = sp_is_non_ssa;
+    loongarch64_select_instructions(irg);
+
+    be_step_schedule(irg);
+
+    // There is no way to spill `fcc` registers, so move or rematerialize
+    // the compares right before their users.
+    be_sched_fix_flags(irg, &loongarch64_reg_classes[CLASS_loongarch64_fcc], NULL, NULL, NULL);
+
+    // Register allocation.
+    // 'Load' of spilled valued is set to `ent = NULL, offset = 0`.
+    be_step_regalloc(irg, &loongarch64_regalloc_if);
+    // Then find all 'Load' nodes with `ent = NULL`.
+    // They all require assigning a frame entity.
+    loongarch64_assign_spill_slots(irg);
+
+    ir_type *const frame = get_irg_frame_type(irg);
+    be_sort_frame_entities(frame, true);
+    ir_type *const fun_type = get_entity_type(get_irg_entity(irg));
+    int const      begin    = is_method_variadic(fun_type) ? -LOONGARCH64_N_PARAM_REGS * 8 : 0;
+    be_layout_frame_type(frame, begin, 0);
+
+    loongarch64_introduce_prologue_epilogue(irg);
+
+    // Fix `sp` register to be in SSA form.
+    be_fix_stack_nodes(irg, &loongarch64_registers[REG_SP]);
+    be_birg_from_irg(irg)->non_ssa_regs = NULL;
+
+    // Transform entity information to relative position to `sp`.
+    be_sim_stack_pointer(irg, 0, 4, &loongarch64_sp_sim);
+
+    be_handle_2addr(irg, NULL);
+
+    loongarch64_peephole_optimization(irg);
+    return true;
+}
+
 static void loongarch64_generate_code(FILE *output, const char *cup_name) {
     be_begin(output, cup_name);
     unsigned *const sp_is_non_ssa = rbitset_alloca(N_LOONGARCH64_REGISTERS);
     rbitset_set(sp_is_non_ssa, REG_SP);
 
     foreach_irp_irg(i, irg) {
-        if (!be_step_first(irg))
+        if (!lower_for_emit(irg, sp_is_non_ssa))
             continue;
 
-        // Skip checking SSA property for `sp` register.
-        be_birg_from_irg(irg)->non_ssa_regs = sp_is_non_ssa;
-        loongarch64_select_instructions(irg);
+        loongarch64_emit_function(irg);
+        be_step_last(irg);
+    }
+
+    be_finish();
+}
+
+static void loongarch64_generate_object_function(ir_graph *const irg) {
+    unsigned *const sp_is_non_ssa = rbitset_alloca(N_LOONGARCH64_REGISTERS);
+    rbitset_set(sp_is_non_ssa, REG_SP);
+
+    if (!lower_for_emit(irg, sp_is_non_ssa))
+        return;
+
+    be_timer_push(T_EMIT);
+    loongarch64_emit_object_function(irg);
+    be_timer_pop(T_EMIT);
 
-        be_step_schedule(irg);
+    be_step_last(irg);
+}
 
-        // Register allocation.
-        // 'Load' of spilled valued is set to `ent = NULL, offset = 0`.
-        be_step_regalloc(irg, &loongarch64_regalloc_if);
-        // Then find all 'Load' nodes with `ent = NULL`.
-        // They all require assigning a frame entity.
-        loongarch64_assign_spill_slots(irg);
+// Writes the object file directly instead of assembler text.
+static void loongarch64_generate_object(FILE *output, const char *cup_name) {
+    be_begin_object(cup_name);
+    be_elf_begin(&loongarch64_elf_target, cup_name);
+    foreach_irp_irg(i, irg) { loongarch64_generate_object_function(irg); }
+    be_elf_finish(output);
+    be_finish_object();
+}
 
-        ir_type *const frame = get_irg_frame_type(irg);
-        be_sort_frame_entities(frame, true);
-        be_layout_frame_type(frame, 0, 0);
+static ir_jit_function_t *loongarch64_jit_compile(ir_jit_segment_t *const segment, ir_graph *const irg) {
+    unsigned *const sp_is_non_ssa = rbitset_alloca(N_LOONGARCH64_REGISTERS);
+    rbitset_set(sp_is_non_ssa, REG_SP);
 
-        loongarch64_introduce_prologue_epilogue(irg);
+    if (!lower_for_emit(irg, sp_is_non_ssa))
+        return NULL;
 
-        // Fix `sp` register to be in SSA form.
-        be_fix_stack_nodes(irg, &loongarch64_registers[REG_SP]);
-        be_birg_from_irg(irg)->non_ssa_regs = NULL;
+    be_timer_push(T_EMIT);
+    ir_jit_function_t *const res = loongarch64_emit_jit(segment, irg);
+    be_timer_pop(T_EMIT);
 
-        // Transform entity information to relative position to `sp`.
-        be_sim_stack_pointer(irg, 0, 4, &loongarch64_sp_sim);
+    be_step_last(irg);
+    return res;
+}
 
-        be_handle_2addr(irg, NULL);
+/**
+ * Rewrite unsigned long -> float conversion. LoongArch64 only has a signed
+ * conversion, so we rewrite to the following:
+ *
+ * if ((long)x >= 0) {
+ *   converted = (float)(long)x;
+ * } else {
+ *   converted = (float)(long)((x >> 1) | (x & 1));
+ *   converted += converted;
+ * }
+ */
+static void rewrite_unsigned_float_Conv(ir_node *node) {
+    ir_graph *const irg         = get_irn_irg(node);
+    dbg_info *const dbgi        = get_irn_dbg_info(node);
+    ir_node *const  lower_block = get_nodes_block(node);
+    ir_mode *const  dest_mode   = get_irn_mode(node);
+
+    part_block(node);
+
+    ir_node *const block      = get_nodes_block(node);
+    ir_node *const unsigned_x = get_Conv_op(node);
+    ir_mode *const mode_u     = get_irn_mode(unsigned_x);
+    ir_node *const signed_x   = new_rd_Conv(dbgi, block, unsigned_x, mode_Ls);
+    ir_node *const zero       = new_r_Const_null(irg, mode_Ls);
+    collect_new_start_block_node(zero);
+    ir_node *const cmp         = new_rd_Cmp(dbgi, block, signed_x, zero, ir_relation_less);
+    ir_node *const cond        = new_rd_Cond(dbgi, block, cmp);
+    ir_node *const proj_true   = new_r_Proj(cond, mode_X, pn_Cond_true);
+    ir_node *const proj_false  = new_r_Proj(cond, mode_X, pn_Cond_false);
+    ir_node       *in_true[1]  = {proj_true};
+    ir_node       *in_false[1] = {proj_false};
+
+    // true block: Halve the value but keep the lowest bit for correct rounding
+    ir_node *const true_block = new_r_Block(irg, ARRAY_SIZE(in_true), in_true);
+    ir_node *const true_jmp   = new_r_Jmp(true_block);
+    ir_node *const one        = new_r_Const_one(irg, mode_u);
+    collect_new_start_block_node(one);
+    ir_node *const shr      = new_rd_Shr(dbgi, true_block, unsigned_x, one);
+    ir_node *const lowest   = new_rd_And(dbgi, true_block, unsigned_x, one);
+    ir_node *const half     = new_rd_Or(dbgi, true_block, shr, lowest);
+    ir_node *const half_s   = new_rd_Conv(dbgi, true_block, half, mode_Ls);
+    ir_node *const half_f   = new_rd_Conv(dbgi, true_block, half_s, dest_mode);
+    ir_node *const true_res = new_rd_Add(dbgi, true_block, half_f, half_f);
+
+    // false block: Simply convert
+    ir_node *const false_block = new_r_Block(irg, ARRAY_SIZE(in_false), in_false);
+    ir_node *const false_jmp   = new_r_Jmp(false_block);
+    ir_node *const false_res   = new_rd_Conv(dbgi, false_block, signed_x, dest_mode);
+
+    // lower block
+    ir_node *lower_in[2] = {true_jmp, false_jmp};
+    ir_node *phi_in[2]   = {true_res, false_res};
+
+    set_irn_in(lower_block, ARRAY_SIZE(lower_in), lower_in);
+    ir_node *const phi = new_r_Phi(lower_block, ARRAY_SIZE(phi_in), phi_in, dest_mode);
+    collect_new_phi_node(phi);
+    exchange(node, phi);
+}
 
-        loongarch64_emit_function(irg);
-        be_step_last(irg);
+/**
+ * Rewrite float -> unsigned long conversion. LoongArch64 only has a signed
+ * conversion, so we rewrite to the following:
+ *
+ * if (x >= 9223372036854775808.) {
+ *   converted = (long)(x - 9223372036854775808.) ^ 0x8000000000000000;
+ * } else {
+ *   converted = (long)x;
+ * }
+ * return (unsigned long)converted;
+ */
+static void rewrite_float_unsigned_Conv(ir_node *node) {
+    ir_graph *const irg         = get_irn_irg(node);
+    dbg_info *const dbgi        = get_irn_dbg_info(node);
+    ir_node *const  lower_block = get_nodes_block(node);
+    ir_mode *const  dest_mode   = get_irn_mode(node);
+
+    part_block(node);
+
+    ir_node *const   block    = get_nodes_block(node);
+    ir_node *const   fp_x     = get_Conv_op(node);
+    ir_mode *const   src_mode = get_irn_mode(fp_x);
+    ir_tarval *const limit    = new_tarval_from_double(9223372036854775808., src_mode);
+    ir_node *const   limitc   = new_r_Const(irg, limit);
+    collect_new_start_block_node(limitc);
+    ir_node *const cmp         = new_rd_Cmp(dbgi, block, fp_x, limitc, ir_relation_greater_equal);
+    ir_node *const cond        = new_rd_Cond(dbgi, block, cmp);
+    ir_node *const proj_true   = new_r_Proj(cond, mode_X, pn_Cond_true);
+    ir_node *const proj_false  = new_r_Proj(cond, mode_X, pn_Cond_false);
+    ir_node       *in_true[1]  = {proj_true};
+    ir_node       *in_false[1] = {proj_false};
+
+    // true block: Do some arithmetic to use the signed conversion
+    ir_node *const true_block = new_r_Block(irg, ARRAY_SIZE(in_true), in_true);
+    ir_node *const true_jmp   = new_r_Jmp(true_block);
+    ir_node *const sub        = new_rd_Sub(dbgi, true_block, fp_x, limitc);
+    ir_node *const sub_conv   = new_rd_Conv(dbgi, true_block, sub, mode_Ls);
+    ir_node *const sign_bit   = new_r_Const(irg, get_mode_min(mode_Ls));
+    collect_new_start_block_node(sign_bit);
+    ir_node *const xor      = new_rd_Eor(dbgi, true_block, sub_conv, sign_bit);
+    ir_node *const true_res = new_rd_Conv(dbgi, true_block, xor, dest_mode);
+
+    // false block: Simply convert
+    ir_node *const false_block  = new_r_Block(irg, ARRAY_SIZE(in_false), in_false);
+    ir_node *const false_jmp    = new_r_Jmp(false_block);
+    ir_node *const false_signed = new_rd_Conv(dbgi, false_block, fp_x, mode_Ls);
+    ir_node *const false_res    = new_rd_Conv(dbgi, false_block, false_signed, dest_mode);
+
+    // lower block
+    ir_node *lower_in[2] = {true_jmp, false_jmp};
+    ir_node *phi_in[2]   = {true_res, false_res};
+
+    set_irn_in(lower_block, ARRAY_SIZE(lower_in), lower_in);
+    ir_node *const phi = new_r_Phi(lower_block, ARRAY_SIZE(phi_in), phi_in, dest_mode);
+    collect_new_phi_node(phi);
+    exchange(node, phi);
+}
+
+static bool is_u64(ir_mode *const mode) {
+    return mode_is_int(mode) && !mode_is_signed(mode) && get_mode_size_bits(mode) == 64;
+}
+
+static void loongarch64_intrinsics_walker(ir_node *node, void *data) {
+    bool *changed = (bool *)data;
+    if (is_Conv(node)) {
+        ir_mode *const to_mode   = get_irn_mode(node);
+        ir_mode *const from_mode = get_irn_mode(get_Conv_op(node));
+        if (is_u64(from_mode) && mode_is_float(to_mode)) {
+            rewrite_unsigned_float_Conv(node);
+            *changed = true;
+        } else if (mode_is_float(from_mode) && is_u64(to_mode)) {
+            rewrite_float_unsigned_Conv(node);
+            *changed = true;
+        }
     }
+}
 
-    be_finish();
+static void loongarch64_handle_intrinsics(ir_graph *irg) {
+    ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_PHI_LIST);
+    collect_phiprojs_and_start_block_nodes(irg);
+    bool changed = false;
+    irg_walk_graph(irg, loongarch64_intrinsics_walker, NULL, &changed);
+    ir_free_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_PHI_LIST);
+
+    if (changed) {
+        confirm_irg_properties(irg, IR_GRAPH_PROPERTY_NO_BADS | IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES |
+                                        IR_GRAPH_PROPERTY_MANY_RETURNS | IR_GRAPH_PROPERTY_ONE_RETURN);
+    }
+}
+
+static void loongarch64_init_asm_constraints(void) {
+    be_set_constraint_support(ASM_CONSTRAINT_FLAG_SUPPORTS_MEMOP, "m");
+    be_set_constraint_support(ASM_CONSTRAINT_FLAG_SUPPORTS_REGISTER, "fr");
+    be_set_constraint_support(ASM_CONSTRAINT_FLAG_SUPPORTS_ANY, "g");
+    be_set_constraint_support(ASM_CONSTRAINT_FLAG_SUPPORTS_IMMEDIATE, "IJKin");
 }
 
 static void loongarch64_init(void) {
+    loongarch64_cpu  = (loongarch64_cpu_t)cpu;
+    loongarch64_simd = (loongarch64_simd_t)simd;
+
+    loongarch64_init_asm_constraints();
     loongarch64_register_init();
+    obstack_init(&loongarch64_opcodes_obst);
     loongarch64_create_opcodes();
 
+    loongarch64_regalloc_if.spill_cost  = get_loongarch64_op_latency(op_loongarch64_st_d);
+    loongarch64_regalloc_if.reload_cost = get_loongarch64_op_latency(op_loongarch64_ld_d);
+
     ir_target.experimental       = "The loongarch64 backend is highly experimental";
     ir_target.float_int_overflow = ir_overflow_min_max;
 }
 
-static void loongarch64_finish(void) { loongarch64_free_opcodes(); }
+static void loongarch64_finish(void) {
+    loongarch64_free_opcodes();
+    obstack_free(&loongarch64_opcodes_obst, NULL);
+}
+
+/**
+ * Costs for the Mul replacement, based on the latencies of the instructions
+ * the replacement sequence is built from.
+ */
+static int loongarch64_evaluate_insn(insn_kind kind, const ir_mode *mode, ir_tarval *tv) {
+    (void)tv;
+    bool const is_64 = get_mode_size_bits(mode) > 32;
+    switch (kind) {
+    case MUL:
+        return get_loongarch64_op_latency(is_64 ? op_loongarch64_mul_d : op_loongarch64_mul_w);
+    case LEA:
+        // Becomes a shift followed by an add
+        return get_loongarch64_op_latency(op_loongarch64_slli_d) + get_loongarch64_op_latency(op_loongarch64_add_d);
+    case SHIFT:
+        return get_loongarch64_op_latency(op_loongarch64_slli_d);
+    case ADD:
+    case SUB:
+    case ZERO:
+        return get_loongarch64_op_latency(op_loongarch64_add_d);
+    default:
+        return 1;
+    }
+}
 
 static ir_settings_arch_dep_t const loongarch64_arch_dep = {
     .replace_muls         = true,
@@ -237,35 +762,117 @@ static ir_settings_arch_dep_t const loongarch64_arch_dep = {
     .also_use_subs        = true,
     .maximum_shifts       = 4,
     .highest_shift_amount = 63,
-    .evaluate             = NULL,
+    .evaluate             = loongarch64_evaluate_insn,
     .max_bits_for_mulh    = 64,
 };
 
+// Arguments are passed in 8 byte slots, aggregates up to 16 bytes by value and
+// larger ones by reference.
+static void loongarch64_lower_va_arg(ir_node *const node) {
+    ir_node *const  block       = get_nodes_block(node);
+    dbg_info *const dbgi        = get_irn_dbg_info(node);
+    ir_graph *const irg         = get_irn_irg(node);
+    ir_type *const  type        = get_method_res_type(get_Builtin_type(node), 0);
+    ir_node *const  ap          = get_irn_n(node, 1);
+    ir_node        *mem         = get_Builtin_mem(node);
+    ir_mode *const  offset_mode = get_reference_offset_mode(mode_P);
+
+    ir_node *res;
+    unsigned size;
+    if (is_compound_type(type) && get_type_size(type) <= 16) {
+        res  = ap;
+        size = get_type_size(type);
+    } else {
+        ir_mode *const mode      = is_compound_type(type) ? mode_P : get_type_mode(type);
+        ir_type *const load_type = is_compound_type(type) ? get_type_for_mode(mode_P) : type;
+        ir_node *const load      = new_rd_Load(dbgi, block, mem, ap, mode, load_type, cons_none);
+        res                      = new_r_Proj(load, mode, pn_Load_res);
+        mem                      = new_r_Proj(load, mode_M, pn_Load_M);
+        size                     = get_mode_size_bytes(mode);
+    }
+
+    ir_node *const offset = new_r_Const_long(irg, offset_mode, round_up2(size, 8));
+    ir_node *const new_ap = new_rd_Add(dbgi, block, ap, offset);
+    ir_node *const in[]   = { mem, res, new_ap };
+    turn_into_tuple(node, ARRAY_SIZE(in), in);
+}
+
+static loongarch64_abi_state param_abi_state;
+static loongarch64_abi_state result_abi_state;
+
 static void loongarch64_lower_for_target(void) {
     ir_arch_lower(&loongarch64_arch_dep);
     be_after_irp_transform("lower-arch-dep");
 
-    lower_calls_with_compounds(LF_RETURN_HIDDEN, lower_aggregates_as_pointers, NULL, lower_aggregates_as_pointers, NULL,
-                               reset_stateless_abi);
+    lower_calls_with_compounds(LF_NONE, loongarch64_lower_parameter, &param_abi_state, loongarch64_lower_result,
+                               &result_abi_state, loongarch64_reset_abi_state);
     be_after_irp_transform("lower-calls");
 
+    // Keep copies of up to 16 vectors for vcopy, use memcpy for larger ones
+    unsigned const max_vector_copy = 16 * loongarch64_vector_size();
+    unsigned const min_large_copy  = max_vector_copy > 64 ? max_vector_copy + 1 : 65;
     foreach_irp_irg(i, irg) {
-        lower_CopyB(irg, 64, 65, false);
+        lower_CopyB(irg, 64, min_large_copy, true);
         be_after_transform(irg, "lower-copyb");
     }
 
     ir_mode *const mode_gp = loongarch64_reg_classes[CLASS_loongarch64_gp].mode;
-	foreach_irp_irg(i, irg) {
-        // Lower all switch to if-else chain
-		lower_switch(irg, 4, 0, mode_gp);
-		be_after_transform(irg, "lower-switch");
-	}
+    foreach_irp_irg(i, irg) {
+        // Lower small and sparse switches to if-else chain, keep the dense ones for jump tables
+        lower_switch(irg, 4, 256, mode_gp);
+        be_after_transform(irg, "lower-switch");
+    }
 
-    lower_builtins(0, NULL, NULL);
+    // The population count needs LSX, otherwise it is left to libgcc.
+    ir_builtin_kind supported[11];
+    size_t          s = 0;
+    supported[s++]    = ir_bk_bswap;
+    supported[s++]    = ir_bk_clz;
+    supported[s++]    = ir_bk_compare_swap;
+    supported[s++]    = ir_bk_ctz;
+    supported[s++]    = ir_bk_debugbreak;
+    supported[s++]    = ir_bk_ffs;
+    supported[s++]    = ir_bk_prefetch;
+    supported[s++]    = ir_bk_trap;
+    supported[s++]    = ir_bk_va_start;
+    if (loongarch64_simd != loongarch64_simd_none) {
+        supported[s++] = ir_bk_parity;
+        supported[s++] = ir_bk_popcount;
+    }
+    assert(s <= ARRAY_SIZE(supported));
+    lower_builtins(s, supported, loongarch64_lower_va_arg);
     be_after_irp_transform("lower-builtins");
 }
 
-static unsigned loongarch64_get_op_estimated_cost(const ir_node *node) { return 1; }
+static unsigned loongarch64_get_op_estimated_cost(const ir_node *node) {
+    if (!is_loongarch64_irn(node))
+        return 1;
+    if (is_loongarch64_li_w(node) || is_loongarch64_li_d(node))
+        return loongarch64_get_li_length(node) * get_loongarch64_latency(node);
+    return get_loongarch64_latency(node);
+}
+
+/** The numeric register names, which the assembler accepts as well, for the
+ * clobbers of asm nodes. */
+static be_register_name_t const loongarch64_additional_reg_names[] = {
+    { "r0",  REG_ZERO }, { "r1",  REG_RA  }, { "r2",  REG_TP  }, { "r3",  REG_SP  },
+    { "r4",  REG_A0   }, { "r5",  REG_A1  }, { "r6",  REG_A2  }, { "r7",  REG_A3  },
+    { "r8",  REG_A4   }, { "r9",  REG_A5  }, { "r10", REG_A6  }, { "r11", REG_A7  },
+    { "r12", REG_T0   }, { "r13", REG_T1  }, { "r14", REG_T2  }, { "r15", REG_T3  },
+    { "r16", REG_T4   }, { "r17", REG_T5  }, { "r18", REG_T6  }, { "r19", REG_T7  },
+    { "r20", REG_T8   }, { "r22", REG_FP  }, { "s9",  REG_FP  }, { "r23", REG_S0  },
+    { "r24", REG_S1   }, { "r25", REG_S2  }, { "r26", REG_S3  }, { "r27", REG_S4  },
+    { "r28", REG_S5   }, { "r29", REG_S6  }, { "r30", REG_S7  }, { "r31", REG_S8  },
+    { "f0",  REG_FA0  }, { "f1",  REG_FA1 }, { "f2",  REG_FA2 }, { "f3",  REG_FA3 },
+    { "f4",  REG_FA4  }, { "f5",  REG_FA5 }, { "f6",  REG_FA6 }, { "f7",  REG_FA7 },
+    { "f8",  REG_FT0  }, { "f9",  REG_FT1 }, { "f10", REG_FT2 }, { "f11", REG_FT3 },
+    { "f12", REG_FT4  }, { "f13", REG_FT5 }, { "f14", REG_FT6 }, { "f15", REG_FT7 },
+    { "f16", REG_FT8  }, { "f17", REG_FT9 }, { "f18", REG_FT10 }, { "f19", REG_FT11 },
+    { "f20", REG_FT12 }, { "f21", REG_FT13 }, { "f22", REG_FT14 }, { "f23", REG_FT15 },
+    { "f24", REG_FS0  }, { "f25", REG_FS1 }, { "f26", REG_FS2 }, { "f27", REG_FS3 },
+    { "f28", REG_FS4  }, { "f29", REG_FS5 }, { "f30", REG_FS6 }, { "f31", REG_FS7 },
+    { NULL, ~0u }
+};
 
 arch_isa_if_t const loongarch64_isa_if = {
     .name                  = "loongarch64",
@@ -273,7 +880,7 @@ arch_isa_if_t const loongarch64_isa_if = {
     .modulo_shift          = 32,
     .big_endian            = false,
     .po2_biggest_alignment = 4,
-    .pic_supported         = false,
+    .pic_supported         = true,
     .register_prefix       = '$',
     .n_registers           = N_LOONGARCH64_REGISTERS,
     .registers             = loongarch64_registers,
@@ -282,9 +889,20 @@ arch_isa_if_t const loongarch64_isa_if = {
     .init                  = loongarch64_init,
     .finish                = loongarch64_finish,
     .generate_code         = loongarch64_generate_code,
+    .generate_object       = loongarch64_generate_object,
+    .jit_compile           = loongarch64_jit_compile,
+    .emit_function         = loongarch64_emit_jit_function,
     .lower_for_target      = loongarch64_lower_for_target,
+    .additional_reg_names  = loongarch64_additional_reg_names,
     .get_op_estimated_cost = loongarch64_get_op_estimated_cost,
+    .handle_intrinsics     = loongarch64_handle_intrinsics,
 };
 
 BE_REGISTER_MODULE_CONSTRUCTOR(be_init_arch_loongarch64)
-void be_init_arch_loongarch64(void) { loongarch64_init_transform(); }
+void be_init_arch_loongarch64(void) {
+    lc_opt_entry_t *be_grp          = lc_opt_get_grp(firm_opt_get_root(), "be");
+    lc_opt_entry_t *loongarch64_grp = lc_opt_get_grp(be_grp, "loongarch64");
+    lc_opt_add_table(loongarch64_grp, loongarch64_options);
+
+    loongarch64_init_transform();
+}
@@ -10,9 +10,49 @@
 #ifndef FIRM_BE_loongarch64_loongarch64_BEARCH_T_H
 #define FIRM_BE_loongarch64_loongarch64_BEARCH_T_H
 
+#include "loongarch64_nodes_attr.h"
+
+/** Number of general purpose argument registers $a0-$a7. */
+#define LOONGARCH64_N_PARAM_REGS 8
+
+/** The cpu selected with the "cpu" option, used for latencies. */
+extern loongarch64_cpu_t loongarch64_cpu;
+
+typedef enum loongarch64_simd_t {
+	loongarch64_simd_none,
+	loongarch64_simd_lsx,  /**< 128 bit vectors */
+	loongarch64_simd_lasx, /**< 256 bit vectors */
+} loongarch64_simd_t;
+
+/** The vector extension selected with the "simd" option. */
+extern loongarch64_simd_t loongarch64_simd;
+
+/** Returns the number of bytes in a vector register, 0 without vectors. */
+static inline unsigned loongarch64_vector_size(void)
+{
+	switch (loongarch64_simd) {
+	case loongarch64_simd_lsx:  return 16;
+	case loongarch64_simd_lasx: return 32;
+	default:                    return 0;
+	}
+}
+
+/**
+ * Returns whether @p entity may be preempted by another module in position
+ * independent code, so that it has to be accessed through the GOT and called
+ * through the PLT.
+ */
+bool loongarch64_is_got_entity(ir_entity const *entity);
+
 static inline bool is_simm12(long const val)
 {
-	return -2048 <= (int32_t)val && (int32_t)val < 2048;
+	return -2048 <= val && val < 2048;
+}
+
+/** Offsets of ldptr/stptr are a signed 14 bit immediate scaled by 4. */
+static inline bool is_ptr_offset(long const val)
+{
+	return val % 4 == 0 && -32768 <= val && val < 32768;
 }
 
 #endif
@@ -10,9 +10,11 @@
 #include "loongarch64_emitter.h"
 
 #include "be_t.h"
+#include "beasm.h"
 #include "bearch.h"
 #include "beblocksched.h"
 #include "bediagnostic.h"
+#include "bedwarf.h"
 #include "beemithlp.h"
 #include "beemitter.h"
 #include "begnuas.h"
@@ -20,19 +22,57 @@
 #include "besched.h"
 #include "gen_loongarch64_emitter.h"
 #include "gen_loongarch64_regalloc_if.h"
+#include "iredges_t.h"
 #include "irgwalk.h"
+#include "irnode_t.h"
+#include "loongarch64_bearch_t.h"
 #include "loongarch64_new_nodes.h"
+#include "obst.h"
 #include "panic.h"
+#include "pdeq.h"
+#include "pmap.h"
 #include "util.h"
+#include <inttypes.h>
+#include <limits.h>
 
-static void loongarch64_emit_immediate(const ir_node *node) {
-    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
-    ir_entity *const                          ent  = attr->ent;
-    int64_t                                   val  = attr->val;
+static void emit_immediate_val(ir_entity const *const ent, int64_t const val) {
     if (ent) {
         be_gas_emit_entity(ent);
+        if (val != 0)
+            be_emit_irprintf("%+" PRId64, val);
+    } else {
+        be_emit_irprintf("%" PRId64, val);
+    }
+}
+
+static void loongarch64_emit_immediate(const ir_node *node) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    emit_immediate_val(attr->ent, attr->val);
+}
+
+// Emits the offset of a load or store. Entities left after the frame layout
+// are globals, whose 4 KiB page the base register holds.
+static void loongarch64_emit_address_offset(const ir_node *node) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    if (attr->ent) {
+        be_emit_cstring("%pc_lo12(");
+        loongarch64_emit_immediate(node);
+        be_emit_char(')');
     } else {
-        be_emit_irprintf("%d", val);
+        loongarch64_emit_immediate(node);
+    }
+}
+
+// Emits the target of a direct call, preemptible functions are called through
+// the PLT.
+static void loongarch64_emit_call_target(const ir_node *node) {
+    ir_entity const *const ent = get_loongarch64_immediate_attr_const(node)->ent;
+    if (loongarch64_is_got_entity(ent)) {
+        be_emit_cstring("%plt(");
+        loongarch64_emit_immediate(node);
+        be_emit_char(')');
+    } else {
+        loongarch64_emit_immediate(node);
     }
 }
 
@@ -70,11 +110,33 @@ void loongarch64_emitf(const ir_node *node, const char *format, ...) {
             break;
         }
 
+        case 'V': {
+            // LSX register overlaying a float-point register
+            char const kind = *format++;
+            if ((kind != 'S' && kind != 'D') || !is_digit(*format))
+                goto unknown;
+            unsigned const               pos = *format++ - '0';
+            arch_register_t const *const reg
+                = kind == 'S' ? arch_get_irn_register_in(node, pos) : arch_get_irn_register_out(node, pos);
+            be_emit_irprintf("$vr%u", reg->encoding);
+            break;
+        }
+
         case 'I': {
             loongarch64_emit_immediate(node);
             break;
         }
 
+        case 'A': {
+            loongarch64_emit_address_offset(node);
+            break;
+        }
+
+        case 'P': {
+            loongarch64_emit_call_target(node);
+            break;
+        }
+
         case 'X': {
             int num = va_arg(ap, int);
             be_emit_irprintf("%X", num);
@@ -87,6 +149,12 @@ void loongarch64_emitf(const ir_node *node, const char *format, ...) {
             break;
         }
 
+        case 'C': {
+            loongarch64_fcond_t const fcond = get_loongarch64_fcmp_attr_const(node)->fcond;
+            be_emit_string(loongarch64_fcond_name(fcond));
+            break;
+        }
+
         default:
         unknown:
             panic("unknown format conversion");
@@ -94,6 +162,145 @@ void loongarch64_emitf(const ir_node *node, const char *format, ...) {
     }
 }
 
+/**
+ * Plans the materialization of @p value with the shortest sequence of
+ *
+ *   addi.w/ori/lu12i.w(+ori)  bits 31..0, sign extended
+ *   lu32i.d                   bits 51..32, sign extended
+ *   lu52i.d                   bits 63..52
+ *
+ * skipping the upper steps when the sign extension already yields the right
+ * bits. Returns the number of steps stored in @p steps.
+ */
+unsigned loongarch64_plan_constant(int64_t const value, loongarch64_li_step_t *const steps) {
+    // Only bits 63..52 are set
+    if ((value & 0xFFFFFFFFFFFFF) == 0) {
+        steps[0] = (loongarch64_li_step_t){ "lu52i.d", 0x03000000, loongarch64_li_src_zero, (int32_t)(value >> 52) };
+        return 1;
+    }
+
+    unsigned      n    = 0;
+    int64_t const low  = (int32_t)value;
+    int32_t const lo12 = low & 0xFFF;
+    if (is_simm12(low)) {
+        steps[n++] = (loongarch64_li_step_t){ "addi.w", 0x02800000, loongarch64_li_src_zero, (int32_t)low };
+    } else if (0 <= low && low < 4096) {
+        steps[n++] = (loongarch64_li_step_t){ "ori", 0x03800000, loongarch64_li_src_zero, (int32_t)low };
+    } else {
+        steps[n++] = (loongarch64_li_step_t){ "lu12i.w", 0x14000000, loongarch64_li_src_none, (int32_t)(low >> 12) };
+        if (lo12 != 0)
+            steps[n++] = (loongarch64_li_step_t){ "ori", 0x03800000, loongarch64_li_src_self, lo12 };
+    }
+
+    // Sign extend from bit 51
+    int64_t const low52 = (int64_t)((uint64_t)value << 12) >> 12;
+    if (low52 != low)
+        steps[n++] = (loongarch64_li_step_t){ "lu32i.d", 0x16000000, loongarch64_li_src_none, (int32_t)(low52 >> 32) };
+    if (value != low52)
+        steps[n++] = (loongarch64_li_step_t){ "lu52i.d", 0x03000000, loongarch64_li_src_self, (int32_t)(value >> 52) };
+    return n;
+}
+
+static int64_t get_li_value(ir_node const *const node) {
+    int64_t const val = get_loongarch64_immediate_attr_const(node)->val;
+    return is_loongarch64_li_w(node) ? (int32_t)val : val;
+}
+
+unsigned loongarch64_get_li_length(ir_node const *const node) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    if (attr->ent)
+        return 2;
+    loongarch64_li_step_t steps[LOONGARCH64_MAX_LI_STEPS];
+    return loongarch64_plan_constant(get_li_value(node), steps);
+}
+
+static void emit_li(ir_node const *const node, char const *const macro) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    if (attr->ent) {
+        loongarch64_emitf(node, "%s %D0, %I", macro);
+        return;
+    }
+
+    loongarch64_li_step_t steps[LOONGARCH64_MAX_LI_STEPS];
+    unsigned const        n = loongarch64_plan_constant(get_li_value(node), steps);
+    for (unsigned i = 0; i < n; ++i) {
+        loongarch64_li_step_t const *const step = &steps[i];
+        switch (step->src) {
+        case loongarch64_li_src_none:
+            loongarch64_emitf(node, "%s %D0, %d", step->name, step->imm);
+            break;
+        case loongarch64_li_src_zero:
+            loongarch64_emitf(node, "%s %D0, $zero, %d", step->name, step->imm);
+            break;
+        case loongarch64_li_src_self:
+            loongarch64_emitf(node, "%s %D0, %D0, %d", step->name, step->imm);
+            break;
+        }
+    }
+}
+
+static void emit_loongarch64_li_w(const ir_node *node) { emit_li(node, "li.w"); }
+
+static void emit_loongarch64_li_d(const ir_node *node) { emit_li(node, "li.d"); }
+
+// Returns @p ptr_name if the offset of @p node only fits ldptr/stptr.
+static char const *get_access_name(ir_node const *const node, char const *const name, char const *const ptr_name) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    if (!attr->ent && !is_simm12(attr->val) && is_ptr_offset(attr->val))
+        return ptr_name;
+    return name;
+}
+
+static void emit_loongarch64_ld_w(const ir_node *node) {
+    loongarch64_emitf(node, "%s %D1, %S1, %A", get_access_name(node, "ld.w", "ldptr.w"));
+}
+
+static void emit_loongarch64_ld_d(const ir_node *node) {
+    loongarch64_emitf(node, "%s %D1, %S1, %A", get_access_name(node, "ld.d", "ldptr.d"));
+}
+
+static void emit_loongarch64_st_w(const ir_node *node) {
+    loongarch64_emitf(node, "%s %S2, %S1, %A", get_access_name(node, "st.w", "stptr.w"));
+}
+
+static void emit_loongarch64_st_d(const ir_node *node) {
+    loongarch64_emitf(node, "%s %S2, %S1, %A", get_access_name(node, "st.d", "stptr.d"));
+}
+
+static void emit_loongarch64_vcopy(const ir_node *node) {
+    bool const      lasx    = loongarch64_simd == loongarch64_simd_lasx;
+    char const     *ld      = lasx ? "xvld" : "vld";
+    char const     *st      = lasx ? "xvst" : "vst";
+    char const     *vreg    = lasx ? "$xr" : "$vr";
+    unsigned const  vsize   = loongarch64_vector_size();
+    unsigned const  scratch = arch_get_irn_register_out(node, pn_loongarch64_vcopy_scratch)->encoding;
+    int64_t const   size    = get_loongarch64_immediate_attr_const(node)->val;
+    assert(vsize != 0 && size >= vsize);
+    for (int64_t offset = 0; offset < size; offset += vsize) {
+        // The last vector overlaps the previous one
+        int64_t const at = offset + vsize <= size ? offset : size - vsize;
+        loongarch64_emitf(node, "%s %s%u, %S2, %d", ld, vreg, scratch, (int)at);
+        loongarch64_emitf(node, "%s %s%u, %S1, %d", st, vreg, scratch, (int)at);
+    }
+}
+
+static void emit_cas(ir_node const *const node, char const *const size) {
+    be_emit_cstring("1:\n");
+    be_emit_write_line();
+    loongarch64_emitf(node, "ll.%s %D1, %S1, 0", size);
+    loongarch64_emitf(node, "bne %D1, %S2, 2f");
+    loongarch64_emitf(node, "or %D2, %S3, $zero");
+    loongarch64_emitf(node, "sc.%s %D2, %S1, 0", size);
+    loongarch64_emitf(node, "beqz %D2, 1b");
+    be_emit_cstring("2:\n");
+    be_emit_write_line();
+    loongarch64_emitf(node, "dbar 0");
+}
+
+static void emit_loongarch64_cas_w(const ir_node *node) { emit_cas(node, "w"); }
+
+static void emit_loongarch64_cas_d(const ir_node *node) { emit_cas(node, "d"); }
+
 static void emit_jmp(ir_node const *const node, ir_node const *const target) {
     BE_EMIT_JMP(loongarch64, node, "b", target) { loongarch64_emitf(NULL, "nop"); }
 }
@@ -113,14 +320,44 @@ static void emit_loongarch64_b_cond(const ir_node *node) {
     }
 }
 
+static void emit_loongarch64_b_fcc(const ir_node *node) {
+    be_cond_branch_projs_t const projs = be_get_cond_branch_projs(node);
+
+    if (be_is_fallthrough(projs.t)) {
+        loongarch64_emitf(node, "bceqz %S0, %L", projs.f);
+    } else {
+        loongarch64_emitf(node, "bcnez %S0, %L", projs.t);
+        emit_jmp(node, projs.f);
+    }
+}
+
+// Entries are offsets relative to the table, so the table needs no dynamic
+// relocations.
+static void emit_jumptable_target(ir_entity const *const table, ir_node const *const proj_x) {
+    be_emit_cfop_target(proj_x);
+    be_emit_char('-');
+    be_gas_emit_entity(table);
+}
+
+static void emit_loongarch64_switch(const ir_node *node) {
+    loongarch64_emitf(node, "jr %S0");
+
+    loongarch64_switch_attr_t const *const attr = get_loongarch64_switch_attr_const(node);
+    be_emit_jump_table(node, &attr->swtch, mode_Iu, emit_jumptable_target);
+}
+
+// Also emits CopyKeep, whose copied value is its first operand as well.
 static void emit_be_Copy(ir_node const *const node) {
-    ir_node *const               op  = be_get_Copy_op(node);
-    arch_register_t const *const in  = arch_get_irn_register(op);
+    arch_register_t const *const in  = arch_get_irn_register_in(node, 0);
     arch_register_t const *const out = arch_get_irn_register(node);
     if (in == out)
         return;
 
-    loongarch64_emitf(node, "ori %D0, %S0, 0");
+    if (out->cls == &loongarch64_reg_classes[CLASS_loongarch64_fp]) {
+        loongarch64_emitf(node, "fmov.d %D0, %S0");
+    } else {
+        loongarch64_emitf(node, "or %D0, %S0, $zero");
+    }
 }
 
 static void emit_be_IncSP(const ir_node *node) {
@@ -130,12 +367,65 @@ static void emit_be_IncSP(const ir_node *node) {
     }
 }
 
+static void emit_loongarch64_asm_operand(ir_node const *const node, char const modifier, unsigned const pos) {
+    be_asm_attr_t const *const             attr = get_be_asm_attr_const(node);
+    loongarch64_asm_operand_t const *const op   = &((loongarch64_asm_operand_t const *)attr->operands)[pos];
+    // modifiers:
+    //   z: print normally, except immediate 0 as $zero
+    if (!be_is_valid_asm_operand_kind(node, modifier, pos, op->op.kind, "z", "", ""))
+        return;
+
+    switch (op->op.kind) {
+    case BE_ASM_OPERAND_INVALID:
+        panic("invalid asm operand");
+
+    case BE_ASM_OPERAND_INPUT_VALUE:
+        emit_register(arch_get_irn_register_in(node, op->op.pos));
+        return;
+
+    case BE_ASM_OPERAND_OUTPUT_VALUE:
+        emit_register(arch_get_irn_register_out(node, op->op.pos));
+        return;
+
+    case BE_ASM_OPERAND_IMMEDIATE:
+        if (modifier == 'z' && op->val == 0 && !op->ent) {
+            emit_register(&loongarch64_registers[REG_ZERO]);
+        } else {
+            emit_immediate_val(op->ent, op->val);
+        }
+        return;
+
+    case BE_ASM_OPERAND_LABEL:
+        be_emit_cfop_target_pos(node, op->op.pos);
+        return;
+
+    case BE_ASM_OPERAND_MEMORY:
+        // Like gcc, as base register and offset of a load or store
+        emit_register(arch_get_irn_register_in(node, op->op.pos));
+        be_emit_cstring(", 0");
+        return;
+    }
+    panic("invalid asm operand kind");
+}
+
+static void emit_be_ASM(const ir_node *node) {
+    ir_node const *const fallthrough = be_emit_asm(node, &emit_loongarch64_asm_operand);
+    if (fallthrough)
+        emit_jmp(node, fallthrough);
+}
+
 static void emit_be_Perm(ir_node const *const node) {
+    // $r21 is never allocated, so it is free to be used as scratch register.
+    // Moves through it are shorter dependency chains than a XOR swap.
     arch_register_t const *const out = arch_get_irn_register_out(node, 0);
     if (out->cls == &loongarch64_reg_classes[CLASS_loongarch64_gp]) {
-        loongarch64_emitf(node, "xor %D0, %D0, %D1\n"
-                                "xor %D1, %D0, %D1\n"
-                                "xor %D0, %D0, %D1");
+        loongarch64_emitf(node, "or $r21, %D0, $zero\n"
+                                "or %D0, %D1, $zero\n"
+                                "or %D1, $r21, $zero");
+    } else if (out->cls == &loongarch64_reg_classes[CLASS_loongarch64_fp]) {
+        loongarch64_emitf(node, "movfr2gr.d $r21, %D0\n"
+                                "fmov.d %D0, %D1\n"
+                                "movgr2fr.d %D1, $r21");
     } else {
         panic("unexpected register class");
     }
@@ -145,12 +435,323 @@ static void loongarch64_register_emitters(void) {
     be_init_emitters();
     loongarch64_register_spec_emitters();
 
+    be_set_emitter(op_be_Asm, emit_be_ASM);
     be_set_emitter(op_be_Copy, emit_be_Copy);
+    be_set_emitter(op_be_CopyKeep, emit_be_Copy);
     be_set_emitter(op_be_IncSP, emit_be_IncSP);
     be_set_emitter(op_be_Perm, emit_be_Perm);
 
+    be_set_emitter(op_loongarch64_li_w, emit_loongarch64_li_w);
+    be_set_emitter(op_loongarch64_li_d, emit_loongarch64_li_d);
+    be_set_emitter(op_loongarch64_ld_w, emit_loongarch64_ld_w);
+    be_set_emitter(op_loongarch64_ld_d, emit_loongarch64_ld_d);
+    be_set_emitter(op_loongarch64_st_w, emit_loongarch64_st_w);
+    be_set_emitter(op_loongarch64_st_d, emit_loongarch64_st_d);
     be_set_emitter(op_loongarch64_b, emit_loongarch64_b);
     be_set_emitter(op_loongarch64_b_cond, emit_loongarch64_b_cond);
+    be_set_emitter(op_loongarch64_b_fcc, emit_loongarch64_b_fcc);
+    be_set_emitter(op_loongarch64_switch, emit_loongarch64_switch);
+    be_set_emitter(op_loongarch64_vcopy, emit_loongarch64_vcopy);
+    be_set_emitter(op_loongarch64_cas_w, emit_loongarch64_cas_w);
+    be_set_emitter(op_loongarch64_cas_d, emit_loongarch64_cas_d);
+}
+
+// Call frame information
+//
+// The prologue does not save registers explicitly: the return address and the
+// callee saved registers are ordinary values, which the register allocator
+// keeps in their register, copies or spills like any other value. To describe
+// where the unwinder finds them, the emitter tracks these values through
+// copies, spills and reloads and simulates the stack pointer.
+
+// Registers whose value at function entry the unwinder has to recover.
+static unsigned const cfi_regs[] = {
+    REG_RA,  REG_S0,  REG_S1,  REG_S2,  REG_S3,  REG_S4,  REG_S5,  REG_S6,  REG_S7,
+    REG_S8,  REG_FS0, REG_FS1, REG_FS2, REG_FS3, REG_FS4, REG_FS5, REG_FS6, REG_FS7,
+};
+
+#define N_CFI_REGS ARRAY_SIZE(cfi_regs)
+#define NO_SLOT INT_MIN
+
+typedef struct cfi_state_t {
+    int      cfa_offset;             // distance of the CFA from `sp`
+    uint64_t regs[N_CFI_REGS];       // registers holding the entry value, by dwarf number
+    int      slots[N_CFI_REGS];      // CFA relative stack slot holding the entry value
+} cfi_state_t;
+
+typedef enum cfi_rule_kind_t {
+    CFI_SAME,
+    CFI_SLOT,
+    CFI_REGISTER,
+} cfi_rule_kind_t;
+
+typedef struct cfi_rule_t {
+    cfi_rule_kind_t kind;
+    int             val; // slot offset or dwarf number
+} cfi_rule_t;
+
+static struct {
+    pmap       *values;        // value or spill -> index into cfi_regs + 1
+    pmap       *block_states;  // block -> cfi_state_t at block entry
+    cfi_state_t state;         // state after the last emitted node
+    int         emitted_cfa_offset;
+    cfi_rule_t  emitted[N_CFI_REGS];
+} cfi;
+
+// The bit of a register in cfi_state_t::regs, 0 for flag registers which never
+// hold a tracked value.
+static uint64_t cfi_reg_bit(arch_register_t const *const reg) {
+    if (reg->cls == &loongarch64_reg_classes[CLASS_loongarch64_fcc])
+        return 0;
+    return (uint64_t)1 << reg->dwarf_number;
+}
+
+static int get_cfi_index(ir_node const *const node) {
+    return PTR_TO_INT(pmap_get(void, cfi.values, node)) - 1;
+}
+
+static bool set_cfi_index(ir_node *const node, int const index) {
+    if (index < 0 || get_cfi_index(node) >= 0)
+        return false;
+    pmap_insert(cfi.values, node, INT_TO_PTR(index + 1));
+    return true;
+}
+
+static bool is_spill_store(ir_node const *const node) {
+    return is_loongarch64_st_d(node) || is_loongarch64_fst_d(node);
+}
+
+// Returns the tracked value a node copies, spills or reloads.
+static int get_copied_cfi_index(ir_node *const node) {
+    if (be_is_Copy(node) || be_is_CopyKeep(node))
+        return get_cfi_index(be_get_Copy_op(node));
+    if (is_loongarch64_st_d(node))
+        return get_cfi_index(get_irn_n(node, n_loongarch64_st_d_value));
+    if (is_loongarch64_fst_d(node))
+        return get_cfi_index(get_irn_n(node, n_loongarch64_fst_d_value));
+    if (is_Phi(node)) {
+        // Memory Phis merge spill slots of a single value, possibly in a loop.
+        bool const is_mem = get_irn_mode(node) == mode_M;
+        int        index  = -1;
+        foreach_irn_in(node, i, pred) {
+            int const pred_index = get_cfi_index(pred);
+            if (pred_index >= 0)
+                index = pred_index;
+            else if (is_mem && !is_Phi(pred))
+                return -1;
+        }
+        return index;
+    }
+    if (!is_Proj(node))
+        return -1;
+
+    ir_node *const pred = get_Proj_pred(node);
+    unsigned const pn   = get_Proj_num(node);
+    if (be_is_Start(pred)) {
+        arch_register_t const *const reg = arch_get_irn_register(node);
+        for (size_t i = 0; i != N_CFI_REGS; ++i) {
+            if (reg == &loongarch64_registers[cfi_regs[i]])
+                return i;
+        }
+    } else if (be_is_Perm(pred)) {
+        return get_cfi_index(get_irn_n(pred, pn));
+    } else if (is_loongarch64_ld_d(pred) && pn == pn_loongarch64_ld_d_res) {
+        return get_cfi_index(get_irn_n(pred, n_loongarch64_ld_d_mem));
+    } else if (is_loongarch64_fld_d(pred) && pn == pn_loongarch64_fld_d_res) {
+        return get_cfi_index(get_irn_n(pred, n_loongarch64_fld_d_mem));
+    }
+    return -1;
+}
+
+static void find_cfi_values_walker(ir_node *const node, void *const data) {
+    bool *const changed = (bool *)data;
+    if (set_cfi_index(node, get_copied_cfi_index(node)))
+        *changed = true;
+}
+
+static void find_cfi_values(ir_graph *const irg) {
+    bool changed;
+    do {
+        changed = false;
+        irg_walk_graph(irg, NULL, find_cfi_values_walker, &changed);
+    } while (changed);
+}
+
+static void cfi_clobber_register(cfi_state_t *const state, arch_register_t const *const reg) {
+    uint64_t const bit = cfi_reg_bit(reg);
+    for (size_t i = 0; i != N_CFI_REGS; ++i) {
+        state->regs[i] &= ~bit;
+    }
+}
+
+static void cfi_define_register(cfi_state_t *const state, ir_node const *const value,
+                                arch_register_t const *const reg) {
+    int const index = get_cfi_index(value);
+    if (index >= 0)
+        state->regs[index] |= cfi_reg_bit(reg);
+}
+
+static void cfi_sim_node(cfi_state_t *const state, ir_node *const node) {
+    if (be_is_IncSP(node)) {
+        state->cfa_offset += be_get_IncSP_offset(node);
+        return;
+    }
+
+    if (is_loongarch64_st_d(node) || is_loongarch64_st_w(node) || is_loongarch64_st_h(node) ||
+        is_loongarch64_st_b(node) || is_loongarch64_fst_s(node) || is_loongarch64_fst_d(node)) {
+        // Every store has the same operands.
+        ir_node *const base = get_irn_n(node, n_loongarch64_st_d_base);
+        if (arch_get_irn_register(base) == &loongarch64_registers[REG_SP]) {
+            int const slot = get_loongarch64_immediate_attr_const(node)->val - state->cfa_offset;
+            for (size_t i = 0; i != N_CFI_REGS; ++i) {
+                if (state->slots[i] == slot)
+                    state->slots[i] = NO_SLOT;
+            }
+            int const index = is_spill_store(node) ? get_cfi_index(node) : -1;
+            if (index >= 0)
+                state->slots[index] = slot;
+        }
+        return;
+    }
+
+    // Outputs without a Proj, e.g. the clobbers of a call, have no register
+    // assigned, their requirement names it.
+    be_foreach_out(node, o) {
+        arch_register_t const *const reg = arch_get_irn_register_out(node, o);
+        if (reg) {
+            cfi_clobber_register(state, reg);
+            continue;
+        }
+        arch_register_req_t const *const req = arch_get_irn_register_req_out(node, o);
+        if (req->limited) {
+            for (unsigned r = 0; r != req->cls->n_regs; ++r) {
+                if (rbitset_is_set(req->limited, r))
+                    cfi_clobber_register(state, arch_register_for_index(req->cls, r));
+            }
+        }
+    }
+    if (get_irn_mode(node) == mode_T) {
+        foreach_out_edge(node, edge) {
+            ir_node *const               proj = get_edge_src_irn(edge);
+            arch_register_t const *const reg  = arch_get_irn_register(proj);
+            if (reg)
+                cfi_define_register(state, proj, reg);
+        }
+    } else {
+        arch_register_t const *const reg = arch_get_irn_register(node);
+        if (reg)
+            cfi_define_register(state, node, reg);
+    }
+}
+
+// Merges the state at the end of a predecessor into the entry state of a block,
+// which keeps only the locations valid on all paths. Returns whether the entry
+// state changed.
+static bool cfi_merge_state(cfi_state_t *const state, cfi_state_t const *const pred) {
+    // All paths into a block agree on the stack pointer: Calls restore it
+    // within their block, the frame block dominates every block reachable from
+    // it and is not part of a loop (see loongarch64_is_frame_block()), and the
+    // epilogues only end in returns.
+    assert(state->cfa_offset == pred->cfa_offset && "inconsistent stack pointer offsets");
+
+    bool changed = false;
+    for (size_t i = 0; i != N_CFI_REGS; ++i) {
+        uint64_t const regs = state->regs[i] & pred->regs[i];
+        if (regs != state->regs[i]) {
+            state->regs[i] = regs;
+            changed        = true;
+        }
+        if (state->slots[i] != pred->slots[i] && state->slots[i] != NO_SLOT) {
+            state->slots[i] = NO_SLOT;
+            changed         = true;
+        }
+    }
+    return changed;
+}
+
+// Computes the state at the entry of each block by simulating the blocks in
+// control flow order until the entry states, merged over all predecessors, do
+// not change anymore.
+static void compute_cfi_block_states(ir_graph *const irg, struct obstack *const obst) {
+    cfi_state_t *const entry = OALLOCZ(obst, cfi_state_t);
+    for (size_t i = 0; i != N_CFI_REGS; ++i) {
+        entry->regs[i]  = cfi_reg_bit(&loongarch64_registers[cfi_regs[i]]);
+        entry->slots[i] = NO_SLOT;
+    }
+
+    ir_node *const start_block = get_irg_start_block(irg);
+    pmap_insert(cfi.block_states, start_block, entry);
+    deq_t worklist;
+    deq_init(&worklist);
+    deq_push_pointer_right(&worklist, start_block);
+    while (!deq_empty(&worklist)) {
+        ir_node *const block = deq_pop_pointer_left(ir_node, &worklist);
+        cfi_state_t    state = *pmap_get(cfi_state_t, cfi.block_states, block);
+        sched_foreach(block, node) {
+            cfi_sim_node(&state, node);
+        }
+        foreach_block_succ(block, edge) {
+            ir_node *const succ = get_edge_src_irn(edge);
+            cfi_state_t *succ_state = pmap_get(cfi_state_t, cfi.block_states, succ);
+            if (succ_state) {
+                if (!cfi_merge_state(succ_state, &state))
+                    continue;
+            } else {
+                succ_state  = OALLOC(obst, cfi_state_t);
+                *succ_state = state;
+                pmap_insert(cfi.block_states, succ, succ_state);
+            }
+            deq_push_pointer_right(&worklist, succ);
+        }
+    }
+    deq_free(&worklist);
+}
+
+static cfi_rule_t get_cfi_rule(size_t const i) {
+    uint64_t const regs = cfi.state.regs[i];
+    if (regs & cfi_reg_bit(&loongarch64_registers[cfi_regs[i]]))
+        return (cfi_rule_t){ CFI_SAME, 0 };
+    if (cfi.state.slots[i] != NO_SLOT)
+        return (cfi_rule_t){ CFI_SLOT, cfi.state.slots[i] };
+    if (regs != 0)
+        return (cfi_rule_t){ CFI_REGISTER, __builtin_ctzll(regs) };
+    // The value is dead, e.g. after the epilogue restored everything else.
+    return cfi.emitted[i];
+}
+
+static arch_register_t const *get_register_by_dwarf_number(int const dwarf) {
+    for (size_t r = 0; r != N_LOONGARCH64_REGISTERS; ++r) {
+        arch_register_t const *const reg = &loongarch64_registers[r];
+        if (cfi_reg_bit(reg) != 0 && reg->dwarf_number == dwarf)
+            return reg;
+    }
+    panic("no register with dwarf number %d", dwarf);
+}
+
+// Emits the directives for the changes since the last emitted state.
+static void emit_cfi_changes(void) {
+    if (cfi.state.cfa_offset != cfi.emitted_cfa_offset) {
+        be_dwarf_callframe_offset(cfi.state.cfa_offset);
+        cfi.emitted_cfa_offset = cfi.state.cfa_offset;
+    }
+    for (size_t i = 0; i != N_CFI_REGS; ++i) {
+        cfi_rule_t const rule = get_cfi_rule(i);
+        if (rule.kind == cfi.emitted[i].kind && rule.val == cfi.emitted[i].val)
+            continue;
+        arch_register_t const *const reg = &loongarch64_registers[cfi_regs[i]];
+        switch (rule.kind) {
+        case CFI_SAME:
+            be_dwarf_callframe_restore(reg);
+            break;
+        case CFI_SLOT:
+            be_dwarf_callframe_spilloffset(reg, rule.val);
+            break;
+        case CFI_REGISTER:
+            be_dwarf_callframe_spillregister(reg, get_register_by_dwarf_number(rule.val));
+            break;
+        }
+        cfi.emitted[i] = rule;
+    }
 }
 
 /**
@@ -160,7 +761,23 @@ static void loongarch64_register_emitters(void) {
 static void loongarch64_emit_block(ir_node *block) {
     be_gas_begin_block(block);
 
-    sched_foreach(block, node) { be_emit_node(node); }
+    bool const frame_info = be_dwarf_emits_frameinfo();
+    if (frame_info) {
+        cfi_state_t const *const state = pmap_get(cfi_state_t, cfi.block_states, block);
+        if (state) {
+            cfi.state = *state;
+            emit_cfi_changes();
+        }
+    }
+    be_dwarf_location(get_irn_dbg_info(block));
+
+    sched_foreach(block, node) {
+        be_emit_node(node);
+        if (frame_info) {
+            cfi_sim_node(&cfi.state, node);
+            emit_cfi_changes();
+        }
+    }
 }
 
 void loongarch64_emit_function(ir_graph *irg) {
@@ -174,6 +791,21 @@ void loongarch64_emit_function(ir_graph *irg) {
     ir_entity *entity = get_irg_entity(irg);
     be_gas_emit_function_prolog(entity, 4, NULL);
 
+    struct obstack obst;
+    obstack_init(&obst);
+    bool const frame_info = be_dwarf_emits_frameinfo();
+    if (frame_info) {
+        cfi.values       = pmap_create();
+        cfi.block_states = pmap_create();
+        find_cfi_values(irg);
+        compute_cfi_block_states(irg, &obst);
+        cfi.emitted_cfa_offset = 0;
+        for (size_t i = 0; i != N_CFI_REGS; ++i) {
+            cfi.emitted[i] = (cfi_rule_t){ CFI_SAME, 0 };
+        }
+        be_dwarf_callframe_register(&loongarch64_registers[REG_SP]);
+    }
+
     /* populate jump link fields with their destinations */
     ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
 
@@ -185,5 +817,11 @@ void loongarch64_emit_function(ir_graph *irg) {
     }
     ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 
+    if (frame_info) {
+        pmap_destroy(cfi.block_states);
+        pmap_destroy(cfi.values);
+    }
+    obstack_free(&obst, NULL);
+
     be_gas_emit_function_epilog(entity);
 }
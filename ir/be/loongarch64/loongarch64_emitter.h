@@ -11,6 +11,8 @@
 #define FIRM_BE_loongarch64_loongarch64_EMITTER_H
 
 #include "firm_types.h"
+#include "loongarch64_encode.h"
+#include <stdint.h>
 
 /**
  * emit assembler instructions with format string. Automatically indents
@@ -29,4 +31,32 @@ void loongarch64_emitf(const ir_node *node, const char *format, ...);
 
 void loongarch64_emit_function(ir_graph *irg);
 
+/** Source register of a constant materialization step. */
+typedef enum loongarch64_li_src_t {
+    loongarch64_li_src_none, // lu12i.w, lu32i.d
+    loongarch64_li_src_zero, // $zero
+    loongarch64_li_src_self, // the destination register
+} loongarch64_li_src_t;
+
+/** One instruction of a constant materialization. */
+typedef struct loongarch64_li_step_t {
+    char const          *name;
+    uint32_t             opcode;
+    loongarch64_li_src_t src;
+    int32_t              imm;
+} loongarch64_li_step_t;
+
+#define LOONGARCH64_MAX_LI_STEPS 4
+
+/**
+ * Computes the instructions materializing @p value, returns their number.
+ */
+unsigned loongarch64_plan_constant(int64_t value, loongarch64_li_step_t *steps);
+
+/**
+ * Returns the number of instructions needed to materialize the constant of a
+ * li_w or li_d node.
+ */
+unsigned loongarch64_get_li_length(const ir_node *node);
+
 #endif
@@ -0,0 +1,747 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   loongarch64 binary encoding
+ *
+ * Every instruction is a 32 bit word. Fields which depend on the final code
+ * layout or on entity addresses are filled in by relocations, which patch the
+ * words emitted right after them. Without a linker there is no GOT or PC
+ * relative access to entities, so the JIT builds their addresses with
+ * absolute lu12i.w/lu32i.d/lu52i.d sequences. Object files use the same code
+ * sequences as the assembler output and leave entity addresses to ELF
+ * relocations.
+ */
+#include "loongarch64_encode.h"
+
+#include "beblocksched.h"
+#include "beemithlp.h"
+#include "begnuas.h"
+#include "beelf.h"
+#include "bejit.h"
+#include "benode.h"
+#include "besched.h"
+#include "gen_loongarch64_emitter.h"
+#include "gen_loongarch64_regalloc_if.h"
+#include "irnodehashmap.h"
+#include "loongarch64_bearch_t.h"
+#include "loongarch64_emitter.h"
+#include "loongarch64_new_nodes.h"
+#include "panic.h"
+#include "pmap.h"
+#include "util.h"
+#include <string.h>
+
+#define NOP 0x03400000 // andi $zero, $zero, 0
+
+// ELF relocation types of the LoongArch psABI
+enum {
+    R_LARCH_32             = 1,
+    R_LARCH_64             = 2,
+    R_LARCH_B26            = 66,
+    R_LARCH_ABS_HI20       = 67,
+    R_LARCH_ABS_LO12       = 68,
+    R_LARCH_ABS64_LO20     = 69,
+    R_LARCH_ABS64_HI12     = 70,
+    R_LARCH_PCALA_HI20     = 71,
+    R_LARCH_PCALA_LO12     = 72,
+    R_LARCH_GOT_PC_HI20    = 75,
+    R_LARCH_GOT_PC_LO12    = 76,
+    R_LARCH_TLS_LE_HI20    = 83,
+    R_LARCH_TLS_LE_LO12    = 84,
+    R_LARCH_TLS_IE_PC_HI20 = 87,
+    R_LARCH_TLS_IE_PC_LO12 = 88,
+    R_LARCH_TLS_GD_PC_HI20 = 97,
+};
+
+be_elf_target_t const loongarch64_elf_target = {
+    .machine     = 258,  // EM_LOONGARCH
+    .flags       = 0x43, // EF_LARCH_OBJABI_V1 | EF_LARCH_ABI_DOUBLE_FLOAT
+    .reloc_abs32 = R_LARCH_32,
+    .reloc_abs64 = R_LARCH_64,
+};
+
+// Whether the code is encoded for an object file instead of the JIT
+static bool object_output;
+
+// Fragment numbers of blocks
+static ir_nodehashmap_t block_fragment_num;
+// Fragment numbers of jump tables, by their entity
+static pmap *table_fragment_num;
+
+static unsigned reg_in(ir_node const *const node, unsigned const pos) {
+    return arch_get_irn_register_in(node, pos)->encoding;
+}
+
+static unsigned reg_out(ir_node const *const node, unsigned const pos) {
+    return arch_get_irn_register_out(node, pos)->encoding;
+}
+
+static uint32_t imm12(int64_t const val) { return (val & 0xFFF) << 10; }
+
+static uint32_t imm20(int64_t const val) { return (val & 0xFFFFF) << 5; }
+
+void loongarch64_enc_3r(ir_node const *const node, uint32_t const opcode) {
+    be_emit32(opcode | reg_in(node, 1) << 10 | reg_in(node, 0) << 5 | reg_out(node, 0));
+}
+
+void loongarch64_enc_2r(ir_node const *const node, uint32_t const opcode) {
+    be_emit32(opcode | reg_in(node, 0) << 5 | reg_out(node, 0));
+}
+
+void loongarch64_enc_2ri(ir_node const *const node, uint32_t const opcode, unsigned const bits) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    assert(!attr->ent);
+    uint32_t const mask = (1U << bits) - 1;
+    be_emit32(opcode | (attr->val & mask) << 10 | reg_in(node, 0) << 5 | reg_out(node, 0));
+}
+
+void loongarch64_enc_4r(ir_node const *const node, uint32_t const opcode) {
+    be_emit32(opcode | reg_in(node, 2) << 15 | reg_in(node, 1) << 10 | reg_in(node, 0) << 5 | reg_out(node, 0));
+}
+
+void loongarch64_enc_alsl(ir_node const *const node, uint32_t const opcode) {
+    int64_t const sa = get_loongarch64_immediate_attr_const(node)->val;
+    assert(1 <= sa && sa <= 4);
+    be_emit32(opcode | (sa - 1) << 15 | reg_in(node, 1) << 10 | reg_in(node, 0) << 5 | reg_out(node, 0));
+}
+
+void loongarch64_enc_bstrpick_d(ir_node const *const node, unsigned const msb, unsigned const lsb) {
+    assert(lsb <= msb && msb < 64);
+    be_emit32(0x00C00000 | msb << 16 | lsb << 10 | reg_in(node, 0) << 5 | reg_out(node, 0));
+}
+
+void loongarch64_enc_fcmp(ir_node const *const node, uint32_t const opcode) {
+    static uint8_t const conds[] = {
+        [loongarch64_fcond_caf] = 0x00, [loongarch64_fcond_cun] = 0x08,  [loongarch64_fcond_ceq] = 0x04,
+        [loongarch64_fcond_cueq] = 0x0C, [loongarch64_fcond_clt] = 0x02, [loongarch64_fcond_cult] = 0x0A,
+        [loongarch64_fcond_cle] = 0x06, [loongarch64_fcond_cule] = 0x0E, [loongarch64_fcond_cne] = 0x10,
+        [loongarch64_fcond_cor] = 0x14, [loongarch64_fcond_cune] = 0x18, [loongarch64_fcond_slt] = 0x03,
+        [loongarch64_fcond_sle] = 0x07,
+    };
+    loongarch64_fcond_t const fcond = get_loongarch64_fcmp_attr_const(node)->fcond;
+    assert((size_t)fcond < ARRAY_SIZE(conds));
+    be_emit32(opcode | conds[fcond] << 15 | reg_in(node, 1) << 10 | reg_in(node, 0) << 5 | reg_out(node, 0));
+}
+
+void loongarch64_enc_jirl(ir_node const *const node, unsigned const rd, unsigned const pos) {
+    be_emit32(0x4C000000 | reg_in(node, pos) << 5 | rd);
+}
+
+// Encodes the si12 offset of a load or store. Entities left after the frame
+// layout are globals, whose page the base register holds.
+static void enc_access(ir_node const *const node, uint32_t const insn) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    if (attr->ent) {
+        be_emit_reloc_entity(0, LOONGARCH64_RELOC_LO12, attr->ent, attr->val);
+        be_emit32(insn);
+    } else {
+        assert(is_simm12(attr->val));
+        be_emit32(insn | imm12(attr->val));
+    }
+}
+
+void loongarch64_enc_load(ir_node const *const node, uint32_t const opcode) {
+    enc_access(node, opcode | reg_in(node, 1) << 5 | reg_out(node, 1));
+}
+
+void loongarch64_enc_store(ir_node const *const node, uint32_t const opcode) {
+    enc_access(node, opcode | reg_in(node, 1) << 5 | reg_in(node, 2));
+}
+
+void loongarch64_enc_preld(ir_node const *const node, uint32_t const opcode, unsigned const hint) {
+    enc_access(node, opcode | reg_in(node, 1) << 5 | hint);
+}
+
+void loongarch64_enc_code(ir_node const *const node, uint32_t const opcode) {
+    int64_t const code = get_loongarch64_immediate_attr_const(node)->val;
+    assert(0 <= code && code < 1 << 15);
+    be_emit32(opcode | (uint32_t)code);
+}
+
+void loongarch64_enc_loadx(ir_node const *const node, uint32_t const opcode) {
+    be_emit32(opcode | reg_in(node, 2) << 10 | reg_in(node, 1) << 5 | reg_out(node, 1));
+}
+
+void loongarch64_enc_storex(ir_node const *const node, uint32_t const opcode) {
+    be_emit32(opcode | reg_in(node, 2) << 10 | reg_in(node, 1) << 5 | reg_in(node, 3));
+}
+
+// Encodes ld.w/ld.d/st.w/st.d, or ldptr/stptr if the offset only fits their
+// scaled 14 bit immediate.
+static void enc_ptr_access(ir_node const *const node, uint32_t const opcode, uint32_t const ptr_opcode,
+                           unsigned const rd) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    uint32_t const                            regs = reg_in(node, 1) << 5 | rd;
+    if (!attr->ent && !is_simm12(attr->val) && is_ptr_offset(attr->val)) {
+        be_emit32(ptr_opcode | ((attr->val >> 2) & 0x3FFF) << 10 | regs);
+    } else {
+        enc_access(node, opcode | regs);
+    }
+}
+
+static void enc_loongarch64_ld_w(ir_node const *const node) {
+    enc_ptr_access(node, 0x28800000, 0x24000000, reg_out(node, 1));
+}
+
+static void enc_loongarch64_ld_d(ir_node const *const node) {
+    enc_ptr_access(node, 0x28C00000, 0x26000000, reg_out(node, 1));
+}
+
+static void enc_loongarch64_st_w(ir_node const *const node) {
+    enc_ptr_access(node, 0x29800000, 0x25000000, reg_in(node, 2));
+}
+
+static void enc_loongarch64_st_d(ir_node const *const node) {
+    enc_ptr_access(node, 0x29C00000, 0x27000000, reg_in(node, 2));
+}
+
+// Absolute address of the entity in rd, patched by the relocation
+static void enc_abs_address(ir_entity *const ent, int64_t const val, unsigned const rd) {
+    be_emit_reloc_entity(0, LOONGARCH64_RELOC_ABS, ent, val);
+    be_emit32(0x14000000 | rd);
+    be_emit32(0x03800000 | rd << 5 | rd);
+    be_emit32(0x16000000 | rd);
+    be_emit32(0x03000000 | rd << 5 | rd);
+}
+
+static void enc_li(ir_node const *const node, int64_t const value) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    unsigned const                            rd   = reg_out(node, 0);
+    if (attr->ent) {
+        enc_abs_address(attr->ent, attr->val, rd);
+        return;
+    }
+
+    loongarch64_li_step_t steps[LOONGARCH64_MAX_LI_STEPS];
+    unsigned const        n = loongarch64_plan_constant(value, steps);
+    for (unsigned i = 0; i < n; ++i) {
+        loongarch64_li_step_t const *const step = &steps[i];
+        switch (step->src) {
+        case loongarch64_li_src_none:
+            be_emit32(step->opcode | imm20(step->imm) | rd);
+            break;
+        case loongarch64_li_src_zero:
+            be_emit32(step->opcode | imm12(step->imm) | rd);
+            break;
+        case loongarch64_li_src_self:
+            be_emit32(step->opcode | imm12(step->imm) | rd << 5 | rd);
+            break;
+        }
+    }
+}
+
+static void enc_loongarch64_li_w(ir_node const *const node) {
+    enc_li(node, (int32_t)get_loongarch64_immediate_attr_const(node)->val);
+}
+
+static void enc_loongarch64_li_d(ir_node const *const node) {
+    enc_li(node, get_loongarch64_immediate_attr_const(node)->val);
+}
+
+// pcalau12i rd, 0
+static void enc_pcalau12i(unsigned const rd) { be_emit32(0x1A000000 | rd); }
+
+// addi.d rd, rd, 0
+static void enc_addi_d(unsigned const rd) { be_emit32(0x02C00000 | rd << 5 | rd); }
+
+// ld.d rd, rd, 0
+static void enc_ld_d(unsigned const rd) { be_emit32(0x28C00000 | rd << 5 | rd); }
+
+static void enc_loongarch64_pcalau12i(ir_node const *const node) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    unsigned const                            rd   = reg_out(node, 0);
+    be_emit_reloc_entity(0, LOONGARCH64_RELOC_PAGE, attr->ent, attr->val);
+    if (object_output) {
+        enc_pcalau12i(rd);
+        return;
+    }
+    be_emit32(0x14000000 | rd);
+    be_emit32(0x16000000 | rd);
+    be_emit32(0x03000000 | rd << 5 | rd);
+}
+
+static void enc_loongarch64_load_address(ir_node const *const node) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    unsigned const                            rd   = reg_out(node, 0);
+    if (pmap_contains(table_fragment_num, attr->ent)) {
+        // Jump tables are part of the code
+        unsigned const fragment_num = PTR_TO_INT(pmap_get(void, table_fragment_num, attr->ent));
+        be_emit_reloc_fragment(0, LOONGARCH64_RELOC_PCREL, fragment_num, attr->val);
+        be_emit32(0x1C000000 | rd);
+        enc_addi_d(rd);
+    } else if (object_output) {
+        be_emit_reloc_entity(0, LOONGARCH64_RELOC_PCALA, attr->ent, attr->val);
+        enc_pcalau12i(rd);
+        enc_addi_d(rd);
+    } else {
+        enc_abs_address(attr->ent, attr->val, rd);
+    }
+}
+
+// The JIT resolves all symbols itself, it needs no GOT.
+static void enc_loongarch64_load_got(ir_node const *const node) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    unsigned const                            rd   = reg_out(node, 0);
+    if (object_output) {
+        be_emit_reloc_entity(0, LOONGARCH64_RELOC_GOT, attr->ent, attr->val);
+        enc_pcalau12i(rd);
+        enc_ld_d(rd);
+    } else {
+        enc_abs_address(attr->ent, attr->val, rd);
+    }
+}
+
+// JIT compiled code has no TLS block of its own.
+static void check_tls(ir_node const *const node) {
+    if (!object_output)
+        panic("thread-local entity %+F not supported by the JIT", get_loongarch64_immediate_attr_const(node)->ent);
+}
+
+// add.d rd, rd, $tp
+static void enc_add_tp(ir_node const *const node) {
+    unsigned const rd = reg_out(node, 0);
+    be_emit32(0x00108000 | reg_in(node, 0) << 10 | rd << 5 | rd);
+}
+
+static void enc_loongarch64_tls_le(ir_node const *const node) {
+    check_tls(node);
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    unsigned const                            rd   = reg_out(node, 0);
+    be_emit_reloc_entity(0, LOONGARCH64_RELOC_TLS_LE, attr->ent, attr->val);
+    be_emit32(0x14000000 | rd);           // lu12i.w
+    be_emit32(0x03800000 | rd << 5 | rd); // ori
+    enc_add_tp(node);
+}
+
+static void enc_loongarch64_tls_ie(ir_node const *const node) {
+    check_tls(node);
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    unsigned const                            rd   = reg_out(node, 0);
+    be_emit_reloc_entity(0, LOONGARCH64_RELOC_TLS_IE, attr->ent, attr->val);
+    enc_pcalau12i(rd);
+    enc_ld_d(rd);
+    enc_add_tp(node);
+}
+
+static void enc_loongarch64_tls_gd(ir_node const *const node) {
+    check_tls(node);
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    unsigned const                            rd   = reg_out(node, 0);
+    be_emit_reloc_entity(0, LOONGARCH64_RELOC_TLS_GD, attr->ent, attr->val);
+    enc_pcalau12i(rd);
+    enc_addi_d(rd);
+}
+
+// Loads the absolute address of the callee into `tmp` and jumps there, linking
+// into `link`. Object files use bl or b and leave far callees to the linker.
+static void enc_call_sequence(ir_node const *const node, unsigned const tmp, unsigned const link) {
+    loongarch64_immediate_attr_t const *const attr = get_loongarch64_immediate_attr_const(node);
+    be_emit_reloc_entity(0, LOONGARCH64_RELOC_CALL, attr->ent, attr->val);
+    if (object_output) {
+        be_emit32(link != 0 ? 0x54000000 : 0x50000000);
+        return;
+    }
+    be_emit32(0x14000000 | tmp);
+    be_emit32(0x16000000 | tmp);
+    be_emit32(0x03000000 | tmp << 5 | tmp);
+    be_emit32(0x4C000000 | tmp << 5 | link);
+}
+
+static void enc_loongarch64_call(ir_node const *const node) { enc_call_sequence(node, 1, 1); }
+
+// $ra still holds the return address of our caller, so jump through the
+// scratch register $r21 without linking.
+static void enc_loongarch64_tail_call(ir_node const *const node) { enc_call_sequence(node, 21, 0); }
+
+// The branches of the ll/sc loop have fixed offsets, see emit_cas().
+static void enc_cas(ir_node const *const node, uint32_t const ll, uint32_t const sc) {
+    unsigned const res     = reg_out(node, pn_loongarch64_cas_w_res);
+    unsigned const scratch = reg_out(node, pn_loongarch64_cas_w_scratch);
+    unsigned const ptr     = reg_in(node, n_loongarch64_cas_w_ptr);
+    unsigned const old     = reg_in(node, n_loongarch64_cas_w_old);
+    unsigned const new     = reg_in(node, n_loongarch64_cas_w_new);
+    be_emit32(ll | ptr << 5 | res);
+    be_emit32(0x5C000000 | 4 << 10 | res << 5 | old);               // bne res, old, +16
+    be_emit32(0x00150000 | new << 5 | scratch);                     // or scratch, new, $zero
+    be_emit32(sc | ptr << 5 | scratch);
+    be_emit32(0x40000000 | (-4 & 0xFFFF) << 10 | scratch << 5 | 0x1F); // beqz scratch, -16
+    be_emit32(0x38720000);                                          // dbar 0
+}
+
+static void enc_loongarch64_cas_w(ir_node const *const node) { enc_cas(node, 0x20000000, 0x21000000); }
+
+static void enc_loongarch64_cas_d(ir_node const *const node) { enc_cas(node, 0x22000000, 0x23000000); }
+
+static void enc_loongarch64_vcopy(ir_node const *const node) {
+    bool const     lasx    = loongarch64_simd == loongarch64_simd_lasx;
+    uint32_t const ld      = lasx ? 0x2C800000 : 0x2C000000;
+    uint32_t const st      = lasx ? 0x2CC00000 : 0x2C400000;
+    unsigned const vsize   = loongarch64_vector_size();
+    unsigned const scratch = reg_out(node, pn_loongarch64_vcopy_scratch);
+    unsigned const dst     = reg_in(node, n_loongarch64_vcopy_dst);
+    unsigned const src     = reg_in(node, n_loongarch64_vcopy_src);
+    int64_t const  size    = get_loongarch64_immediate_attr_const(node)->val;
+    assert(vsize != 0 && size >= vsize);
+    for (int64_t offset = 0; offset < size; offset += vsize) {
+        // The last vector overlaps the previous one
+        int64_t const at = offset + vsize <= size ? offset : size - vsize;
+        be_emit32(ld | imm12(at) | src << 5 | scratch);
+        be_emit32(st | imm12(at) | dst << 5 | scratch);
+    }
+}
+
+static unsigned get_block_fragment_num(ir_node const *const block) {
+    return PTR_TO_INT(ir_nodehashmap_get(void, &block_fragment_num, block));
+}
+
+static void enc_branch(uint8_t const kind, uint32_t const insn, ir_node const *const cfop) {
+    ir_node const *const target = be_emit_get_cfop_target(cfop);
+    be_emit_reloc_fragment(0, kind, get_block_fragment_num(target), 0);
+    be_emit32(insn);
+}
+
+static void enc_jmp(ir_node const *const cfop) {
+    if (!be_is_fallthrough(cfop))
+        enc_branch(LOONGARCH64_RELOC_B26, 0x50000000, cfop);
+}
+
+static void enc_loongarch64_b(ir_node const *const node) { enc_jmp(node); }
+
+static void enc_cond_branch(ir_node const *const node, loongarch64_cond_t const cond, ir_node const *const cfop) {
+    static uint32_t const opcodes[] = {
+        [loongarch64_beq] = 0x58000000,  [loongarch64_bne] = 0x5C000000,  [loongarch64_blt] = 0x60000000,
+        [loongarch64_bge] = 0x64000000,  [loongarch64_bltu] = 0x68000000, [loongarch64_bgeu] = 0x6C000000,
+        [loongarch64_beqz] = 0x40000000, [loongarch64_bnez] = 0x44000000,
+    };
+    assert((size_t)cond < ARRAY_SIZE(opcodes));
+    uint32_t const insn = opcodes[cond] | reg_in(node, 0) << 5;
+    if (cond == loongarch64_beqz || cond == loongarch64_bnez) {
+        enc_branch(LOONGARCH64_RELOC_B21, insn, cfop);
+    } else {
+        enc_branch(LOONGARCH64_RELOC_B16, insn | reg_in(node, 1), cfop);
+    }
+}
+
+static void enc_loongarch64_b_cond(ir_node const *const node) {
+    loongarch64_cond_t const     cond  = get_loongarch64_cond_attr_const(node)->cond;
+    be_cond_branch_projs_t const projs = be_get_cond_branch_projs(node);
+
+    if (be_is_fallthrough(projs.t)) {
+        enc_cond_branch(node, loongarch64_negate_cond(cond), projs.f);
+    } else {
+        enc_cond_branch(node, cond, projs.t);
+        enc_jmp(projs.f);
+    }
+}
+
+static void enc_loongarch64_b_fcc(ir_node const *const node) {
+    be_cond_branch_projs_t const projs = be_get_cond_branch_projs(node);
+    uint32_t const               cj    = reg_in(node, 0) << 5;
+
+    if (be_is_fallthrough(projs.t)) {
+        enc_branch(LOONGARCH64_RELOC_B21, 0x48000000 | cj, projs.f); // bceqz
+    } else {
+        enc_branch(LOONGARCH64_RELOC_B21, 0x48000100 | cj, projs.t); // bcnez
+        enc_jmp(projs.f);
+    }
+}
+
+static void enc_loongarch64_switch(ir_node const *const node) {
+    loongarch64_enc_jirl(node, 0, 0);
+}
+
+// The jump table directly follows the block of the switch. Like in the
+// assembler output its entries are offsets relative to the table.
+static void enc_jump_table(ir_node const *const node) {
+    loongarch64_switch_attr_t const *const attr = get_loongarch64_switch_attr_const(node);
+    unsigned const fragment_num = be_begin_fragment(0, 0);
+    assert(fragment_num == (unsigned)PTR_TO_INT(pmap_get(void, table_fragment_num, attr->swtch.table_entity)));
+    (void)fragment_num;
+
+    unsigned long         length;
+    ir_node const **const targets = be_get_jump_table_targets(node, &attr->swtch, &length);
+    for (unsigned long i = 0; i < length; ++i) {
+        ir_node const *const target = be_emit_get_cfop_target(targets[i]);
+        be_emit_reloc_fragment(0, LOONGARCH64_RELOC_TABLE, get_block_fragment_num(target), 4 * i);
+        be_emit32(0);
+    }
+    free(targets);
+
+    be_finish_fragment();
+}
+
+// There is no assembler for the text of asm statements.
+static void enc_be_Asm(ir_node const *const node) {
+    panic("inline assembler in %+F not supported by the binary encoder", get_irn_irg(node));
+}
+
+static void enc_be_Copy(ir_node const *const node) {
+    unsigned const in  = reg_in(node, 0);
+    unsigned const out = reg_out(node, 0);
+    if (in == out)
+        return;
+
+    if (arch_get_irn_register(node)->cls == &loongarch64_reg_classes[CLASS_loongarch64_fp]) {
+        be_emit32(0x01149800 | in << 5 | out); // fmov.d
+    } else {
+        be_emit32(0x00150000 | in << 5 | out); // or rd, rj, $zero
+    }
+}
+
+static void enc_be_IncSP(ir_node const *const node) {
+    int const offset = be_get_IncSP_offset(node);
+    if (offset != 0) {
+        assert(is_simm12(-offset));
+        be_emit32(0x02C00000 | imm12(-offset) | reg_in(node, 0) << 5 | reg_out(node, 0)); // addi.d
+    }
+}
+
+static void enc_be_Perm(ir_node const *const node) {
+    arch_register_t const *const out = arch_get_irn_register_out(node, 0);
+    unsigned const               r0  = out->encoding;
+    unsigned const               r1  = reg_out(node, 1);
+    if (out->cls == &loongarch64_reg_classes[CLASS_loongarch64_gp]) {
+        be_emit32(0x00150000 | r0 << 5 | 21); // or $r21, r0, $zero
+        be_emit32(0x00150000 | r1 << 5 | r0);
+        be_emit32(0x00150000 | 21 << 5 | r1);
+    } else if (out->cls == &loongarch64_reg_classes[CLASS_loongarch64_fp]) {
+        be_emit32(0x0114B800 | r0 << 5 | 21); // movfr2gr.d $r21
+        be_emit32(0x01149800 | r1 << 5 | r0); // fmov.d
+        be_emit32(0x0114A800 | 21 << 5 | r1); // movgr2fr.d
+    } else {
+        panic("unexpected register class");
+    }
+}
+
+static void loongarch64_register_binary_emitters(void) {
+    be_init_emitters();
+    loongarch64_register_spec_binary_emitters();
+
+    be_set_emitter(op_be_Asm, enc_be_Asm);
+    be_set_emitter(op_be_Copy, enc_be_Copy);
+    be_set_emitter(op_be_CopyKeep, enc_be_Copy);
+    be_set_emitter(op_be_IncSP, enc_be_IncSP);
+    be_set_emitter(op_be_Perm, enc_be_Perm);
+
+    be_set_emitter(op_loongarch64_li_w, enc_loongarch64_li_w);
+    be_set_emitter(op_loongarch64_li_d, enc_loongarch64_li_d);
+    be_set_emitter(op_loongarch64_ld_w, enc_loongarch64_ld_w);
+    be_set_emitter(op_loongarch64_ld_d, enc_loongarch64_ld_d);
+    be_set_emitter(op_loongarch64_st_w, enc_loongarch64_st_w);
+    be_set_emitter(op_loongarch64_st_d, enc_loongarch64_st_d);
+    be_set_emitter(op_loongarch64_pcalau12i, enc_loongarch64_pcalau12i);
+    be_set_emitter(op_loongarch64_load_address, enc_loongarch64_load_address);
+    be_set_emitter(op_loongarch64_load_got, enc_loongarch64_load_got);
+    be_set_emitter(op_loongarch64_tls_le, enc_loongarch64_tls_le);
+    be_set_emitter(op_loongarch64_tls_ie, enc_loongarch64_tls_ie);
+    be_set_emitter(op_loongarch64_tls_gd, enc_loongarch64_tls_gd);
+    be_set_emitter(op_loongarch64_call, enc_loongarch64_call);
+    be_set_emitter(op_loongarch64_tail_call, enc_loongarch64_tail_call);
+    be_set_emitter(op_loongarch64_vcopy, enc_loongarch64_vcopy);
+    be_set_emitter(op_loongarch64_cas_w, enc_loongarch64_cas_w);
+    be_set_emitter(op_loongarch64_cas_d, enc_loongarch64_cas_d);
+    be_set_emitter(op_loongarch64_b, enc_loongarch64_b);
+    be_set_emitter(op_loongarch64_b_cond, enc_loongarch64_b_cond);
+    be_set_emitter(op_loongarch64_b_fcc, enc_loongarch64_b_fcc);
+    be_set_emitter(op_loongarch64_switch, enc_loongarch64_switch);
+}
+
+static void gen_binary_block(ir_node *const block) {
+    unsigned const fragment_num = be_begin_fragment(0, 0);
+    assert(fragment_num == get_block_fragment_num(block));
+    (void)fragment_num;
+
+    sched_foreach(block, node) { be_emit_node(node); }
+
+    be_finish_fragment();
+
+    ir_node const *const last = sched_last(block);
+    if (is_loongarch64_switch(last))
+        enc_jump_table(last);
+}
+
+ir_jit_function_t *loongarch64_emit_jit(ir_jit_segment_t *const segment, ir_graph *const irg) {
+    loongarch64_register_binary_emitters();
+
+    ir_node **const block_schedule = be_create_block_schedule(irg);
+
+    be_jit_begin_function(segment);
+
+    // Populate jump link fields with their destinations
+    ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK);
+
+    be_emit_init_cf_links(block_schedule);
+
+    // Jump tables get their own fragment after the block of their switch
+    ir_nodehashmap_init(&block_fragment_num);
+    table_fragment_num = pmap_create();
+    unsigned num = 0;
+    for (size_t i = 0, n = ARR_LEN(block_schedule); i < n; ++i) {
+        ir_node *const block = block_schedule[i];
+        ir_nodehashmap_insert(&block_fragment_num, block, INT_TO_PTR(num++));
+        ir_node const *const last = sched_last(block);
+        if (is_loongarch64_switch(last)) {
+            ir_entity const *const table = get_loongarch64_switch_attr_const(last)->swtch.table_entity;
+            pmap_insert(table_fragment_num, table, INT_TO_PTR(num++));
+        }
+    }
+
+    for (size_t i = 0, n = ARR_LEN(block_schedule); i < n; ++i) {
+        gen_binary_block(block_schedule[i]);
+    }
+    ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
+    ir_nodehashmap_destroy(&block_fragment_num);
+    pmap_destroy(table_fragment_num);
+
+    return be_jit_finish_function();
+}
+
+static void enc_nop_callback(char *buffer, unsigned size) {
+    assert(size % 4 == 0);
+    for (uint32_t const nop = NOP; size > 0; size -= 4, buffer += 4) {
+        memcpy(buffer, &nop, 4);
+    }
+}
+
+static void patch(char *const buffer, unsigned const index, uint32_t const bits) {
+    uint32_t insn;
+    memcpy(&insn, buffer + 4 * index, 4);
+    insn |= bits;
+    memcpy(buffer + 4 * index, &insn, 4);
+}
+
+static int32_t get_branch_offset(int32_t const offset, unsigned const bits) {
+    int32_t const words = offset >> 2;
+    if ((offset & 3) != 0 || words < -(1 << (bits - 1)) || words >= 1 << (bits - 1))
+        panic("branch offset %d out of range", (int)offset);
+    return words;
+}
+
+// Relocations of fragments are relative to the relocated instruction.
+static unsigned enc_fragment_relocation(char *const buffer, uint8_t const be_kind, int32_t const offset) {
+    switch (be_kind) {
+    case LOONGARCH64_RELOC_B16:
+        patch(buffer, 0, (get_branch_offset(offset, 16) & 0xFFFF) << 10);
+        return 4;
+    case LOONGARCH64_RELOC_B21: {
+        int32_t const words = get_branch_offset(offset, 21);
+        patch(buffer, 0, (words & 0xFFFF) << 10 | ((words >> 16) & 0x1F));
+        return 4;
+    }
+    case LOONGARCH64_RELOC_B26: {
+        int32_t const words = get_branch_offset(offset, 26);
+        patch(buffer, 0, (words & 0xFFFF) << 10 | ((words >> 16) & 0x3FF));
+        return 4;
+    }
+    case LOONGARCH64_RELOC_PCREL:
+        patch(buffer, 0, imm20((offset + 0x800) >> 12));
+        patch(buffer, 1, imm12(offset));
+        return 8;
+    case LOONGARCH64_RELOC_TABLE:
+        patch(buffer, 0, (uint32_t)offset);
+        return 4;
+    }
+    panic("invalid relocation %u", (unsigned)be_kind);
+}
+
+static unsigned enc_relocation_callback(char *const buffer, uint8_t const be_kind, ir_entity *const entity,
+                                        int32_t const offset) {
+    if (entity == NULL)
+        return enc_fragment_relocation(buffer, be_kind, offset);
+
+    intptr_t const entity_addr = (intptr_t)be_jit_get_entity_addr(entity);
+    if (entity_addr == (intptr_t)-1)
+        panic("Could not resolve address of entity %+F", entity);
+    int64_t const addr = (int64_t)entity_addr + offset;
+    switch (be_kind) {
+    case LOONGARCH64_RELOC_PAGE: {
+        // The low 12 bits are sign extended by their user
+        int64_t const page = (addr + 0x800) & ~(int64_t)0xFFF;
+        patch(buffer, 0, imm20(page >> 12));
+        patch(buffer, 1, imm20(page >> 32));
+        patch(buffer, 2, imm12(page >> 52));
+        return 12;
+    }
+    case LOONGARCH64_RELOC_LO12:
+        patch(buffer, 0, imm12(addr));
+        return 4;
+    case LOONGARCH64_RELOC_ABS:
+        patch(buffer, 0, imm20(addr >> 12));
+        patch(buffer, 1, imm12(addr));
+        patch(buffer, 2, imm20(addr >> 32));
+        patch(buffer, 3, imm12(addr >> 52));
+        return 16;
+    case LOONGARCH64_RELOC_CALL: {
+        int64_t const page = (addr + 0x800) & ~(int64_t)0xFFF;
+        patch(buffer, 0, imm20(page >> 12));
+        patch(buffer, 1, imm20(page >> 32));
+        patch(buffer, 2, imm12(page >> 52));
+        patch(buffer, 3, ((addr - page) >> 2 & 0xFFFF) << 10);
+        return 16;
+    }
+    }
+    panic("invalid relocation %u", (unsigned)be_kind);
+}
+
+void loongarch64_emit_jit_function(char *const buffer, ir_jit_function_t *const function) {
+    static const be_jit_emit_interface_t jit_emit_interface = {
+        .nops       = enc_nop_callback,
+        .relocation = enc_relocation_callback,
+    };
+    be_jit_emit_memory(buffer, function, &jit_emit_interface);
+}
+
+// Adds the ELF relocations @p types for the consecutive instructions at
+// @p buffer.
+static unsigned add_elf_relocations(char *const buffer, uint32_t const *const types, unsigned const n,
+                                    ir_entity *const entity, int32_t const offset) {
+    for (unsigned i = 0; i < n; ++i) {
+        be_elf_add_relocation(buffer + 4 * i, types[i], entity, offset);
+    }
+    return 4 * n;
+}
+
+static unsigned enc_object_relocation_callback(char *const buffer, uint8_t const be_kind, ir_entity *const entity,
+                                               int32_t const offset) {
+    if (entity == NULL)
+        return enc_fragment_relocation(buffer, be_kind, offset);
+
+    static uint32_t const page[]   = { R_LARCH_PCALA_HI20 };
+    static uint32_t const lo12[]   = { R_LARCH_PCALA_LO12 };
+    static uint32_t const abs[]    = { R_LARCH_ABS_HI20, R_LARCH_ABS_LO12, R_LARCH_ABS64_LO20, R_LARCH_ABS64_HI12 };
+    static uint32_t const call[]   = { R_LARCH_B26 };
+    static uint32_t const pcala[]  = { R_LARCH_PCALA_HI20, R_LARCH_PCALA_LO12 };
+    static uint32_t const got[]    = { R_LARCH_GOT_PC_HI20, R_LARCH_GOT_PC_LO12 };
+    static uint32_t const tls_le[] = { R_LARCH_TLS_LE_HI20, R_LARCH_TLS_LE_LO12 };
+    static uint32_t const tls_ie[] = { R_LARCH_TLS_IE_PC_HI20, R_LARCH_TLS_IE_PC_LO12 };
+    static uint32_t const tls_gd[] = { R_LARCH_TLS_GD_PC_HI20, R_LARCH_GOT_PC_LO12 };
+    switch (be_kind) {
+    case LOONGARCH64_RELOC_PAGE:   return add_elf_relocations(buffer, page, ARRAY_SIZE(page), entity, offset);
+    case LOONGARCH64_RELOC_LO12:   return add_elf_relocations(buffer, lo12, ARRAY_SIZE(lo12), entity, offset);
+    case LOONGARCH64_RELOC_ABS:    return add_elf_relocations(buffer, abs, ARRAY_SIZE(abs), entity, offset);
+    case LOONGARCH64_RELOC_CALL:   return add_elf_relocations(buffer, call, ARRAY_SIZE(call), entity, offset);
+    case LOONGARCH64_RELOC_PCALA:  return add_elf_relocations(buffer, pcala, ARRAY_SIZE(pcala), entity, offset);
+    case LOONGARCH64_RELOC_GOT:    return add_elf_relocations(buffer, got, ARRAY_SIZE(got), entity, offset);
+    case LOONGARCH64_RELOC_TLS_LE: return add_elf_relocations(buffer, tls_le, ARRAY_SIZE(tls_le), entity, offset);
+    case LOONGARCH64_RELOC_TLS_IE: return add_elf_relocations(buffer, tls_ie, ARRAY_SIZE(tls_ie), entity, offset);
+    case LOONGARCH64_RELOC_TLS_GD: return add_elf_relocations(buffer, tls_gd, ARRAY_SIZE(tls_gd), entity, offset);
+    }
+    panic("invalid relocation %u", (unsigned)be_kind);
+}
+
+void loongarch64_emit_object_function(ir_graph *const irg) {
+    static const be_jit_emit_interface_t object_emit_interface = {
+        .nops       = enc_nop_callback,
+        .relocation = enc_object_relocation_callback,
+    };
+    ir_jit_segment_t *const segment = be_new_jit_segment();
+    object_output = true;
+    ir_jit_function_t *const function = loongarch64_emit_jit(segment, irg);
+    object_output = false;
+    be_elf_emit_function(get_irg_entity(irg), 4, function, &object_emit_interface);
+    be_destroy_jit_segment(segment);
+}
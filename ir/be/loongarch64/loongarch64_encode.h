@@ -0,0 +1,88 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   loongarch64 binary encoding
+ */
+#ifndef FIRM_BE_loongarch64_loongarch64_ENCODE_H
+#define FIRM_BE_loongarch64_loongarch64_ENCODE_H
+
+#include "beelf.h"
+#include "firm_types.h"
+#include "jit.h"
+#include <stdint.h>
+
+// Relocations patch the fields of the instructions emitted after them.
+enum {
+    LOONGARCH64_RELOC_B16,    // offs16 of beq, bne, blt, bge, bltu, bgeu
+    LOONGARCH64_RELOC_B21,    // offs21 of beqz, bnez, bceqz, bcnez
+    LOONGARCH64_RELOC_B26,    // offs26 of b
+    LOONGARCH64_RELOC_PCREL,  // pcaddu12i + addi.d
+    LOONGARCH64_RELOC_TABLE,  // jump table entry relative to the table
+    LOONGARCH64_RELOC_PAGE,   // lu12i.w + lu32i.d + lu52i.d of the 4 KiB page, pcalau12i in object files
+    LOONGARCH64_RELOC_LO12,   // si12 offset within the page
+    LOONGARCH64_RELOC_ABS,    // lu12i.w + ori + lu32i.d + lu52i.d
+    LOONGARCH64_RELOC_CALL,   // lu12i.w + lu32i.d + lu52i.d + jirl, bl or b in object files
+    // Only in object files
+    LOONGARCH64_RELOC_PCALA,  // pcalau12i + addi.d
+    LOONGARCH64_RELOC_GOT,    // pcalau12i + ld.d of the GOT entry
+    LOONGARCH64_RELOC_TLS_LE, // lu12i.w + ori of the thread pointer offset
+    LOONGARCH64_RELOC_TLS_IE, // pcalau12i + ld.d of the GOT entry with the offset
+    LOONGARCH64_RELOC_TLS_GD, // pcalau12i + addi.d of the GOT entry for __tls_get_addr
+};
+
+extern be_elf_target_t const loongarch64_elf_target;
+
+ir_jit_function_t *loongarch64_emit_jit(ir_jit_segment_t *segment, ir_graph *irg);
+
+void loongarch64_emit_jit_function(char *buffer, ir_jit_function_t *function);
+
+/** Appends the code of the lowered @p irg to the object file */
+void loongarch64_emit_object_function(ir_graph *irg);
+
+/** rd = %D0, rj = %S0, rk = %S1 */
+void loongarch64_enc_3r(ir_node const *node, uint32_t opcode);
+
+/** rd = %D0, rj = %S0 */
+void loongarch64_enc_2r(ir_node const *node, uint32_t opcode);
+
+/** rd = %D0, rj = %S0 and the low @p bits of the immediate at bit 10 */
+void loongarch64_enc_2ri(ir_node const *node, uint32_t opcode, unsigned bits);
+
+/** fd = %D0, fj = %S0, fk = %S1, fa = %S2 */
+void loongarch64_enc_4r(ir_node const *node, uint32_t opcode);
+
+/** rd = %D0, rj = %S0, rk = %S1, shift amount of the immediate */
+void loongarch64_enc_alsl(ir_node const *node, uint32_t opcode);
+
+/** rd = %D0, rj = %S0, bits @p msb..@p lsb */
+void loongarch64_enc_bstrpick_d(ir_node const *node, unsigned msb, unsigned lsb);
+
+/** cd = %D0, fj = %S0, fk = %S1, condition of the fcmp attribute */
+void loongarch64_enc_fcmp(ir_node const *node, uint32_t opcode);
+
+/** jirl @p rd, %S@p pos, 0 */
+void loongarch64_enc_jirl(ir_node const *node, unsigned rd, unsigned pos);
+
+/** rd = %D1, rj = %S1, offset of the immediate attribute */
+void loongarch64_enc_load(ir_node const *node, uint32_t opcode);
+
+/** rd = %S2, rj = %S1, offset of the immediate attribute */
+void loongarch64_enc_store(ir_node const *node, uint32_t opcode);
+
+/** hint = @p hint, rj = %S1, offset of the immediate attribute */
+void loongarch64_enc_preld(ir_node const *node, uint32_t opcode, unsigned hint);
+
+/** 15 bit code of the immediate attribute */
+void loongarch64_enc_code(ir_node const *node, uint32_t opcode);
+
+/** rd = %D1, rj = %S1, rk = %S2 */
+void loongarch64_enc_loadx(ir_node const *node, uint32_t opcode);
+
+/** rd = %S3, rj = %S1, rk = %S2 */
+void loongarch64_enc_storex(ir_node const *node, uint32_t opcode);
+
+#endif
@@ -21,10 +21,14 @@
 #include "iropt_t.h"
 #include "irprintf.h"
 #include "irprog_t.h"
+#include "loongarch64_bearch_t.h"
 #include "loongarch64_nodes_attr.h"
+#include "obst.h"
 #include "xmalloc.h"
 #include <stdlib.h>
 
+struct obstack loongarch64_opcodes_obst;
+
 void loongarch64_dump_node(FILE *F, const ir_node *n, dump_reason_t reason) {
     switch (reason) {
     case dump_node_opcode_txt:
@@ -42,6 +46,7 @@ void loongarch64_dump_node(FILE *F, const ir_node *n, dump_reason_t reason) {
         break;
 
     case dump_node_info_txt:
+        fprintf(F, "latency = %u\n", get_loongarch64_latency(n));
         break;
     }
 }
@@ -88,4 +93,48 @@ int loongarch64_cond_attrs_equal(const ir_node *a, const ir_node *b) {
     const loongarch64_cond_attr_t *attr_a = get_loongarch64_cond_attr_const(a);
     const loongarch64_cond_attr_t *attr_b = get_loongarch64_cond_attr_const(b);
     return attr_a->cond == attr_b->cond;
-}
\ No newline at end of file
+}
+
+const loongarch64_fcmp_attr_t *get_loongarch64_fcmp_attr_const(const ir_node *node) {
+    assert(is_loongarch64_irn(node) && "need loongarch64 node to get attributes");
+    return (const loongarch64_fcmp_attr_t *)get_irn_generic_attr_const(node);
+}
+
+loongarch64_fcmp_attr_t *get_loongarch64_fcmp_attr(ir_node *node) {
+    assert(is_loongarch64_irn(node) && "need loongarch64 node to get attributes");
+    return (loongarch64_fcmp_attr_t *)get_irn_generic_attr(node);
+}
+
+int loongarch64_fcmp_attrs_equal(const ir_node *a, const ir_node *b) {
+    const loongarch64_fcmp_attr_t *attr_a = get_loongarch64_fcmp_attr_const(a);
+    const loongarch64_fcmp_attr_t *attr_b = get_loongarch64_fcmp_attr_const(b);
+    return attr_a->fcond == attr_b->fcond;
+}
+
+const loongarch64_switch_attr_t *get_loongarch64_switch_attr_const(const ir_node *node) {
+    assert(is_loongarch64_irn(node) && "need loongarch64 node to get attributes");
+    return (const loongarch64_switch_attr_t *)get_irn_generic_attr_const(node);
+}
+
+int loongarch64_switch_attrs_equal(const ir_node *a, const ir_node *b) {
+    const loongarch64_switch_attr_t *attr_a = get_loongarch64_switch_attr_const(a);
+    const loongarch64_switch_attr_t *attr_b = get_loongarch64_switch_attr_const(b);
+    return be_switch_attrs_equal(&attr_a->swtch, &attr_b->swtch);
+}
+
+void loongarch64_init_op(ir_op *op, unsigned latency_la464, unsigned latency_la664) {
+    loongarch64_op_attr_t *attr          = OALLOCZ(&loongarch64_opcodes_obst, loongarch64_op_attr_t);
+    attr->latency[loongarch64_cpu_la464] = latency_la464;
+    attr->latency[loongarch64_cpu_la664] = latency_la664;
+    set_op_attr(op, attr);
+}
+
+unsigned get_loongarch64_op_latency(const ir_op *op) {
+    const loongarch64_op_attr_t *attr = (const loongarch64_op_attr_t *)get_op_attr(op);
+    return attr->latency[loongarch64_cpu];
+}
+
+unsigned get_loongarch64_latency(const ir_node *node) {
+    assert(is_loongarch64_irn(node));
+    return get_loongarch64_op_latency(get_irn_op(node));
+}
@@ -13,4 +13,12 @@
 #include "loongarch64_nodes_attr.h"
 #include "gen_loongarch64_new_nodes.h"
 
+extern struct obstack loongarch64_opcodes_obst;
+
+/** Returns the result latency of @p op on the selected cpu. */
+unsigned get_loongarch64_op_latency(const ir_op *op);
+
+/** Returns the result latency of @p node on the selected cpu. */
+unsigned get_loongarch64_latency(const ir_node *node);
+
 #endif
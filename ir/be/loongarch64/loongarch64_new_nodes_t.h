@@ -22,4 +22,10 @@ int loongarch64_immediate_attrs_equal(const ir_node *a, const ir_node *b);
 
 int loongarch64_cond_attrs_equal(const ir_node *a, const ir_node *b);
 
+int loongarch64_fcmp_attrs_equal(const ir_node *a, const ir_node *b);
+
+int loongarch64_switch_attrs_equal(const ir_node *a, const ir_node *b);
+
+void loongarch64_init_op(ir_op *op, unsigned latency_la464, unsigned latency_la664);
+
 #endif
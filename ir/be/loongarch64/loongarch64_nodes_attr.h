@@ -10,9 +10,22 @@
 #ifndef FIRM_BE_loongarch64_loongarch64_NODES_ATTR_H
 #define FIRM_BE_loongarch64_loongarch64_NODES_ATTR_H
 
+#include "beasm.h"
+#include "benode.h"
 #include "firm_types.h"
 #include "stdint.h"
 
+/** The cores whose instruction latencies are known to the backend. */
+typedef enum loongarch64_cpu_t {
+    loongarch64_cpu_la464,
+    loongarch64_cpu_la664,
+    loongarch64_n_cpus,
+} loongarch64_cpu_t;
+
+typedef struct loongarch64_op_attr_t {
+    unsigned latency[loongarch64_n_cpus];
+} loongarch64_op_attr_t;
+
 typedef struct loongarch64_attr_t {
 } loongarch64_attr_t;
 
@@ -76,4 +89,77 @@ typedef struct loongarch64_cond_attr_t {
 loongarch64_cond_attr_t       *get_loongarch64_cond_attr(ir_node *node);
 const loongarch64_cond_attr_t *get_loongarch64_cond_attr_const(const ir_node *node);
 
+// Conditions of `fcmp`. The `c` prefix denotes quiet compares, the `s` prefix
+// denotes signaling compares which raise an invalid exception on NaN operands.
+typedef enum loongarch64_fcond_t {
+    loongarch64_fcond_caf,
+    loongarch64_fcond_cun,
+    loongarch64_fcond_ceq,
+    loongarch64_fcond_cueq,
+    loongarch64_fcond_clt,
+    loongarch64_fcond_cult,
+    loongarch64_fcond_cle,
+    loongarch64_fcond_cule,
+    loongarch64_fcond_cne,
+    loongarch64_fcond_cor,
+    loongarch64_fcond_cune,
+    loongarch64_fcond_slt,
+    loongarch64_fcond_sle,
+} loongarch64_fcond_t;
+
+static inline char const *loongarch64_fcond_name(loongarch64_fcond_t fcond) {
+    switch (fcond) {
+    case loongarch64_fcond_caf:
+        return "caf";
+    case loongarch64_fcond_cun:
+        return "cun";
+    case loongarch64_fcond_ceq:
+        return "ceq";
+    case loongarch64_fcond_cueq:
+        return "cueq";
+    case loongarch64_fcond_clt:
+        return "clt";
+    case loongarch64_fcond_cult:
+        return "cult";
+    case loongarch64_fcond_cle:
+        return "cle";
+    case loongarch64_fcond_cule:
+        return "cule";
+    case loongarch64_fcond_cne:
+        return "cne";
+    case loongarch64_fcond_cor:
+        return "cor";
+    case loongarch64_fcond_cune:
+        return "cune";
+    case loongarch64_fcond_slt:
+        return "slt";
+    case loongarch64_fcond_sle:
+        return "sle";
+    default:
+        return "invalid";
+    }
+}
+
+typedef struct loongarch64_fcmp_attr_t {
+    loongarch64_attr_t  attr;
+    loongarch64_fcond_t fcond;
+} loongarch64_fcmp_attr_t;
+
+loongarch64_fcmp_attr_t       *get_loongarch64_fcmp_attr(ir_node *node);
+const loongarch64_fcmp_attr_t *get_loongarch64_fcmp_attr_const(const ir_node *node);
+
+typedef struct loongarch64_switch_attr_t {
+    loongarch64_attr_t attr;
+    be_switch_attr_t   swtch;
+} loongarch64_switch_attr_t;
+
+const loongarch64_switch_attr_t *get_loongarch64_switch_attr_const(const ir_node *node);
+
+/** An operand of an inline assembler node, immediates keep their value. */
+typedef struct loongarch64_asm_operand_t {
+    be_asm_operand_t op;
+    ir_entity       *ent;
+    int64_t          val;
+} loongarch64_asm_operand_t;
+
 #endif
@@ -0,0 +1,353 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Peephole optimizations for the loongarch64 backend.
+ */
+#include "loongarch64_optimize.h"
+
+#include "benode.h"
+#include "bepeephole.h"
+#include "besched.h"
+#include "gen_loongarch64_regalloc_if.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "loongarch64_new_nodes.h"
+
+// Bound the backwards search for a store feeding a load.
+#define MAX_FORWARD_DISTANCE 16
+
+/**
+ * Returns whether @p node defines the register @p reg.
+ */
+static bool defines_register(ir_node const *const node, arch_register_t const *const reg) {
+    be_foreach_out(node, o) {
+        if (arch_get_irn_register_out(node, o) == reg)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Returns whether @p reg is redefined by any node scheduled strictly between
+ * @p from and @p to.
+ */
+static bool is_clobbered_between(ir_node const *const from, ir_node const *const to,
+                                 arch_register_t const *const reg) {
+    for (ir_node const *node = sched_next(from); node != to; node = sched_next(node)) {
+        if (defines_register(node, reg))
+            return true;
+    }
+    return false;
+}
+
+bool loongarch64_is_sign_extended(ir_node const *const value, unsigned const bits) {
+    if (is_Proj(value)) {
+        ir_node const *const pred = get_Proj_pred(value);
+        if (!is_loongarch64_irn(pred))
+            return false;
+        switch ((loongarch64_opcodes)get_loongarch64_irn_opcode(pred)) {
+        case iro_loongarch64_ld_b:
+        case iro_loongarch64_ldx_b:
+            return bits >= 8;
+        case iro_loongarch64_ld_bu:
+        case iro_loongarch64_ldx_bu:
+        case iro_loongarch64_ld_h:
+        case iro_loongarch64_ldx_h:
+            return bits >= 16;
+        case iro_loongarch64_ld_hu:
+        case iro_loongarch64_ldx_hu:
+        case iro_loongarch64_ld_w:
+        case iro_loongarch64_ldx_w:
+            return bits >= 32;
+        default:
+            return false;
+        }
+    }
+
+    if (!is_loongarch64_irn(value))
+        return false;
+    switch ((loongarch64_opcodes)get_loongarch64_irn_opcode(value)) {
+    case iro_loongarch64_slt:
+    case iro_loongarch64_sltu:
+    case iro_loongarch64_slti:
+    case iro_loongarch64_sltui:
+    case iro_loongarch64_movcf2gr:
+        return true;
+    case iro_loongarch64_sext_b:
+        return bits >= 8;
+    case iro_loongarch64_sext_h:
+    case iro_loongarch64_zext_b:
+        return bits >= 16;
+    case iro_loongarch64_bstrpick_d:
+        return bits > get_loongarch64_immediate_attr_const(value)->val + 1;
+    case iro_loongarch64_zext_h:
+    case iro_loongarch64_sext_w:
+    // The 32 bit instructions sign extend their result
+    case iro_loongarch64_li_w:
+    case iro_loongarch64_add_w:
+    case iro_loongarch64_addi_w:
+    case iro_loongarch64_alsl_w:
+    case iro_loongarch64_sub_w:
+    case iro_loongarch64_mul_w:
+    case iro_loongarch64_mulh_w:
+    case iro_loongarch64_mulh_wu:
+    case iro_loongarch64_div_w:
+    case iro_loongarch64_div_wu:
+    case iro_loongarch64_mod_w:
+    case iro_loongarch64_mod_wu:
+    case iro_loongarch64_sll_w:
+    case iro_loongarch64_slli_w:
+    case iro_loongarch64_srl_w:
+    case iro_loongarch64_srli_w:
+    case iro_loongarch64_sra_w:
+    case iro_loongarch64_srai_w:
+    case iro_loongarch64_rotr_w:
+    case iro_loongarch64_rotri_w:
+        return bits >= 32;
+    default:
+        return false;
+    }
+}
+
+bool loongarch64_is_zero_extended(ir_node const *const value, unsigned const bits) {
+    if (is_Proj(value)) {
+        ir_node const *const pred = get_Proj_pred(value);
+        if (!is_loongarch64_irn(pred))
+            return false;
+        switch ((loongarch64_opcodes)get_loongarch64_irn_opcode(pred)) {
+        case iro_loongarch64_ld_bu:
+        case iro_loongarch64_ldx_bu:
+            return bits >= 8;
+        case iro_loongarch64_ld_hu:
+        case iro_loongarch64_ldx_hu:
+            return bits >= 16;
+        case iro_loongarch64_ld_wu:
+        case iro_loongarch64_ldx_wu:
+            return bits >= 32;
+        default:
+            return false;
+        }
+    }
+
+    if (!is_loongarch64_irn(value))
+        return false;
+    switch ((loongarch64_opcodes)get_loongarch64_irn_opcode(value)) {
+    case iro_loongarch64_slt:
+    case iro_loongarch64_sltu:
+    case iro_loongarch64_slti:
+    case iro_loongarch64_sltui:
+    case iro_loongarch64_movcf2gr:
+        return true;
+    case iro_loongarch64_zext_b:
+        return bits >= 8;
+    case iro_loongarch64_andi: {
+        // andi zero extends its 12 bit immediate
+        loongarch64_immediate_attr_t const *const imm = get_loongarch64_immediate_attr_const(value);
+        return imm->ent == NULL && bits >= 12;
+    }
+    case iro_loongarch64_zext_h:
+        return bits >= 16;
+    case iro_loongarch64_zext_w:
+        return bits >= 32;
+    case iro_loongarch64_bstrpick_d:
+        return bits > get_loongarch64_immediate_attr_const(value)->val;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Removes @p node if it only reproduces its operand in the same register.
+ */
+static bool remove_if_identity(ir_node *const node) {
+    ir_node *const op = get_irn_n(node, 0);
+    if (arch_get_irn_register(op) != arch_get_irn_register_out(node, 0))
+        return false;
+    be_peephole_exchange(node, op);
+    return true;
+}
+
+static void peephole_be_Copy(ir_node *const node) {
+    if (remove_if_identity(node))
+        return;
+
+    // b = copy a; ...; a = copy b  ->  b = copy a; ...
+    ir_node *const op = be_get_Copy_op(node);
+    if (!be_is_Copy(op) || get_nodes_block(op) != get_nodes_block(node))
+        return;
+    ir_node *const               orig = be_get_Copy_op(op);
+    arch_register_t const *const reg  = arch_get_irn_register(orig);
+    if (reg != arch_get_irn_register_out(node, 0) || is_clobbered_between(op, node, reg))
+        return;
+    be_peephole_exchange(node, orig);
+}
+
+static void peephole_be_IncSP(ir_node *const node) {
+    if (be_peephole_IncSP_IncSP(node))
+        return;
+    if (be_get_IncSP_offset(node) == 0)
+        be_peephole_exchange(node, be_get_IncSP_pred(node));
+}
+
+/**
+ * Removes additions, ors and xors with zero which end up in the register of
+ * their operand.
+ */
+static void peephole_loongarch64_move_imm(ir_node *const node) {
+    loongarch64_immediate_attr_t const *const imm = get_loongarch64_immediate_attr_const(node);
+    if (imm->ent == NULL && imm->val == 0)
+        remove_if_identity(node);
+}
+
+static void peephole_loongarch64_sext(ir_node *const node) {
+    unsigned bits;
+    switch ((loongarch64_opcodes)get_loongarch64_irn_opcode(node)) {
+    case iro_loongarch64_sext_b: bits = 8;  break;
+    case iro_loongarch64_sext_h: bits = 16; break;
+    default:                     bits = 32; break;
+    }
+    if (loongarch64_is_sign_extended(get_irn_n(node, 0), bits))
+        remove_if_identity(node);
+}
+
+static void peephole_loongarch64_zext(ir_node *const node) {
+    unsigned bits;
+    switch ((loongarch64_opcodes)get_loongarch64_irn_opcode(node)) {
+    case iro_loongarch64_zext_b: bits = 8;  break;
+    case iro_loongarch64_zext_h: bits = 16; break;
+    default:                     bits = 32; break;
+    }
+    if (loongarch64_is_zero_extended(get_irn_n(node, 0), bits))
+        remove_if_identity(node);
+}
+
+static bool may_write_memory(ir_node const *const node) {
+    if (!is_loongarch64_irn(node))
+        return be_is_MemPerm(node);
+    switch ((loongarch64_opcodes)get_loongarch64_irn_opcode(node)) {
+    case iro_loongarch64_ld_b:
+    case iro_loongarch64_ld_bu:
+    case iro_loongarch64_ld_h:
+    case iro_loongarch64_ld_hu:
+    case iro_loongarch64_ld_w:
+    case iro_loongarch64_ld_wu:
+    case iro_loongarch64_ld_d:
+    case iro_loongarch64_fld_s:
+    case iro_loongarch64_fld_d:
+    case iro_loongarch64_ldx_b:
+    case iro_loongarch64_ldx_bu:
+    case iro_loongarch64_ldx_h:
+    case iro_loongarch64_ldx_hu:
+    case iro_loongarch64_ldx_w:
+    case iro_loongarch64_ldx_wu:
+    case iro_loongarch64_ldx_d:
+    case iro_loongarch64_fldx_s:
+    case iro_loongarch64_fldx_d:
+        return false;
+    default: {
+        ir_mode *const mode = get_irn_mode(node);
+        return mode == mode_M || mode == mode_T;
+    }
+    }
+}
+
+/*
+ * All loads and stores share the operand layout of ld_d and st_d, so their
+ * inputs and projections are accessed through those.
+ */
+
+/**
+ * Returns the store of the same width as @p load which writes the frame slot
+ * read by @p load, if nothing in between may change the slot or its base.
+ */
+static ir_node *find_forwarding_store(ir_node *const load, ir_op const *const store_op) {
+    ir_node const *const         base     = get_irn_n(load, n_loongarch64_ld_d_base);
+    arch_register_t const *const base_reg = arch_get_irn_register(base);
+    if (base_reg != &loongarch64_registers[REG_SP] && base_reg != &loongarch64_registers[REG_FP])
+        return NULL;
+
+    loongarch64_immediate_attr_t const *const load_imm = get_loongarch64_immediate_attr_const(load);
+    unsigned                                  distance = 0;
+    sched_foreach_reverse_before(load, node) {
+        if (++distance > MAX_FORWARD_DISTANCE)
+            return NULL;
+        if (get_irn_op(node) == store_op) {
+            loongarch64_immediate_attr_t const *const store_imm = get_loongarch64_immediate_attr_const(node);
+            ir_node const *const store_base = get_irn_n(node, n_loongarch64_st_d_base);
+            if (arch_get_irn_register(store_base) == base_reg && store_imm->ent == load_imm->ent &&
+                store_imm->val == load_imm->val)
+                return node;
+        }
+        if (may_write_memory(node) || defines_register(node, base_reg))
+            return NULL;
+    }
+    return NULL;
+}
+
+/**
+ * Replaces a reload from a frame slot by the value just stored there:
+ *
+ *   st.d  a, sp, 8           st.d  a, sp, 8
+ *   ...                ->    ...
+ *   ld.d  b, sp, 8           or    b, a, 0
+ */
+static void peephole_loongarch64_forward_load(ir_node *const node, ir_op const *const store_op) {
+    ir_node *const store = find_forwarding_store(node, store_op);
+    if (store == NULL)
+        return;
+
+    ir_node *const               value     = get_irn_n(store, n_loongarch64_st_d_value);
+    arch_register_t const *const value_reg = arch_get_irn_register(value);
+    if (is_clobbered_between(store, node, value_reg))
+        return;
+
+    ir_node *res = NULL;
+    foreach_out_edge_safe(node, edge) {
+        ir_node *const proj = get_edge_src_irn(edge);
+        if (get_Proj_num(proj) == pn_loongarch64_ld_d_M)
+            exchange(proj, get_irn_n(node, n_loongarch64_ld_d_mem));
+        else
+            res = proj;
+    }
+    if (res == NULL)
+        return;
+
+    arch_register_t const *const res_reg = arch_get_irn_register(res);
+    ir_node *const replacement = res_reg == value_reg ? value : be_new_Copy_before_reg(value, node, res_reg);
+    be_peephole_exchange_using_proj(res, replacement);
+}
+
+static void peephole_loongarch64_ld_d(ir_node *const node) {
+    peephole_loongarch64_forward_load(node, op_loongarch64_st_d);
+}
+
+static void peephole_loongarch64_fld_s(ir_node *const node) {
+    peephole_loongarch64_forward_load(node, op_loongarch64_fst_s);
+}
+
+static void peephole_loongarch64_fld_d(ir_node *const node) {
+    peephole_loongarch64_forward_load(node, op_loongarch64_fst_d);
+}
+
+void loongarch64_peephole_optimization(ir_graph *const irg) {
+    ir_clear_opcodes_generic_func();
+    register_peephole_optimization(op_be_Copy, peephole_be_Copy);
+    register_peephole_optimization(op_be_IncSP, peephole_be_IncSP);
+    register_peephole_optimization(op_loongarch64_addi_d, peephole_loongarch64_move_imm);
+    register_peephole_optimization(op_loongarch64_ori, peephole_loongarch64_move_imm);
+    register_peephole_optimization(op_loongarch64_xori, peephole_loongarch64_move_imm);
+    register_peephole_optimization(op_loongarch64_sext_b, peephole_loongarch64_sext);
+    register_peephole_optimization(op_loongarch64_sext_h, peephole_loongarch64_sext);
+    register_peephole_optimization(op_loongarch64_sext_w, peephole_loongarch64_sext);
+    register_peephole_optimization(op_loongarch64_zext_b, peephole_loongarch64_zext);
+    register_peephole_optimization(op_loongarch64_zext_h, peephole_loongarch64_zext);
+    register_peephole_optimization(op_loongarch64_zext_w, peephole_loongarch64_zext);
+    register_peephole_optimization(op_loongarch64_ld_d, peephole_loongarch64_ld_d);
+    register_peephole_optimization(op_loongarch64_fld_s, peephole_loongarch64_fld_s);
+    register_peephole_optimization(op_loongarch64_fld_d, peephole_loongarch64_fld_d);
+    be_peephole_opt(irg);
+}
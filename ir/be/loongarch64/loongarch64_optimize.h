@@ -0,0 +1,35 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2012 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Peephole optimizations for the loongarch64 backend.
+ */
+#ifndef FIRM_BE_loongarch64_loongarch64_OPTIMIZE_H
+#define FIRM_BE_loongarch64_loongarch64_OPTIMIZE_H
+
+#include <stdbool.h>
+
+#include "firm_types.h"
+
+/**
+ * Returns whether @p value already has its upper bits filled with copies of
+ * bit @p bits - 1.
+ */
+bool loongarch64_is_sign_extended(ir_node const *value, unsigned bits);
+
+/**
+ * Returns whether the bits of @p value above bit @p bits - 1 are all zero.
+ */
+bool loongarch64_is_zero_extended(ir_node const *value, unsigned bits);
+
+/**
+ * Perform peephole optimizations on a graph after register allocation.
+ *
+ * @param irg  the graph
+ */
+void loongarch64_peephole_optimization(ir_graph *irg);
+
+#endif
@@ -2,8 +2,9 @@
 $arch = "loongarch64";
 
 # Modes
-$mode_gp = "mode_Iu";    # mode used by general purpose registers
-$mode_fp = "mode_F";     # mode used by floatingpoint registers
+$mode_gp  = "mode_Iu";    # mode used by general purpose registers
+$mode_fp  = "mode_D";     # mode used by floatingpoint registers
+$mode_fcc = "mode_Bu";    # mode used by condition flag registers
 
 # The node description is done as a perl hash initializer with the
 # following structure:
@@ -33,38 +34,89 @@ $mode_fp = "mode_F";     # mode used by floatingpoint registers
     gp => {
         mode      => $mode_gp,
         registers => [
-            { name => "zero", encoding => 0 },
-            { name => "ra",   encoding => 1 },
-            { name => "tp",   encoding => 2 },
-            { name => "sp",   encoding => 3 },
-            { name => "a0",   encoding => 4 },
-            { name => "a1",   encoding => 5 },
-            { name => "a2",   encoding => 6 },
-            { name => "a3",   encoding => 7 },
-            { name => "a4",   encoding => 8 },
-            { name => "a5",   encoding => 9 },
-            { name => "a6",   encoding => 10 },
-            { name => "a7",   encoding => 11 },
-            { name => "t0",   encoding => 12 },
-            { name => "t1",   encoding => 13 },
-            { name => "t2",   encoding => 14 },
-            { name => "t3",   encoding => 15 },
-            { name => "t4",   encoding => 16 },
-            { name => "t5",   encoding => 17 },
-            { name => "t6",   encoding => 18 },
-            { name => "t7",   encoding => 19 },
-            { name => "t8",   encoding => 20 },
-            { name => "r21",  encoding => 21 },
-            { name => "fp",   encoding => 22 },
-            { name => "s0",   encoding => 23 },
-            { name => "s1",   encoding => 24 },
-            { name => "s2",   encoding => 25 },
-            { name => "s3",   encoding => 26 },
-            { name => "s4",   encoding => 27 },
-            { name => "s5",   encoding => 28 },
-            { name => "s6",   encoding => 29 },
-            { name => "s7",   encoding => 30 },
-            { name => "s8",   encoding => 31 },
+            { name => "zero", encoding => 0,  dwarf => 0 },
+            { name => "ra",   encoding => 1,  dwarf => 1 },
+            { name => "tp",   encoding => 2,  dwarf => 2 },
+            { name => "sp",   encoding => 3,  dwarf => 3 },
+            { name => "a0",   encoding => 4,  dwarf => 4 },
+            { name => "a1",   encoding => 5,  dwarf => 5 },
+            { name => "a2",   encoding => 6,  dwarf => 6 },
+            { name => "a3",   encoding => 7,  dwarf => 7 },
+            { name => "a4",   encoding => 8,  dwarf => 8 },
+            { name => "a5",   encoding => 9,  dwarf => 9 },
+            { name => "a6",   encoding => 10, dwarf => 10 },
+            { name => "a7",   encoding => 11, dwarf => 11 },
+            { name => "t0",   encoding => 12, dwarf => 12 },
+            { name => "t1",   encoding => 13, dwarf => 13 },
+            { name => "t2",   encoding => 14, dwarf => 14 },
+            { name => "t3",   encoding => 15, dwarf => 15 },
+            { name => "t4",   encoding => 16, dwarf => 16 },
+            { name => "t5",   encoding => 17, dwarf => 17 },
+            { name => "t6",   encoding => 18, dwarf => 18 },
+            { name => "t7",   encoding => 19, dwarf => 19 },
+            { name => "t8",   encoding => 20, dwarf => 20 },
+            { name => "r21",  encoding => 21, dwarf => 21 },
+            { name => "fp",   encoding => 22, dwarf => 22 },
+            { name => "s0",   encoding => 23, dwarf => 23 },
+            { name => "s1",   encoding => 24, dwarf => 24 },
+            { name => "s2",   encoding => 25, dwarf => 25 },
+            { name => "s3",   encoding => 26, dwarf => 26 },
+            { name => "s4",   encoding => 27, dwarf => 27 },
+            { name => "s5",   encoding => 28, dwarf => 28 },
+            { name => "s6",   encoding => 29, dwarf => 29 },
+            { name => "s7",   encoding => 30, dwarf => 30 },
+            { name => "s8",   encoding => 31, dwarf => 31 },
+        ]
+    },
+    fp => {
+        mode      => $mode_fp,
+        registers => [
+            { name => "fa0",  encoding => 0,  dwarf => 32 },
+            { name => "fa1",  encoding => 1,  dwarf => 33 },
+            { name => "fa2",  encoding => 2,  dwarf => 34 },
+            { name => "fa3",  encoding => 3,  dwarf => 35 },
+            { name => "fa4",  encoding => 4,  dwarf => 36 },
+            { name => "fa5",  encoding => 5,  dwarf => 37 },
+            { name => "fa6",  encoding => 6,  dwarf => 38 },
+            { name => "fa7",  encoding => 7,  dwarf => 39 },
+            { name => "ft0",  encoding => 8,  dwarf => 40 },
+            { name => "ft1",  encoding => 9,  dwarf => 41 },
+            { name => "ft2",  encoding => 10, dwarf => 42 },
+            { name => "ft3",  encoding => 11, dwarf => 43 },
+            { name => "ft4",  encoding => 12, dwarf => 44 },
+            { name => "ft5",  encoding => 13, dwarf => 45 },
+            { name => "ft6",  encoding => 14, dwarf => 46 },
+            { name => "ft7",  encoding => 15, dwarf => 47 },
+            { name => "ft8",  encoding => 16, dwarf => 48 },
+            { name => "ft9",  encoding => 17, dwarf => 49 },
+            { name => "ft10", encoding => 18, dwarf => 50 },
+            { name => "ft11", encoding => 19, dwarf => 51 },
+            { name => "ft12", encoding => 20, dwarf => 52 },
+            { name => "ft13", encoding => 21, dwarf => 53 },
+            { name => "ft14", encoding => 22, dwarf => 54 },
+            { name => "ft15", encoding => 23, dwarf => 55 },
+            { name => "fs0",  encoding => 24, dwarf => 56 },
+            { name => "fs1",  encoding => 25, dwarf => 57 },
+            { name => "fs2",  encoding => 26, dwarf => 58 },
+            { name => "fs3",  encoding => 27, dwarf => 59 },
+            { name => "fs4",  encoding => 28, dwarf => 60 },
+            { name => "fs5",  encoding => 29, dwarf => 61 },
+            { name => "fs6",  encoding => 30, dwarf => 62 },
+            { name => "fs7",  encoding => 31, dwarf => 63 },
+        ]
+    },
+    fcc => {
+        flags     => "manual_ra",
+        mode      => $mode_fcc,
+        registers => [
+            { name => "fcc0", encoding => 0 },
+            { name => "fcc1", encoding => 1 },
+            { name => "fcc2", encoding => 2 },
+            { name => "fcc3", encoding => 3 },
+            { name => "fcc4", encoding => 4 },
+            { name => "fcc5", encoding => 5 },
+            { name => "fcc6", encoding => 6 },
+            { name => "fcc7", encoding => 7 },
         ]
     },
 );
@@ -73,6 +125,8 @@ $mode_fp = "mode_F";     # mode used by floatingpoint registers
     loongarch64_attr_t           => "",
     loongarch64_immediate_attr_t => "attr->ent = ent;\n\tattr->val = val;",
     loongarch64_cond_attr_t      => "attr->cond = cond;",
+    loongarch64_fcmp_attr_t      => "attr->fcond = fcond;",
+    loongarch64_switch_attr_t    => "be_switch_attr_init(res, &attr->swtch, table, table_entity);",
 );
 
 my $callOp = {
@@ -92,18 +146,21 @@ my $callOp = {
         in_reqs   => ["gp"],
         out_reqs  => ["gp"],
         emit      => "bstrpick.d %D0, %S0, 7, 0",
+        encode    => "loongarch64_enc_bstrpick_d(node, 7, 0)",
     },
     zext_h => {
         irn_flags => ["rematerializable"],
         in_reqs   => ["gp"],
         out_reqs  => ["gp"],
         emit      => "bstrpick.d %D0, %S0, 15, 0",
+        encode    => "loongarch64_enc_bstrpick_d(node, 15, 0)",
     },
     zext_w => {
         irn_flags => ["rematerializable"],
         in_reqs   => ["gp"],
         out_reqs  => ["gp"],
         emit      => "bstrpick.d %D0, %S0, 31, 0",
+        encode    => "loongarch64_enc_bstrpick_d(node, 31, 0)",
     },
 
     # Signed Extend
@@ -112,28 +169,33 @@ my $callOp = {
         in_reqs   => ["gp"],
         out_reqs  => ["gp"],
         emit      => "ext.w.b %D0, %S0",
+        encode    => "loongarch64_enc_2r(node, 0x00005C00)",
     },
     sext_h => {
         irn_flags => ["rematerializable"],
         in_reqs   => ["gp"],
         out_reqs  => ["gp"],
         emit      => "ext.w.h %D0, %S0",
+        encode    => "loongarch64_enc_2r(node, 0x00005800)",
     },
     sext_w => {
         irn_flags => ["rematerializable"],
         in_reqs   => ["gp"],
         out_reqs  => ["gp"],
         emit      => "slli.w %D0, %S0, 0",
+        encode    => "loongarch64_enc_2r(node, 0x00408000)",
     },
 
     # Load Immediate
+    # Emitted as the shortest addi.w/ori/lu12i.w/lu32i.d/lu52i.d sequence.
+    # As they have no operands, the register allocator recomputes them
+    # instead of spilling.
     li_w => {
         irn_flags => ["rematerializable"],
         in_reqs   => [],
         out_reqs  => ["gp"],
         attr_type => "loongarch64_immediate_attr_t",
         attr      => "ir_entity *const ent, int64_t val",
-        emit      => "li.w %D0, %I",
     },
     li_d => {
         irn_flags => ["rematerializable"],
@@ -141,7 +203,6 @@ my $callOp = {
         out_reqs  => ["gp"],
         attr_type => "loongarch64_immediate_attr_t",
         attr      => "ir_entity *const ent, int64_t val",
-        emit      => "li.d %D0, %I",
     },
 
     # Return
@@ -152,6 +213,7 @@ my $callOp = {
         out_reqs => ["exec"],
         ins      => [ "mem", "stack", "addr", "first_result" ],
         emit     => "jr %S2",
+        encode   => "loongarch64_enc_jirl(node, 0, n_loongarch64_return_addr)",
     },
 
     # Call
@@ -159,11 +221,54 @@ my $callOp = {
         template  => $callOp,
         attr_type => "loongarch64_immediate_attr_t",
         attr      => "ir_entity *const ent, int64_t val",
-        emit      => "bl %I\n",
+        emit      => "bl %P\n",
     },
     call_pointer => {
         template => $callOp,
-        emit     => "jirl $r1, %S2, 0\n",
+        emit     => "jirl \$ra, %S2, 0\n",
+        encode   => "loongarch64_enc_jirl(node, 1, 2)",
+    },
+
+    # Tail calls leave the function like return, the callee returns to our
+    # caller through the unchanged $ra.
+    tail_call => {
+        state     => "pinned",
+        op_flags  => ["cfopcode"],
+        in_reqs   => "...",
+        out_reqs  => ["exec"],
+        ins       => [ "mem", "stack", "addr", "first_argument" ],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "b %P",
+    },
+    tail_call_pointer => {
+        state    => "pinned",
+        op_flags => ["cfopcode"],
+        in_reqs  => "...",
+        out_reqs => ["exec"],
+        ins      => [ "mem", "stack", "addr", "target", "first_argument" ],
+        emit     => "jr %S3",
+        encode   => "loongarch64_enc_jirl(node, 0, n_loongarch64_tail_call_pointer_target)",
+    },
+
+    # Bit-string pick: %D0 = zero extended %S0[%I:0]
+    bstrpick_d => {
+        irn_flags => ["rematerializable"],
+        in_reqs   => ["gp"],
+        out_reqs  => ["gp"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "bstrpick.d %D0, %S0, %I, 0",
+        encode    => "loongarch64_enc_bstrpick_d(node, get_loongarch64_immediate_attr_const(node)->val, 0)",
+    },
+
+    # Load the 4 KiB page of a global entity, see %A for the low 12 bits
+    pcalau12i => {
+        irn_flags => ["rematerializable"],
+        out_reqs  => ["gp"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "pcalau12i %D0, %%pc_hi20(%I)",
     },
 
     # Load Address
@@ -175,6 +280,56 @@ my $callOp = {
         emit      => "la.local %D0, %I",
     },
 
+    # Load the address of a preemptible global from its GOT entry
+    load_got => {
+        irn_flags => ["rematerializable"],
+        out_reqs  => ["gp"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "pcalau12i %D0, %%got_pc_hi20(%I)\n".
+                     "ld.d %D0, %D0, %%got_pc_lo12(%I)",
+    },
+
+    # Thread pointer relative address of a thread-local entity in the
+    # executable, local-exec model. The thread pointer is always available,
+    # so it is rematerialized rather than spilled.
+    tls_le => {
+        irn_flags => ["rematerializable"],
+        latency   => 3,
+        in_reqs   => ["gp"],
+        out_reqs  => ["gp"],
+        ins       => ["tp"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "lu12i.w %D0, %%le_hi20(%I)\n".
+                     "ori %D0, %D0, %%le_lo12(%I)\n".
+                     "add.d %D0, %D0, %S0",
+    },
+
+    # Offset of a thread-local entity from the thread pointer, loaded from the
+    # GOT, initial-exec model
+    tls_ie => {
+        in_reqs   => ["gp"],
+        out_reqs  => ["gp"],
+        ins       => ["tp"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "pcalau12i %D0, %%ie_pc_hi20(%I)\n".
+                     "ld.d %D0, %D0, %%ie_pc_lo12(%I)\n".
+                     "add.d %D0, %D0, %S0",
+    },
+
+    # Address of the GOT entry of a thread-local entity, the argument of
+    # __tls_get_addr in the general-dynamic model
+    tls_gd => {
+        irn_flags => ["rematerializable"],
+        out_reqs  => ["gp"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "pcalau12i %D0, %%gd_pc_hi20(%I)\n".
+                     "addi.d %D0, %D0, %%got_pc_lo12(%I)",
+    },
+
     # Branch
     b => {
         state     => "pinned",
@@ -194,20 +349,158 @@ my $callOp = {
         attr      => "loongarch64_cond_t const cond",
     },
 
-    # Mux
-    # Node: need to copy %S1 because %S1 is changed
-    mux => {
+    # Jump table, scaled index
+    # %D0 = (%S0 << %I) + %S1
+    alsl_w => {
         irn_flags => ["rematerializable"],
-        in_reqs   => [ "gp",  "gp",    "gp" ],
-        ins       => [ "sel", "f_val", "t_val" ],
+        in_reqs   => [ "gp", "gp" ],
         out_reqs  => ["gp"],
-        emit      =>
-          "maskeqz %S1, %S1, %S0\n"   # if(%S0 == 0) %S1 = %S1 else %S1 = 0
-          . "masknez %D0, %S2, %S0\n" # if(%S0 == 0) %D0 = 0   else %D0 = %S2
-          . "or      %D0, %D0, %S1",  # %D0 = %D0 | %S1
-    }
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "alsl.w %D0, %S0, %S1, %I",
+        encode    => "loongarch64_enc_alsl(node, 0x00040000)",
+    },
+    alsl_d => {
+        irn_flags => ["rematerializable"],
+        in_reqs   => [ "gp", "gp" ],
+        out_reqs  => ["gp"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "alsl.d %D0, %S0, %S1, %I",
+        encode    => "loongarch64_enc_alsl(node, 0x002C0000)",
+    },
+    switch => {
+        state     => "pinned",
+        op_flags  => [ "cfopcode", "forking" ],
+        in_reqs   => ["gp"],
+        out_reqs  => "...",
+        attr_type => "loongarch64_switch_attr_t",
+        attr      => "ir_switch_table const *const table, ir_entity *const table_entity",
+    },
+
+    # Float-point compare and branch
+    b_fcc => {
+        state     => "pinned",
+        irn_flags => ["fallthrough"],
+        op_flags  => [ "cfopcode", "forking" ],
+        in_reqs   => ["fcc"],
+        ins       => ["flags"],
+        out_reqs  => [ "exec",  "exec" ],
+        outs      => [ "false", "true" ],
+    },
+    movcf2gr => {
+        in_reqs   => ["fcc"],
+        out_reqs  => ["gp"],
+        emit      => "movcf2gr %D0, %S0",
+        encode    => "loongarch64_enc_2r(node, 0x0114DC00)",
+    },
+    movgr2cf => {
+        irn_flags => [ "rematerializable", "modify_flags" ],
+        in_reqs   => ["gp"],
+        out_reqs  => ["fcc"],
+        emit      => "movgr2cf %D0, %S0",
+        encode    => "loongarch64_enc_2r(node, 0x0114D800)",
+    },
+
+    # Copy %I bytes from %S2 to %S1 with LSX/LASX loads and stores. The
+    # vector registers overlay the float-point registers, so the scratch
+    # register is allocated in that class.
+    vcopy => {
+        state     => "exc_pinned",
+        in_reqs   => [ "mem", "gp",  "gp" ],
+        ins       => [ "mem", "dst", "src" ],
+        out_reqs  => [ "mem", "cls-fp" ],
+        outs      => [ "M",   "scratch" ],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+    },
+
+    # Raise a breakpoint exception with code %I
+    break => {
+        state     => "pinned",
+        in_reqs   => ["mem"],
+        out_reqs  => ["mem"],
+        ins       => ["mem"],
+        outs      => ["M"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "break %I",
+        encode    => "loongarch64_enc_code(node, 0x002A0000)",
+    },
+
+    # Float-point select: %D0 = %S2 ? %S1 : %S0
+    fsel => {
+        in_reqs   => [ "cls-fp", "cls-fp", "fcc" ],
+        ins       => [ "f_val",  "t_val",  "flags" ],
+        out_reqs  => ["cls-fp"],
+        emit      => "fsel %D0, %S0, %S1, %S2",
+        encode    => "loongarch64_enc_4r(node, 0x0D000000)",
+    },
+);
+
+# Opcodes of the generated instructions, without their operand fields
+my %opcodes = (
+    "add.w"       => 0x00100000, "add.d"       => 0x00108000, "sub.w"       => 0x00110000,
+    "sub.d"       => 0x00118000, "mul.w"       => 0x001C0000, "mul.d"       => 0x001D8000,
+    "mulh.w"      => 0x001C8000, "mulh.wu"     => 0x001D0000, "mulh.d"      => 0x001E0000,
+    "mulh.du"     => 0x001E8000, "div.w"       => 0x00200000, "div.wu"      => 0x00210000,
+    "div.d"       => 0x00220000, "div.du"      => 0x00230000, "mod.w"       => 0x00208000,
+    "mod.wu"      => 0x00218000, "mod.d"       => 0x00228000, "mod.du"      => 0x00238000,
+    "sll.w"       => 0x00170000, "sll.d"       => 0x00188000, "srl.w"       => 0x00178000,
+    "srl.d"       => 0x00190000, "sra.w"       => 0x00180000, "sra.d"       => 0x00198000,
+    "rotr.w"      => 0x001B0000, "rotr.d"      => 0x001B8000, "and"         => 0x00148000,
+    "or"          => 0x00150000, "nor"         => 0x00140000, "xor"         => 0x00158000,
+    "andn"        => 0x00168000, "orn"         => 0x00160000, "slt"         => 0x00120000,
+    "sltu"        => 0x00128000, "addi.w"      => 0x02800000, "addi.d"      => 0x02C00000,
+    "slli.w"      => 0x00408000, "slli.d"      => 0x00410000, "srli.w"      => 0x00448000,
+    "srli.d"      => 0x00450000, "srai.w"      => 0x00488000, "srai.d"      => 0x00490000,
+    "rotri.w"     => 0x004C8000, "rotri.d"     => 0x004D0000, "addu16i.d"   => 0x10000000,
+    "andi"        => 0x03400000, "ori"         => 0x03800000, "xori"        => 0x03C00000,
+    "slti"        => 0x02000000, "sltui"       => 0x02400000, "ld.b"        => 0x28000000,
+    "ld.h"        => 0x28400000, "ld.bu"       => 0x2A000000, "ld.hu"       => 0x2A400000,
+    "ld.wu"       => 0x2A800000, "st.b"        => 0x29000000, "st.h"        => 0x29400000,
+    "ldx.b"       => 0x38000000, "ldx.h"       => 0x38040000, "ldx.w"       => 0x38080000,
+    "ldx.d"       => 0x380C0000, "ldx.bu"      => 0x38200000, "ldx.hu"      => 0x38240000,
+    "ldx.wu"      => 0x38280000, "stx.b"       => 0x38100000, "stx.h"       => 0x38140000,
+    "stx.w"       => 0x38180000, "stx.d"       => 0x381C0000, "fadd.s"      => 0x01008000,
+    "fadd.d"      => 0x01010000, "fsub.s"      => 0x01028000, "fsub.d"      => 0x01030000,
+    "fmul.s"      => 0x01048000, "fmul.d"      => 0x01050000, "fdiv.s"      => 0x01068000,
+    "fdiv.d"      => 0x01070000, "fmax.s"      => 0x01088000, "fmax.d"      => 0x01090000,
+    "fmin.s"      => 0x010A8000, "fmin.d"      => 0x010B0000, "fabs.s"      => 0x01140400,
+    "fabs.d"      => 0x01140800, "fneg.s"      => 0x01141400, "fneg.d"      => 0x01141800,
+    "fsqrt.s"     => 0x01144400, "fsqrt.d"     => 0x01144800, "fmadd.s"     => 0x08100000,
+    "fmadd.d"     => 0x08200000, "fmsub.s"     => 0x08500000, "fmsub.d"     => 0x08600000,
+    "fnmadd.s"    => 0x08900000, "fnmadd.d"    => 0x08A00000, "fnmsub.s"    => 0x08D00000,
+    "fnmsub.d"    => 0x08E00000, "fcmp.s"      => 0x0C100000, "fcmp.d"      => 0x0C200000,
+    "ffint.s.w"   => 0x011D1000, "ffint.s.l"   => 0x011D1800, "ffint.d.w"   => 0x011D2000,
+    "ffint.d.l"   => 0x011D2800, "ftintrz.w.s" => 0x011A8400, "ftintrz.w.d" => 0x011A8800,
+    "ftintrz.l.s" => 0x011AA400, "ftintrz.l.d" => 0x011AA800, "fcvt.s.d"    => 0x01191800,
+    "fcvt.d.s"    => 0x01192400, "movgr2fr.w"  => 0x0114A400, "movgr2fr.d"  => 0x0114A800,
+    "movfr2gr.s"  => 0x0114B400, "movfr2gr.d"  => 0x0114B800, "fld.s"       => 0x2B000000,
+    "fld.d"       => 0x2B800000, "fst.s"       => 0x2B400000, "fst.d"       => 0x2BC00000,
+    "fldx.s"      => 0x38300000, "fldx.d"      => 0x38340000, "fstx.s"      => 0x38380000,
+    "fstx.d"      => 0x383C0000, "maskeqz"     => 0x00130000, "masknez"     => 0x00138000,
+    "clz.w"       => 0x00001400, "clz.d"       => 0x00002400, "ctz.w"       => 0x00001C00,
+    "ctz.d"       => 0x00002C00, "revb.2h"     => 0x00003000, "revb.d"      => 0x00003C00,
+    "preld"       => 0x2AC00000, "vpcnt.w"     => 0x729C2800, "vpcnt.d"     => 0x729C2C00,
 );
 
+# Returns the encoder call for the instruction @p mnemonic in format @p format
+sub encode {
+    my ( $format, $mnemonic, @args ) = @_;
+    die("no opcode for $mnemonic") unless defined( $opcodes{$mnemonic} );
+    return sprintf( "loongarch64_enc_%s(node, 0x%08X%s)", $format, $opcodes{$mnemonic}, join( "", map { ", $_" } @args ) );
+}
+
+# Width of the immediate field of the instructions with a constant operand
+sub immediate_bits {
+    my $mnemonic = shift;
+    return 5  if $mnemonic =~ /^(sl|sr|rot)\w+i\.w$/;
+    return 6  if $mnemonic =~ /^(sl|sr|rot)\w+i\.d$/;
+    return 16 if $mnemonic eq "addu16i.d";
+    return 12;
+}
+
 # Generate instructions with post-fix
 
 my @rr_op_wd = ( "add", "sub", "mul", "sll", "srl", "sra", "rotr", );
@@ -216,10 +509,12 @@ my @rc_op_wd = ( "addi", "slli", "srli", "srai", "rotri", );
 
 my @rr_op_wdu = ( "mulh", "div", "mod", );
 
-my @rr_op = ( "and", "or", "nor", "xor", "andn", "orn", "slt", "sltu" );
+my @rr_op = ( "and", "or", "nor", "xor", "andn", "orn", "slt", "sltu", "maskeqz", "masknez" );
 
 my @rc_op = ( "andi", "ori", "xori", "slti", "sltui" );
 
+my @r_op = ( "clz.w", "clz.d", "ctz.w", "ctz.d", "revb.2h", "revb.d" );
+
 sub add_rr_op_with_postfix {
     my $op      = shift;
     my $postfix = shift;
@@ -228,6 +523,7 @@ sub add_rr_op_with_postfix {
         in_reqs   => [ "gp", "gp" ],
         out_reqs  => ["gp"],
         emit      => "${op}.${postfix} %D0, %S0, %S1",
+        encode    => encode( "3r", "${op}.${postfix}" ),
     };
 }
 
@@ -253,6 +549,7 @@ sub add_rc_op_with_postfix {
         attr_type => "loongarch64_immediate_attr_t",
         attr      => "ir_entity *const ent, int64_t val",
         emit      => "${op}.${postfix} %D0, %S0, %I",
+        encode    => encode( "2ri", "${op}.${postfix}", immediate_bits("${op}.${postfix}") ),
     };
 }
 
@@ -270,6 +567,7 @@ sub add_rr_op {
         in_reqs   => [ "gp", "gp" ],
         out_reqs  => ["gp"],
         emit      => "${op} %D0, %S0, %S1",
+        encode    => encode( "3r", $op ),
     };
 }
 
@@ -286,6 +584,7 @@ sub add_rc_op {
         attr_type => "loongarch64_immediate_attr_t",
         attr      => "ir_entity *const ent, int64_t val",
         emit      => "${op} %D0, %S0, %I",
+        encode    => encode( "2ri", $op, immediate_bits($op) ),
     };
 }
 
@@ -293,7 +592,21 @@ for my $op (@rc_op) {
     add_rc_op($op);
 }
 
+for my $op (@r_op) {
+    ( my $name = $op ) =~ tr/./_/;
+    $nodes{$name} = {
+        irn_flags => ["rematerializable"],
+        in_reqs   => ["gp"],
+        out_reqs  => ["gp"],
+        emit      => "${op} %D0, %S0",
+        encode    => encode( "2r", $op ),
+    };
+}
+
 # Load/Store
+# %A is the offset, or %pc_lo12 of a global entity whose page is in base. The
+# word and double word forms are emitted as ldptr/stptr if the offset only
+# fits their scaled 14 bit immediate.
 for my $postfix ( "b", "h", "w", "d", "bu", "wu", "hu" ) {
     $nodes{"ld_${postfix}"} = {
         state     => "exc_pinned",
@@ -303,7 +616,19 @@ for my $postfix ( "b", "h", "w", "d", "bu", "wu", "hu" ) {
         outs      => [ "M",   "res" ],
         attr_type => "loongarch64_immediate_attr_t",
         attr      => "ir_entity *const ent, int64_t val",
-        emit      => "ld.${postfix} %D1, %S1, %I",
+    };
+    unless ( $postfix eq "w" || $postfix eq "d" ) {
+        $nodes{"ld_${postfix}"}{emit}   = "ld.${postfix} %D1, %S1, %A";
+        $nodes{"ld_${postfix}"}{encode} = encode( "load", "ld.${postfix}" );
+    }
+    $nodes{"ldx_${postfix}"} = {
+        state     => "exc_pinned",
+        in_reqs   => [ "mem", "gp",   "gp" ],
+        out_reqs  => [ "mem", "gp" ],
+        ins       => [ "mem", "base", "index" ],
+        outs      => [ "M",   "res" ],
+        emit      => "ldx.${postfix} %D1, %S1, %S2",
+        encode    => encode( "loadx", "ldx.${postfix}" ),
     };
 }
 for my $postfix ( "b", "h", "w", "d" ) {
@@ -315,8 +640,269 @@ for my $postfix ( "b", "h", "w", "d" ) {
         outs      => ["M"],
         attr_type => "loongarch64_immediate_attr_t",
         attr      => "ir_entity *const ent, int64_t val",
-        emit      => "st.${postfix} %S2, %S1, %I",
     };
+    unless ( $postfix eq "w" || $postfix eq "d" ) {
+        $nodes{"st_${postfix}"}{emit}   = "st.${postfix} %S2, %S1, %A";
+        $nodes{"st_${postfix}"}{encode} = encode( "store", "st.${postfix}" );
+    }
+    $nodes{"stx_${postfix}"} = {
+        state     => "exc_pinned",
+        in_reqs   => [ "mem", "gp",   "gp",    "gp" ],
+        out_reqs  => ["mem"],
+        ins       => [ "mem", "base", "index", "value" ],
+        outs      => ["M"],
+        emit      => "stx.${postfix} %S3, %S1, %S2",
+        encode    => encode( "storex", "stx.${postfix}" ),
+    };
+}
+
+# Prefetch into the L1 cache for loads (hint 0) or stores (hint 8)
+for my $prefetch ( [ "load", 0 ], [ "store", 8 ] ) {
+    my ( $access, $hint ) = @$prefetch;
+    $nodes{"preld_${access}"} = {
+        state     => "exc_pinned",
+        in_reqs   => [ "mem", "gp" ],
+        out_reqs  => ["mem"],
+        ins       => [ "mem", "base" ],
+        outs      => ["M"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "preld ${hint}, %S1, %A",
+        encode    => encode( "preld", "preld", $hint ),
+    };
+}
+
+# Compare and swap: %D1 = *%S1, if it equals %S2 store %S3. The ll/sc loop
+# is a single node, so no spill code can clear the reservation, and ends with
+# a full barrier.
+for my $postfix ( "w", "d" ) {
+    $nodes{"cas_${postfix}"} = {
+        state    => "exc_pinned",
+        in_reqs  => [ "mem", "gp",  "gp",  "gp" ],
+        ins      => [ "mem", "ptr", "old", "new" ],
+        out_reqs => [ "mem", "!in_r1 !in_r2 !in_r3", "!in_r1 !in_r2 !in_r3" ],
+        outs     => [ "M",   "res", "scratch" ],
+    };
+}
+
+# Float-point instructions
+
+my @fp_rr_op = ( "fadd", "fsub", "fmul", "fdiv", "fmax", "fmin" );
+
+my @fp_r_op = ( "fabs", "fneg", "fsqrt" );
+
+my @fp_rrr_op = ( "fmadd", "fmsub", "fnmadd", "fnmsub" );
+
+# Conversions between float-point formats: ffint (int -> float),
+# ftintrz (float -> int, round towards zero) and fcvt (float -> float).
+my @fp_cvt_op = (
+    [ "ffint",   "s", "w" ], [ "ffint",   "s", "l" ], [ "ffint",   "d", "w" ], [ "ffint", "d", "l" ],
+    [ "ftintrz", "w", "s" ], [ "ftintrz", "w", "d" ], [ "ftintrz", "l", "s" ], [ "ftintrz", "l", "d" ],
+    [ "fcvt",    "s", "d" ], [ "fcvt",    "d", "s" ],
+);
+
+for my $postfix ( "s", "d" ) {
+    for my $op (@fp_rr_op) {
+        $nodes{"${op}_${postfix}"} = {
+            irn_flags => ["rematerializable"],
+            in_reqs   => [ "cls-fp", "cls-fp" ],
+            out_reqs  => ["cls-fp"],
+            emit      => "${op}.${postfix} %D0, %S0, %S1",
+            encode    => encode( "3r", "${op}.${postfix}" ),
+        };
+    }
+    for my $op (@fp_r_op) {
+        $nodes{"${op}_${postfix}"} = {
+            irn_flags => ["rematerializable"],
+            in_reqs   => ["cls-fp"],
+            out_reqs  => ["cls-fp"],
+            emit      => "${op}.${postfix} %D0, %S0",
+            encode    => encode( "2r", "${op}.${postfix}" ),
+        };
+    }
+    # %D0 = (%S0 * %S1) +/- %S2, optionally negated
+    for my $op (@fp_rrr_op) {
+        $nodes{"${op}_${postfix}"} = {
+            irn_flags => ["rematerializable"],
+            in_reqs   => [ "cls-fp", "cls-fp", "cls-fp" ],
+            out_reqs  => ["cls-fp"],
+            emit      => "${op}.${postfix} %D0, %S0, %S1, %S2",
+            encode    => encode( "4r", "${op}.${postfix}" ),
+        };
+    }
+    $nodes{"fcmp_${postfix}"} = {
+        irn_flags => [ "rematerializable", "modify_flags" ],
+        in_reqs   => [ "cls-fp", "cls-fp" ],
+        out_reqs  => ["fcc"],
+        attr_type => "loongarch64_fcmp_attr_t",
+        attr      => "loongarch64_fcond_t const fcond",
+        emit      => "fcmp.%C.${postfix} %D0, %S0, %S1",
+        encode    => encode( "fcmp", "fcmp.${postfix}" ),
+    };
+}
+
+for my $cvt (@fp_cvt_op) {
+    my ( $op, $to, $from ) = @$cvt;
+    $nodes{"${op}_${to}_${from}"} = {
+        irn_flags => ["rematerializable"],
+        in_reqs   => ["cls-fp"],
+        out_reqs  => ["cls-fp"],
+        emit      => "${op}.${to}.${from} %D0, %S0",
+        encode    => encode( "2r", "${op}.${to}.${from}" ),
+    };
+}
+
+# Moves between general purpose and float-point registers
+for my $postfix ( "w", "d" ) {
+    $nodes{"movgr2fr_${postfix}"} = {
+        irn_flags => ["rematerializable"],
+        in_reqs   => ["gp"],
+        out_reqs  => ["cls-fp"],
+        emit      => "movgr2fr.${postfix} %D0, %S0",
+        encode    => encode( "2r", "movgr2fr.${postfix}" ),
+    };
+}
+for my $postfix ( "s", "d" ) {
+    $nodes{"movfr2gr_${postfix}"} = {
+        irn_flags => ["rematerializable"],
+        in_reqs   => ["cls-fp"],
+        out_reqs  => ["gp"],
+        emit      => "movfr2gr.${postfix} %D0, %S0",
+        encode    => encode( "2r", "movfr2gr.${postfix}" ),
+    };
+}
+
+# LSX population count of the lowest vector element, the vector registers
+# overlay the float-point registers
+for my $postfix ( "w", "d" ) {
+    $nodes{"vpcnt_${postfix}"} = {
+        irn_flags => ["rematerializable"],
+        in_reqs   => ["cls-fp"],
+        out_reqs  => ["cls-fp"],
+        emit      => "vpcnt.${postfix} %VD0, %VS0",
+        encode    => encode( "2r", "vpcnt.${postfix}" ),
+    };
+}
+
+# Float-point Load/Store
+for my $postfix ( "s", "d" ) {
+    $nodes{"fld_${postfix}"} = {
+        state     => "exc_pinned",
+        in_reqs   => [ "mem", "gp" ],
+        out_reqs  => [ "mem", "cls-fp" ],
+        ins       => [ "mem", "base" ],
+        outs      => [ "M",   "res" ],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "fld.${postfix} %D1, %S1, %A",
+        encode    => encode( "load", "fld.${postfix}" ),
+    };
+    $nodes{"fldx_${postfix}"} = {
+        state     => "exc_pinned",
+        in_reqs   => [ "mem", "gp",   "gp" ],
+        out_reqs  => [ "mem", "cls-fp" ],
+        ins       => [ "mem", "base", "index" ],
+        outs      => [ "M",   "res" ],
+        emit      => "fldx.${postfix} %D1, %S1, %S2",
+        encode    => encode( "loadx", "fldx.${postfix}" ),
+    };
+    $nodes{"fst_${postfix}"} = {
+        state     => "exc_pinned",
+        in_reqs   => [ "mem", "gp", "cls-fp" ],
+        out_reqs  => ["mem"],
+        ins       => [ "mem", "base", "value" ],
+        outs      => ["M"],
+        attr_type => "loongarch64_immediate_attr_t",
+        attr      => "ir_entity *const ent, int64_t val",
+        emit      => "fst.${postfix} %S2, %S1, %A",
+        encode    => encode( "store", "fst.${postfix}" ),
+    };
+    $nodes{"fstx_${postfix}"} = {
+        state     => "exc_pinned",
+        in_reqs   => [ "mem", "gp",   "gp",    "cls-fp" ],
+        out_reqs  => ["mem"],
+        ins       => [ "mem", "base", "index", "value" ],
+        outs      => ["M"],
+        emit      => "fstx.${postfix} %S3, %S1, %S2",
+        encode    => encode( "storex", "fstx.${postfix}" ),
+    };
+}
+
+# Instruction latencies
+#
+# Every node gets its result latency (in cycles) on each supported core,
+# either from an explicit "latency" entry or from the cost class its name
+# matches below. The values follow the LA464 (3A5000) and LA664 (3A6000)
+# optimisation manuals; the dividers are not pipelined, so their latency is
+# also their issue interval.
+
+# cost class => [ LA464, LA664 ]
+my %cost_classes = (
+    alu     => [ 1,  1 ],
+    mul     => [ 4,  4 ],
+    div_w   => [ 11, 9 ],
+    div_d   => [ 18, 13 ],
+    load    => [ 4,  4 ],
+    store   => [ 1,  1 ],
+    fload   => [ 5,  5 ],
+    fmov    => [ 2,  2 ],
+    fadd    => [ 4,  3 ],
+    fmul    => [ 4,  4 ],
+    fma     => [ 5,  4 ],
+    fdiv_s  => [ 12, 9 ],
+    fdiv_d  => [ 19, 14 ],
+    fsqrt_s => [ 15, 11 ],
+    fsqrt_d => [ 22, 18 ],
+    fcvt    => [ 4,  4 ],
+    fcmp    => [ 2,  2 ],
+    gr2fr   => [ 2,  1 ],
+    fr2gr   => [ 2,  1 ],
+);
+
+# first match wins, everything else is a simple integer operation
+my @cost_patterns = (
+    [ qr/^mulh?_/,                     "mul" ],
+    [ qr/^(div|mod)_wu?$/,             "div_w" ],
+    [ qr/^(div|mod)_du?$/,             "div_d" ],
+    [ qr/^ldx?_/,                      "load" ],
+    [ qr/^(f?stx?_|vcopy)/,            "store" ],
+    [ qr/^fldx?_/,                     "fload" ],
+    [ qr/^(fabs|fneg|fsel)/,           "fmov" ],
+    [ qr/^f(add|sub|max|min)_/,        "fadd" ],
+    [ qr/^fmul_/,                      "fmul" ],
+    [ qr/^f(n?madd|n?msub)_/,          "fma" ],
+    [ qr/^fdiv_s$/,                    "fdiv_s" ],
+    [ qr/^fdiv_d$/,                    "fdiv_d" ],
+    [ qr/^fsqrt_s$/,                   "fsqrt_s" ],
+    [ qr/^fsqrt_d$/,                   "fsqrt_d" ],
+    [ qr/^(ffint|ftintrz|fcvt)_/,      "fcvt" ],
+    [ qr/^fcmp_/,                      "fcmp" ],
+    [ qr/^(movgr2fr|movgr2cf)/,        "gr2fr" ],
+    [ qr/^(movfr2gr|movcf2gr)/,        "fr2gr" ],
+);
+
+foreach my $op ( keys(%nodes) ) {
+    my $node    = $nodes{$op};
+    my @latency = ( $cost_classes{alu}[0], $cost_classes{alu}[1] );
+    if ( defined( $node->{latency} ) ) {
+        @latency = ( $node->{latency}, $node->{latency} );
+    } else {
+        foreach my $pattern (@cost_patterns) {
+            if ( $op =~ $pattern->[0] ) {
+                @latency = @{ $cost_classes{ $pattern->[1] } };
+                last;
+            }
+        }
+    }
+
+    my $op_attr_init = $node->{op_attr_init};
+    if ( defined($op_attr_init) ) {
+        $op_attr_init .= "\n\t";
+    } else {
+        $op_attr_init = "";
+    }
+    $op_attr_init .= "loongarch64_init_op(op, $latency[0], $latency[1]);";
+    $node->{op_attr_init} = $op_attr_init;
 }
 
 # Return node list
@@ -9,9 +9,13 @@
  */
 #include "loongarch64_transform.h"
 
+#include "beasm.h"
 #include "beirg.h"
 #include "benode.h"
 #include "betranshlp.h"
+#include "beutil.h"
+#include "bevarargs.h"
+#include "bitfiddle.h"
 #include "debug.h"
 #include "gen_loongarch64_regalloc_if.h"
 #include "ircons.h"
@@ -20,11 +24,14 @@
 #include "irgraph_t.h"
 #include "irmode_t.h"
 #include "irnode_t.h"
+#include "irprog_t.h"
 #include "iropt_t.h"
+#include "iroptimize.h"
 #include "loongarch64_bearch_t.h"
 #include "loongarch64_new_nodes.h"
 #include "loongarch64_nodes_attr.h"
 #include "panic.h"
+#include "platform_t.h"
 #include "util.h"
 
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
@@ -37,25 +44,50 @@ typedef ir_node *(*new_binop_reg_func)(dbg_info *dbgi, ir_node *block, ir_node *
 typedef ir_node *(*new_binop_imm_func)(dbg_info *dbgi, ir_node *block, ir_node *op1, ir_entity *const entity,
                                        int64_t value);
 typedef ir_node *(*new_uniop_func)(dbg_info *dbgi, ir_node *block, ir_node *op);
+typedef ir_node *(*new_ternop_func)(dbg_info *dbgi, ir_node *block, ir_node *op1, ir_node *op2, ir_node *op3);
 typedef ir_node *(*cons_loadop)(dbg_info *, ir_node *, ir_node *, ir_node *, ir_entity *, int64_t);
 typedef ir_node *(*cons_storeop)(dbg_info *, ir_node *, ir_node *, ir_node *, ir_node *, ir_entity *, int64_t);
+typedef ir_node *(*cons_loadxop)(dbg_info *, ir_node *, ir_node *, ir_node *, ir_node *);
+typedef ir_node *(*cons_storexop)(dbg_info *, ir_node *, ir_node *, ir_node *, ir_node *, ir_node *);
 
 #define TRANS_FUNC(name) static ir_node *gen_##name(ir_node *node)
 
-static bool is_valid_si12(ir_node *node) {
-    if (is_Const(node)) {
-        long const value = get_Const_long(node);
-        return is_simm12(value);
+/**
+ * Returns whether @p node is an integer constant and stores its value, as it is
+ * kept in a register, in @p value. 32 bit values are kept sign extended.
+ */
+static bool get_int_const(ir_node const *const node, int64_t *const value) {
+    if (!is_Const(node))
+        return false;
+    ir_tarval *tv   = get_Const_tarval(node);
+    ir_mode   *mode = get_tarval_mode(tv);
+    if (!mode_is_int(mode) && !mode_is_reference(mode))
+        return false;
+    unsigned const bits = get_mode_size_bits(mode);
+    if (bits == 64) {
+        tv = tarval_bitcast(tv, mode_Ls);
+    } else if (bits == 32) {
+        tv = tarval_bitcast(tv, mode_Is);
     }
-    return false;
+    *value = get_tarval_long(tv);
+    return true;
 }
 
+static bool is_uimm12(int64_t const value) { return 0 <= value && value < 4096; }
+
 static bool mode_is_int_or_pointer(ir_mode *const mode) { return mode_is_int(mode) || mode == mode_P; }
 
-static ir_node *transform_common_binop(ir_node *node, ir_mode *provide_mode, bool is_commutative,
-                                       new_binop_reg_func new_func_w, new_binop_reg_func new_func_d,
-                                       new_binop_reg_func new_func_wu, new_binop_reg_func new_func_du,
-                                       new_binop_imm_func new_func_wi, new_binop_imm_func new_func_di) {
+typedef bool (*imm_check_func)(int64_t value);
+
+/**
+ * Transforms a binary operation. If @p is_valid_imm accepts a constant operand,
+ * the immediate variant is used.
+ */
+static ir_node *transform_common_binop_imm(ir_node *node, ir_mode *provide_mode, bool is_commutative,
+                                           new_binop_reg_func new_func_w, new_binop_reg_func new_func_d,
+                                           new_binop_reg_func new_func_wu, new_binop_reg_func new_func_du,
+                                           new_binop_imm_func new_func_wi, new_binop_imm_func new_func_di,
+                                           imm_check_func is_valid_imm) {
     ir_mode  *mode  = provide_mode ? provide_mode : get_irn_mode(node);
     ir_node  *block = be_transform_nodes_block(node);
     ir_node  *op1   = get_binop_left(node);
@@ -72,20 +104,19 @@ static ir_node *transform_common_binop(ir_node *node, ir_mode *provide_mode, boo
         // Const folding
         if (new_func_wi && new_func_di) {
             // TODO: Both op1 and op2 are const. Generate a new const node.
-            if (is_valid_si12(op2)) {
-                op1 = be_transform_node(op1);
-                if (bits == 32) {
-                    return new_func_wi(dbgi, block, op1, NULL, get_Const_long(op2));
-                } else if (bits == 64) {
-                    return new_func_di(dbgi, block, op1, NULL, get_Const_long(op2));
-                }
+            int64_t  value;
+            ir_node *reg_op = NULL;
+            if (get_int_const(op2, &value) && is_valid_imm(value)) {
+                reg_op = op1;
+            } else if (is_commutative && get_int_const(op1, &value) && is_valid_imm(value)) {
+                reg_op = op2;
             }
-            if (is_commutative && is_valid_si12(op1)) {
-                op2 = be_transform_node(op2);
+            if (reg_op) {
+                ir_node *const new_op = be_transform_node(reg_op);
                 if (bits == 32) {
-                    return new_func_wi(dbgi, block, op2, NULL, get_Const_long(op1));
+                    return new_func_wi(dbgi, block, new_op, NULL, value);
                 } else if (bits == 64) {
-                    return new_func_di(dbgi, block, op2, NULL, get_Const_long(op1));
+                    return new_func_di(dbgi, block, new_op, NULL, value);
                 }
             }
         }
@@ -106,8 +137,16 @@ static ir_node *transform_common_binop(ir_node *node, ir_mode *provide_mode, boo
         }
     }
 
-    // TODO: float-point support
-    TODO(node);
+    // Float operations go through transform_float_binop.
+    panic("unexpected mode %+F for %+F", mode, node);
+}
+
+static ir_node *transform_common_binop(ir_node *node, ir_mode *provide_mode, bool is_commutative,
+                                       new_binop_reg_func new_func_w, new_binop_reg_func new_func_d,
+                                       new_binop_reg_func new_func_wu, new_binop_reg_func new_func_du,
+                                       new_binop_imm_func new_func_wi, new_binop_imm_func new_func_di) {
+    return transform_common_binop_imm(node, provide_mode, is_commutative, new_func_w, new_func_d, new_func_wu,
+                                      new_func_du, new_func_wi, new_func_di, is_simm12);
 }
 
 #define LA64_WD_INST(name) new_bd_loongarch64_##name##_w, new_bd_loongarch64_##name##_d
@@ -115,6 +154,44 @@ static ir_node *transform_common_binop(ir_node *node, ir_mode *provide_mode, boo
     new_bd_loongarch64_##name##_w, new_bd_loongarch64_##name##_d, new_bd_loongarch64_##name##_wu,                      \
         new_bd_loongarch64_##name##_du
 #define LA64_WD_SAME_INST(name) new_bd_loongarch64_##name, new_bd_loongarch64_##name
+#define LA64_SD_INST(name) new_bd_loongarch64_##name##_s, new_bd_loongarch64_##name##_d
+
+static ir_node *transform_float_binop(ir_node *node, ir_mode *mode, new_binop_reg_func new_func_s,
+                                      new_binop_reg_func new_func_d) {
+    ir_node *const  block   = be_transform_nodes_block(node);
+    dbg_info *const dbgi    = get_irn_dbg_info(node);
+    ir_node *const  new_op1 = be_transform_node(get_binop_left(node));
+    ir_node *const  new_op2 = be_transform_node(get_binop_right(node));
+    unsigned const  bits    = get_mode_size_bits(mode);
+    if (bits == 32) {
+        return new_func_s(dbgi, block, new_op1, new_op2);
+    } else if (bits == 64) {
+        return new_func_d(dbgi, block, new_op1, new_op2);
+    }
+    TODO(node);
+}
+
+// A `Mul` can be fused into a multiply-add only if nobody else needs its
+// rounded result.
+static bool is_fusable_mul(ir_node *const node, ir_mode *const mode) {
+    return is_Mul(node) && get_irn_mode(node) == mode && get_irn_n_edges(node) == 1;
+}
+
+static ir_node *transform_fma(ir_node *node, ir_node *mul, ir_node *addend, new_ternop_func new_func_s,
+                              new_ternop_func new_func_d) {
+    ir_node *const  block      = be_transform_nodes_block(node);
+    dbg_info *const dbgi       = get_irn_dbg_info(node);
+    ir_node *const  new_op1    = be_transform_node(get_Mul_left(mul));
+    ir_node *const  new_op2    = be_transform_node(get_Mul_right(mul));
+    ir_node *const  new_addend = be_transform_node(addend);
+    unsigned const  bits       = get_mode_size_bits(get_irn_mode(node));
+    if (bits == 32) {
+        return new_func_s(dbgi, block, new_op1, new_op2, new_addend);
+    } else if (bits == 64) {
+        return new_func_d(dbgi, block, new_op1, new_op2, new_addend);
+    }
+    TODO(node);
+}
 
 static ir_node *get_zero_register(ir_node *const node) {
     return be_get_Start_proj(get_irn_irg(node), &loongarch64_registers[REG_ZERO]);
@@ -137,50 +214,251 @@ static ir_node *transform_const(ir_node *const node, ir_entity *const entity, ui
     TODO(node);
 }
 
+static ir_node *transform_float_const(ir_node *const node) {
+    ir_node *const   block = be_transform_nodes_block(node);
+    dbg_info *const  dbgi  = get_irn_dbg_info(node);
+    ir_tarval *const tv    = get_Const_tarval(node);
+    unsigned const   bits  = get_mode_size_bits(get_tarval_mode(tv));
+
+    // Materialize the bit pattern in a general purpose register and move it.
+    if (bits == 32) {
+        int64_t const  value = get_tarval_long(tarval_bitcast(tv, mode_Is));
+        ir_node *const gp    = value == 0 ? get_zero_register(node) : new_bd_loongarch64_li_w(dbgi, block, NULL, value);
+        return new_bd_loongarch64_movgr2fr_w(dbgi, block, gp);
+    } else if (bits == 64) {
+        int64_t const  value = get_tarval_long(tarval_bitcast(tv, mode_Ls));
+        ir_node *const gp    = value == 0 ? get_zero_register(node) : new_bd_loongarch64_li_d(dbgi, block, NULL, value);
+        return new_bd_loongarch64_movgr2fr_d(dbgi, block, gp);
+    }
+    TODO(node);
+}
+
 typedef struct loongarch64_addr {
     ir_node   *base;
+    ir_node   *index; // NULL unless base + index (ldx/stx)
     ir_entity *ent;
     int64_t    val;
 } loongarch64_addr;
 
-static loongarch64_addr make_addr(ir_node *addr) {
-    ir_entity *ent = 0;
+// Returns whether @p node is `index << 1..4`, which alsl adds to a register.
+static bool is_scaled_index(ir_node *const node, ir_node **const index, int64_t *const shift) {
+    if (!is_Shl(node))
+        return false;
+    int64_t v;
+    if (!get_int_const(get_Shl_right(node), &v) || v < 1 || v > 4)
+        return false;
+    *index = get_Shl_left(node);
+    *shift = v;
+    return true;
+}
+
+// Returns whether @p node is the address of a global, which is not accessed
+// through the GOT.
+static bool is_pc_relative_address(ir_node const *const node) {
+    if (!is_Address(node))
+        return false;
+    ir_entity *const entity = get_Address_entity(node);
+    return !is_tls_entity(entity) && !loongarch64_is_got_entity(entity);
+}
+
+// Returns whether the Call pointer @p ptr is called with a direct bl, which
+// goes through the PLT for preemptible functions unless PLTs are disabled.
+static bool is_direct_call_target(ir_node const *const ptr) {
+    if (!is_Address(ptr))
+        return false;
+    return ir_platform.pic_style != BE_PIC_ELF_NO_PLT || !loongarch64_is_got_entity(get_Address_entity(ptr));
+}
+
+/**
+ * Matches the address @p addr of an access, which is
+ *
+ *   base + simm12           (or a 4 aligned simm16 if @p has_ptr_form)
+ *   frame entity + simm12
+ *   global entity + offset  (base is the pcalau12i of the page in @p block)
+ *   base + index
+ *
+ * The addresses of globals in the GOT are loaded into the base.
+ */
+static loongarch64_addr make_addr(ir_node *addr, ir_node *const block, bool const has_ptr_form) {
+    ir_entity *ent = NULL;
     int64_t    val = 0;
 
     if (is_Add(addr)) {
+        ir_node *const l = get_Add_left(addr);
         ir_node *const r = get_Add_right(addr);
-        if (is_Const(r)) {
-            long const v = get_Const_long(r);
-            if (is_simm12(v)) {
-                val  = v;
-                addr = get_Add_left(addr);
-            }
+        int64_t        v;
+        if (get_int_const(r, &v) && (is_pc_relative_address(l) || is_simm12(v) || (has_ptr_form && is_ptr_offset(v)))) {
+            val  = v;
+            addr = l;
+        } else if (!is_Member(l) && !is_Member(r)) {
+            // Also for other constants, which then need no add
+            ir_node *const base  = be_transform_node(l);
+            ir_node *const index = be_transform_node(r);
+            return (loongarch64_addr){base, index, NULL, 0};
         }
     }
 
+    ir_node *base;
     if (is_Member(addr)) {
         ent  = get_Member_entity(addr);
         addr = get_Member_ptr(addr);
         assert(is_Proj(addr) && get_Proj_num(addr) == pn_Start_P_frame_base && is_Start(get_Proj_pred(addr)));
+        base = be_transform_node(addr);
+    } else if (is_pc_relative_address(addr)) {
+        ent  = get_Address_entity(addr);
+        base = new_bd_loongarch64_pcalau12i(get_irn_dbg_info(addr), block, ent, val);
+    } else {
+        base = be_transform_node(addr);
     }
-
-    ir_node *const base = be_transform_node(addr);
-    return (loongarch64_addr){base, ent, val};
+    return (loongarch64_addr){base, NULL, ent, val};
 }
 
 static ir_node *get_Start_sp(ir_graph *const irg) { return be_get_Start_proj(irg, &loongarch64_registers[REG_SP]); }
 
+/**
+ * Adds the constant @p value to @p op with immediate instructions. Returns NULL
+ * if materializing the constant is cheaper.
+ */
+static ir_node *transform_add_imm(ir_node *const node, ir_node *const op, int64_t const value) {
+    ir_mode *const mode = get_irn_mode(node);
+    unsigned const bits = get_mode_size_bits(mode);
+    if (!mode_is_int_or_pointer(mode) || (bits != 32 && bits != 64))
+        return NULL;
+
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    if (bits == 32) {
+        if (!is_simm12(value))
+            return NULL;
+        return new_bd_loongarch64_addi_w(dbgi, block, be_transform_node(op), NULL, value);
+    }
+
+    if (is_simm12(value))
+        return new_bd_loongarch64_addi_d(dbgi, block, be_transform_node(op), NULL, value);
+
+    // value = (hi << 16) + lo, with addu16i.d covering hi and addi.d lo. Check
+    // the range first, so value - lo cannot overflow.
+    if (value < (int64_t)INT16_MIN * 65536 - 2048 || value > (int64_t)INT16_MAX * 65536 + 2047)
+        return NULL;
+    int64_t const lo = (int16_t)(value & 0xFFFF);
+    int64_t const hi = (value - lo) / 65536;
+    if (!is_simm12(lo) || hi < INT16_MIN || hi > INT16_MAX)
+        return NULL;
+    ir_node *res = be_transform_node(op);
+    if (lo != 0)
+        res = new_bd_loongarch64_addi_d(dbgi, block, res, NULL, lo);
+    return new_bd_loongarch64_addu16i_d(dbgi, block, res, NULL, hi);
+}
+
+// x + (index << 1..4) => alsl
+static ir_node *transform_scaled_add(ir_node *const node, ir_node *const op, ir_node *const scaled) {
+    ir_node *index;
+    int64_t  shift;
+    if (!is_scaled_index(scaled, &index, &shift))
+        return NULL;
+    dbg_info *const dbgi      = get_irn_dbg_info(node);
+    ir_node *const  block     = be_transform_nodes_block(node);
+    ir_node *const  new_index = be_transform_node(index);
+    ir_node *const  new_op    = be_transform_node(op);
+    if (get_mode_size_bits(get_irn_mode(node)) == 32)
+        return new_bd_loongarch64_alsl_w(dbgi, block, new_index, new_op, NULL, shift);
+    return new_bd_loongarch64_alsl_d(dbgi, block, new_index, new_op, NULL, shift);
+}
+
+/**
+ * Transforms a shift. Constant shift amounts are taken modulo the register
+ * width, just like the register variants do.
+ */
+static ir_node *transform_shift(ir_node *const node, new_binop_reg_func new_func_w, new_binop_reg_func new_func_d,
+                                new_binop_imm_func new_func_wi, new_binop_imm_func new_func_di) {
+    ir_mode *const mode = get_irn_mode(node);
+    unsigned const bits = get_mode_size_bits(mode);
+    int64_t        value;
+    if (mode_is_int(mode) && (bits == 32 || bits == 64) && get_int_const(get_binop_right(node), &value)) {
+        dbg_info *const dbgi   = get_irn_dbg_info(node);
+        ir_node *const  block  = be_transform_nodes_block(node);
+        ir_node *const  new_op = be_transform_node(get_binop_left(node));
+        int64_t const   amount = value & (bits - 1);
+        if (bits == 32) {
+            return new_func_wi(dbgi, block, new_op, NULL, amount);
+        }
+        return new_func_di(dbgi, block, new_op, NULL, amount);
+    }
+    return transform_common_binop(node, NULL, false, new_func_w, new_func_d, NULL, NULL, NULL, NULL);
+}
+
 // ------------------- Arithemtic -------------------
 
-TRANS_FUNC(Add) { return transform_common_binop(node, NULL, true, LA64_WD_INST(add), NULL, NULL, LA64_WD_INST(addi)); }
+TRANS_FUNC(Add) {
+    ir_mode *const mode = get_irn_mode(node);
+    if (mode_is_float(mode)) {
+        ir_node *const l = get_Add_left(node);
+        ir_node *const r = get_Add_right(node);
+        // a * b + c
+        if (is_fusable_mul(l, mode)) {
+            return transform_fma(node, l, r, LA64_SD_INST(fmadd));
+        } else if (is_fusable_mul(r, mode)) {
+            return transform_fma(node, r, l, LA64_SD_INST(fmadd));
+        }
+        return transform_float_binop(node, mode, LA64_SD_INST(fadd));
+    }
+    int64_t value;
+    if (get_int_const(get_Add_right(node), &value)) {
+        ir_node *const res = transform_add_imm(node, get_Add_left(node), value);
+        if (res)
+            return res;
+    }
+    ir_node *const l   = get_Add_left(node);
+    ir_node *const r   = get_Add_right(node);
+    ir_node       *res = transform_scaled_add(node, l, r);
+    if (!res)
+        res = transform_scaled_add(node, r, l);
+    if (res)
+        return res;
+    return transform_common_binop(node, NULL, true, LA64_WD_INST(add), NULL, NULL, LA64_WD_INST(addi));
+}
 
-TRANS_FUNC(Sub) { return transform_common_binop(node, NULL, false, LA64_WD_INST(sub), NULL, NULL, NULL, NULL); }
+TRANS_FUNC(Sub) {
+    ir_mode *const mode = get_irn_mode(node);
+    if (mode_is_float(mode)) {
+        ir_node *const l = get_Sub_left(node);
+        ir_node *const r = get_Sub_right(node);
+        if (is_fusable_mul(l, mode)) {
+            // a * b - c
+            return transform_fma(node, l, r, LA64_SD_INST(fmsub));
+        } else if (is_fusable_mul(r, mode)) {
+            // c - a * b = -(a * b - c)
+            return transform_fma(node, r, l, LA64_SD_INST(fnmsub));
+        }
+        return transform_float_binop(node, mode, LA64_SD_INST(fsub));
+    }
+    // x - C = x + (-C)
+    int64_t value;
+    if (get_int_const(get_Sub_right(node), &value)) {
+        ir_node *const res = transform_add_imm(node, get_Sub_left(node), (int64_t)(0 - (uint64_t)value));
+        if (res)
+            return res;
+    }
+    return transform_common_binop(node, NULL, false, LA64_WD_INST(sub), NULL, NULL, NULL, NULL);
+}
 
-TRANS_FUNC(Mul) { return transform_common_binop(node, NULL, true, LA64_WD_INST(mul), NULL, NULL, NULL, NULL); }
+TRANS_FUNC(Mul) {
+    ir_mode *const mode = get_irn_mode(node);
+    if (mode_is_float(mode)) {
+        return transform_float_binop(node, mode, LA64_SD_INST(fmul));
+    }
+    return transform_common_binop(node, NULL, true, LA64_WD_INST(mul), NULL, NULL, NULL, NULL);
+}
 
 TRANS_FUNC(Mulh) { return transform_common_binop(node, NULL, true, LA64_WDU_INST(mulh), NULL, NULL); }
 
-TRANS_FUNC(Div) { return transform_common_binop(node, get_Div_resmode(node), false, LA64_WDU_INST(div), NULL, NULL); }
+TRANS_FUNC(Div) {
+    ir_mode *const mode = get_Div_resmode(node);
+    if (mode_is_float(mode)) {
+        return transform_float_binop(node, mode, LA64_SD_INST(fdiv));
+    }
+    return transform_common_binop(node, mode, false, LA64_WDU_INST(div), NULL, NULL);
+}
 
 TRANS_FUNC(Mod) { return transform_common_binop(node, get_Mod_resmode(node), false, LA64_WDU_INST(mod), NULL, NULL); }
 
@@ -200,31 +478,58 @@ TRANS_FUNC(Minus) {
         } else if (bits == 64) {
             return new_bd_loongarch64_sub_d(dbgi, block, new_l, new_r);
         }
+    } else if (mode_is_float(mode)) {
+        ir_node *const new_op = be_transform_node(val);
+        if (bits == 32) {
+            return new_bd_loongarch64_fneg_s(dbgi, block, new_op);
+        } else if (bits == 64) {
+            return new_bd_loongarch64_fneg_d(dbgi, block, new_op);
+        }
     }
 
     TODO(node);
 }
 
-TRANS_FUNC(Shl) { return transform_common_binop(node, NULL, false, LA64_WD_INST(sll), NULL, NULL, LA64_WD_INST(slli)); }
+TRANS_FUNC(Shl) { return transform_shift(node, LA64_WD_INST(sll), LA64_WD_INST(slli)); }
 
-TRANS_FUNC(Shr) { return transform_common_binop(node, NULL, false, LA64_WD_INST(srl), NULL, NULL, LA64_WD_INST(srli)); }
+TRANS_FUNC(Shr) { return transform_shift(node, LA64_WD_INST(srl), LA64_WD_INST(srli)); }
 
-TRANS_FUNC(Shrs) {
-    return transform_common_binop(node, NULL, false, LA64_WD_INST(sra), NULL, NULL, LA64_WD_INST(srai));
-}
+TRANS_FUNC(Shrs) { return transform_shift(node, LA64_WD_INST(sra), LA64_WD_INST(srai)); }
 
 // ------------------- Bit manipulation -------------------
 
+// x & (2^n - 1) for masks too wide for andi
+static bool is_low_bit_mask(int64_t const value) { return value > 0 && (value & (value + 1)) == 0; }
+
 TRANS_FUNC(And) {
-    return transform_common_binop(node, NULL, true, LA64_WD_SAME_INST(and), NULL, NULL, LA64_WD_SAME_INST(andi));
+    ir_node *const l = get_And_left(node);
+    ir_node *const r = get_And_right(node);
+    ir_node       *op;
+    int64_t        value;
+    if (get_int_const(r, &value) && !is_uimm12(value) && is_low_bit_mask(value)) {
+        op = l;
+    } else if (get_int_const(l, &value) && !is_uimm12(value) && is_low_bit_mask(value)) {
+        op = r;
+    } else {
+        // The logical instructions zero extend their immediate.
+        return transform_common_binop_imm(node, NULL, true, LA64_WD_SAME_INST(and), NULL, NULL,
+                                          LA64_WD_SAME_INST(andi), is_uimm12);
+    }
+    dbg_info *const dbgi   = get_irn_dbg_info(node);
+    ir_node *const  block  = be_transform_nodes_block(node);
+    ir_node *const  new_op = be_transform_node(op);
+    unsigned const  width  = popcount((uint32_t)value) + popcount((uint32_t)(value >> 32));
+    return new_bd_loongarch64_bstrpick_d(dbgi, block, new_op, NULL, width - 1);
 }
 
 TRANS_FUNC(Or) {
-    return transform_common_binop(node, NULL, true, LA64_WD_SAME_INST(or), NULL, NULL, LA64_WD_SAME_INST(ori));
+    return transform_common_binop_imm(node, NULL, true, LA64_WD_SAME_INST(or), NULL, NULL, LA64_WD_SAME_INST(ori),
+                                      is_uimm12);
 }
 
 TRANS_FUNC(Eor) {
-    return transform_common_binop(node, NULL, true, LA64_WD_SAME_INST(xor), NULL, NULL, LA64_WD_SAME_INST(xori));
+    return transform_common_binop_imm(node, NULL, true, LA64_WD_SAME_INST(xor), NULL, NULL, LA64_WD_SAME_INST(xori),
+                                      is_uimm12);
 }
 
 TRANS_FUNC(Not) {
@@ -242,25 +547,24 @@ TRANS_FUNC(Not) {
 }
 
 TRANS_FUNC(Const) {
-    int64_t value = get_Const_long(node);
+    if (mode_is_float(get_irn_mode(node))) {
+        return transform_float_const(node);
+    }
+    int64_t value;
+    if (!get_int_const(node, &value))
+        TODO(node);
     return transform_const(node, NULL, value);
 }
 
 // ------------------- Conversion -------------------
 
-// Convert `node` to `target` mode in 64-bits register.
-ir_node *convert_value(dbg_info *const dbgi, ir_node *const node, ir_mode *const target) {
-    ir_node *const new_op   = be_transform_node(node);
-    ir_node *const block    = get_nodes_block(new_op);
-    ir_mode *const mode     = get_irn_mode(node);
+// Convert the already transformed `new_op` of `mode` to `target` mode in 64-bits register.
+static ir_node *convert_gp_value(dbg_info *const dbgi, ir_node *const block, ir_node *const new_op,
+                                 ir_mode *const mode, ir_mode *const target) {
     unsigned const o_bits   = get_mode_size_bits(mode);
     bool           o_signed = mode_is_signed(mode);
     unsigned const t_bits   = get_mode_size_bits(target);
     bool           t_signed = mode_is_signed(target);
-    // only int
-    if (!mode_is_int_or_pointer(mode) || !mode_is_int_or_pointer(target)) {
-        TODO(node);
-    }
     // unsigned int -> long
     if (mode == mode_Iu && t_bits == 64) {
         return new_bd_loongarch64_zext_w(dbgi, block, new_op);
@@ -281,13 +585,70 @@ ir_node *convert_value(dbg_info *const dbgi, ir_node *const node, ir_mode *const
     return new_op;
 }
 
+// Convert `node` to `target` mode in 64-bits register.
+ir_node *convert_value(dbg_info *const dbgi, ir_node *const node, ir_mode *const target) {
+    ir_node *const new_op = be_transform_node(node);
+    ir_node *const block  = get_nodes_block(new_op);
+    ir_mode *const mode   = get_irn_mode(node);
+    // only int
+    if (!mode_is_int_or_pointer(mode) || !mode_is_int_or_pointer(target)) {
+        TODO(node);
+    }
+    return convert_gp_value(dbgi, block, new_op, mode, target);
+}
+
 ir_node *extend_value(ir_node *const node) { return convert_value(NULL, node, mode_Ls); }
 
+// Unsigned 64-bit integers are rewritten in `loongarch64_handle_intrinsics`,
+// all other integers fit into the signed 64-bit conversions.
+static ir_node *convert_int_to_float(dbg_info *const dbgi, ir_node *const block, ir_node *const op,
+                                     ir_mode *const target) {
+    ir_node *const val = extend_value(op);
+    ir_node *const fp  = new_bd_loongarch64_movgr2fr_d(dbgi, block, val);
+    if (get_mode_size_bits(target) == 32) {
+        return new_bd_loongarch64_ffint_s_l(dbgi, block, fp);
+    }
+    return new_bd_loongarch64_ffint_d_l(dbgi, block, fp);
+}
+
+static ir_node *convert_float_to_int(dbg_info *const dbgi, ir_node *const block, ir_node *const op,
+                                     ir_mode *const target) {
+    ir_node *const new_op = be_transform_node(op);
+    bool const     is_d   = get_mode_size_bits(get_irn_mode(op)) == 64;
+    unsigned const t_bits = get_mode_size_bits(target);
+    // `unsigned int` does not fit into the 32-bits conversion.
+    if (t_bits == 64 || (t_bits == 32 && !mode_is_signed(target))) {
+        ir_node *const cvt = is_d ? new_bd_loongarch64_ftintrz_l_d(dbgi, block, new_op)
+                                  : new_bd_loongarch64_ftintrz_l_s(dbgi, block, new_op);
+        ir_node *const res = new_bd_loongarch64_movfr2gr_d(dbgi, block, cvt);
+        return convert_gp_value(dbgi, block, res, mode_Ls, target);
+    }
+    ir_node *const cvt = is_d ? new_bd_loongarch64_ftintrz_w_d(dbgi, block, new_op)
+                              : new_bd_loongarch64_ftintrz_w_s(dbgi, block, new_op);
+    ir_node *const res = new_bd_loongarch64_movfr2gr_s(dbgi, block, cvt);
+    return convert_gp_value(dbgi, block, res, mode_Is, target);
+}
+
 TRANS_FUNC(Conv) {
     ir_node *const  block = be_transform_nodes_block(node);
     dbg_info *const dbgi  = get_irn_dbg_info(node);
     ir_node *const  op    = get_Conv_op(node);
     ir_mode *const  mode  = get_irn_mode(node);
+    ir_mode *const  src   = get_irn_mode(op);
+    if (mode_is_float(mode) && mode_is_float(src)) {
+        ir_node *const new_op = be_transform_node(op);
+        unsigned const bits   = get_mode_size_bits(mode);
+        if (bits == get_mode_size_bits(src)) {
+            return new_op;
+        } else if (bits == 32) {
+            return new_bd_loongarch64_fcvt_s_d(dbgi, block, new_op);
+        }
+        return new_bd_loongarch64_fcvt_d_s(dbgi, block, new_op);
+    } else if (mode_is_float(mode)) {
+        return convert_int_to_float(dbgi, block, op, mode);
+    } else if (mode_is_float(src)) {
+        return convert_float_to_int(dbgi, block, op, mode);
+    }
     return convert_value(dbgi, op, mode);
 }
 
@@ -295,61 +656,107 @@ TRANS_FUNC(Conv) {
 
 TRANS_FUNC(Load) {
     ir_mode *const mode = get_Load_mode(node);
+    unsigned const size = get_mode_size_bits(mode);
+    cons_loadop    cons;
+    cons_loadxop   consx;
     if (be_mode_needs_gp_reg(mode)) {
-        cons_loadop    cons;
-        unsigned const size = get_mode_size_bits(mode);
+        bool const is_signed = mode_is_signed(mode);
         if (size == 8) {
-            cons = mode_is_signed(mode) ? new_bd_loongarch64_ld_b : new_bd_loongarch64_ld_bu;
+            cons  = is_signed ? new_bd_loongarch64_ld_b : new_bd_loongarch64_ld_bu;
+            consx = is_signed ? new_bd_loongarch64_ldx_b : new_bd_loongarch64_ldx_bu;
         } else if (size == 16) {
-            cons = mode_is_signed(mode) ? new_bd_loongarch64_ld_h : new_bd_loongarch64_ld_hu;
+            cons  = is_signed ? new_bd_loongarch64_ld_h : new_bd_loongarch64_ld_hu;
+            consx = is_signed ? new_bd_loongarch64_ldx_h : new_bd_loongarch64_ldx_hu;
         } else if (size == 32) {
-            cons = mode_is_signed(mode) ? new_bd_loongarch64_ld_w : new_bd_loongarch64_ld_wu;
+            cons  = is_signed ? new_bd_loongarch64_ld_w : new_bd_loongarch64_ld_wu;
+            consx = is_signed ? new_bd_loongarch64_ldx_w : new_bd_loongarch64_ldx_wu;
         } else if (size == 64) {
-            cons = new_bd_loongarch64_ld_d;
+            cons  = new_bd_loongarch64_ld_d;
+            consx = new_bd_loongarch64_ldx_d;
         } else {
             panic("invalid load");
         }
-        dbg_info *const        dbgi  = get_irn_dbg_info(node);
-        ir_node *const         block = be_transform_nodes_block(node);
-        ir_node *const         mem   = be_transform_node(get_Load_mem(node));
-        loongarch64_addr const addr  = make_addr(get_Load_ptr(node));
-        return cons(dbgi, block, mem, addr.base, addr.ent, addr.val);
+    } else if (mode_is_float(mode)) {
+        cons  = size == 32 ? new_bd_loongarch64_fld_s : new_bd_loongarch64_fld_d;
+        consx = size == 32 ? new_bd_loongarch64_fldx_s : new_bd_loongarch64_fldx_d;
+    } else {
+        TODO(node);
     }
-    TODO(node);
+    // Only the sign extending ld.w has a ldptr form
+    bool const             has_ptr_form = cons == new_bd_loongarch64_ld_w || cons == new_bd_loongarch64_ld_d;
+    dbg_info *const        dbgi         = get_irn_dbg_info(node);
+    ir_node *const         block        = be_transform_nodes_block(node);
+    ir_node *const         mem          = be_transform_node(get_Load_mem(node));
+    loongarch64_addr const addr         = make_addr(get_Load_ptr(node), block, has_ptr_form);
+    if (addr.index)
+        return consx(dbgi, block, mem, addr.base, addr.index);
+    return cons(dbgi, block, mem, addr.base, addr.ent, addr.val);
 }
 
 TRANS_FUNC(Store) {
     ir_node       *old_val = get_Store_value(node);
     ir_mode *const mode    = get_irn_mode(old_val);
+    unsigned const size    = get_mode_size_bits(mode);
+    cons_storeop   cons;
+    cons_storexop  consx;
     if (be_mode_needs_gp_reg(mode)) {
-        cons_storeop   cons;
-        unsigned const size = get_mode_size_bits(mode);
         if (size == 8) {
-            cons = new_bd_loongarch64_st_b;
+            cons  = new_bd_loongarch64_st_b;
+            consx = new_bd_loongarch64_stx_b;
         } else if (size == 16) {
-            cons = new_bd_loongarch64_st_h;
+            cons  = new_bd_loongarch64_st_h;
+            consx = new_bd_loongarch64_stx_h;
         } else if (size == 32) {
-            cons = new_bd_loongarch64_st_w;
+            cons  = new_bd_loongarch64_st_w;
+            consx = new_bd_loongarch64_stx_w;
         } else if (size == 64) {
-            cons = new_bd_loongarch64_st_d;
+            cons  = new_bd_loongarch64_st_d;
+            consx = new_bd_loongarch64_stx_d;
         } else {
             panic("invalid store");
         }
-        old_val                      = be_skip_downconv(old_val, false);
-        dbg_info *const        dbgi  = get_irn_dbg_info(node);
-        ir_node *const         block = be_transform_nodes_block(node);
-        ir_node *const         mem   = be_transform_node(get_Store_mem(node));
-        ir_node *const         val   = be_transform_node(old_val);
-        loongarch64_addr const addr  = make_addr(get_Store_ptr(node));
-        return cons(dbgi, block, mem, addr.base, val, addr.ent, addr.val);
+        old_val = be_skip_downconv(old_val, false);
+    } else if (mode_is_float(mode)) {
+        cons  = size == 32 ? new_bd_loongarch64_fst_s : new_bd_loongarch64_fst_d;
+        consx = size == 32 ? new_bd_loongarch64_fstx_s : new_bd_loongarch64_fstx_d;
+    } else {
+        TODO(node);
     }
-    TODO(node);
+    bool const             has_ptr_form = cons == new_bd_loongarch64_st_w || cons == new_bd_loongarch64_st_d;
+    dbg_info *const        dbgi         = get_irn_dbg_info(node);
+    ir_node *const         block        = be_transform_nodes_block(node);
+    ir_node *const         mem          = be_transform_node(get_Store_mem(node));
+    ir_node *const         val          = be_transform_node(old_val);
+    loongarch64_addr const addr         = make_addr(get_Store_ptr(node), block, has_ptr_form);
+    if (addr.index)
+        return consx(dbgi, block, mem, addr.base, addr.index, val);
+    return cons(dbgi, block, mem, addr.base, val, addr.ent, addr.val);
 }
 
+TRANS_FUNC(CopyB) {
+    // lower_CopyB leaves the copies for vcopy, which copies the last
+    // (partial) vector overlapping the previous one
+    unsigned const size = get_type_size(get_CopyB_type(node));
+    assert(loongarch64_vector_size() != 0 && size >= loongarch64_vector_size());
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    ir_node *const  mem   = be_transform_node(get_CopyB_mem(node));
+    ir_node *const  dst   = be_transform_node(get_CopyB_dst(node));
+    ir_node *const  src   = be_transform_node(get_CopyB_src(node));
+    ir_node *const  copy  = new_bd_loongarch64_vcopy(dbgi, block, mem, dst, src, NULL, size);
+    return be_new_Proj(copy, pn_loongarch64_vcopy_M);
+}
+
+static ir_node *gen_tls_address(dbg_info *dbgi, ir_node *block, ir_entity *entity);
+
 TRANS_FUNC(Address) {
     dbg_info *const  dbgi   = get_irn_dbg_info(node);
     ir_node *const   block  = be_transform_nodes_block(node);
     ir_entity *const entity = get_Address_entity(node);
+    if (is_tls_entity(entity))
+        return gen_tls_address(dbgi, block, entity);
+    if (loongarch64_is_got_entity(entity))
+        return new_bd_loongarch64_load_got(dbgi, block, entity, 0);
     return new_bd_loongarch64_load_address(dbgi, block, entity, 0);
 }
 
@@ -365,50 +772,209 @@ TRANS_FUNC(Member) {
 
 // ------------------- Compare or Conditional -------------------
 
-TRANS_FUNC(Cmp) {
-    ir_node       *l    = get_Cmp_left(node);
-    ir_node       *r    = get_Cmp_right(node);
-    ir_mode *const mode = get_irn_mode(l);
-    if (be_mode_needs_gp_reg(mode)) {
-        ir_relation const rel = get_Cmp_relation(node) & ir_relation_less_equal_greater;
-        switch (rel) {
-        case ir_relation_greater:
-        case ir_relation_less_equal: {
-            ir_node *const t = l;
-            l                = r;
-            r                = t;
-        } /* FALLTHROUGH */
-        case ir_relation_greater_equal:
-        case ir_relation_less: {
-            dbg_info *const dbgi  = get_irn_dbg_info(node);
-            ir_node *const  block = be_transform_nodes_block(node);
-            ir_node *const  new_l = extend_value(l);
-            ir_node        *cmp   = NULL;
-            if (is_valid_si12(r)) {
-                if (mode_is_signed(mode)) {
-                    cmp = new_bd_loongarch64_slti(dbgi, block, new_l, NULL, get_Const_long(r));
-                } else {
-                    cmp = new_bd_loongarch64_sltui(dbgi, block, new_l, NULL, get_Const_long(r));
-                }
-            } else {
-                ir_node *const new_r = extend_value(r);
-                if (mode_is_signed(mode)) {
-                    cmp = new_bd_loongarch64_slt(dbgi, block, new_l, new_r);
-                } else {
-                    cmp = new_bd_loongarch64_sltu(dbgi, block, new_l, new_r);
-                }
-            }
-            if (rel & ir_relation_equal) {
-                ir_node * xor = new_bd_loongarch64_xori(dbgi, block, cmp, NULL, 1);
-                ir_node  *and = new_bd_loongarch64_andi(dbgi, block, xor, NULL, 1);
-                return and;
-            }
-            return cmp;
+// Create a `fcmp` setting a `fcc` register if `cmp` holds.
+static ir_node *transform_float_cmp(ir_node *const cmp) {
+    dbg_info *const     dbgi      = get_irn_dbg_info(cmp);
+    ir_node *const      block     = be_transform_nodes_block(cmp);
+    ir_node            *l         = get_Cmp_left(cmp);
+    ir_node            *r         = get_Cmp_right(cmp);
+    bool                need_swap = false;
+    loongarch64_fcond_t fcond;
+    // Ordered relational compares signal on NaN operands, equality compares are quiet.
+    switch (get_Cmp_relation(cmp)) {
+    case ir_relation_false:
+        fcond = loongarch64_fcond_caf;
+        break;
+    case ir_relation_equal:
+        fcond = loongarch64_fcond_ceq;
+        break;
+    case ir_relation_greater:
+        need_swap = true; /* FALLTHROUGH */
+    case ir_relation_less:
+        fcond = loongarch64_fcond_slt;
+        break;
+    case ir_relation_greater_equal:
+        need_swap = true; /* FALLTHROUGH */
+    case ir_relation_less_equal:
+        fcond = loongarch64_fcond_sle;
+        break;
+    case ir_relation_less_greater:
+        fcond = loongarch64_fcond_cne;
+        break;
+    case ir_relation_less_equal_greater:
+        fcond = loongarch64_fcond_cor;
+        break;
+    case ir_relation_unordered:
+        fcond = loongarch64_fcond_cun;
+        break;
+    case ir_relation_unordered_equal:
+        fcond = loongarch64_fcond_cueq;
+        break;
+    case ir_relation_unordered_greater:
+        need_swap = true; /* FALLTHROUGH */
+    case ir_relation_unordered_less:
+        fcond = loongarch64_fcond_cult;
+        break;
+    case ir_relation_unordered_greater_equal:
+        need_swap = true; /* FALLTHROUGH */
+    case ir_relation_unordered_less_equal:
+        fcond = loongarch64_fcond_cule;
+        break;
+    case ir_relation_unordered_less_greater:
+        fcond = loongarch64_fcond_cune;
+        break;
+    default:
+        panic("invalid float relation");
+    }
+    if (need_swap) {
+        ir_node *const t = l;
+        l                = r;
+        r                = t;
+    }
+    ir_node *const new_l = be_transform_node(l);
+    ir_node *const new_r = be_transform_node(r);
+    if (get_mode_size_bits(get_irn_mode(l)) == 32) {
+        return new_bd_loongarch64_fcmp_s(dbgi, block, new_l, new_r, fcond);
+    }
+    return new_bd_loongarch64_fcmp_d(dbgi, block, new_l, new_r, fcond);
+}
+
+static bool is_float_Cmp(ir_node *const node) {
+    return is_Cmp(node) && mode_is_float(get_irn_mode(get_Cmp_left(node)));
+}
+
+// Returns the constant as it compares against values widened by `extend_value`.
+static bool get_extended_int_const(ir_node const *const node, int64_t *const value) {
+    if (!get_int_const(node, value))
+        return false;
+    if (get_irn_mode(node) == mode_Iu)
+        *value = (uint32_t)*value;
+    return true;
+}
+
+// Checks whether the integer compare `*l rel r` is a test of `*l` against zero.
+// A zero on the left side is moved to the right and compares against 1 and -1
+// are turned into compares against zero. Unsigned `> 0` and `<= 0` become
+// `!= 0` and `== 0`.
+static bool match_zero_cmp(ir_node **const l, ir_node *r, ir_relation *const rel) {
+    if (is_irn_null(*l)) {
+        ir_node *const t = *l;
+        *l               = r;
+        r                = t;
+        *rel             = get_inversed_relation(*rel);
+    }
+    int64_t value;
+    if (!get_int_const(r, &value))
+        return false;
+    bool const is_signed = mode_is_signed(get_irn_mode(*l));
+    if (value == 1) {
+        if (*rel == ir_relation_less) {
+            *rel = is_signed ? ir_relation_less_equal : ir_relation_equal;
+        } else if (*rel == ir_relation_greater_equal) {
+            *rel = is_signed ? ir_relation_greater : ir_relation_less_greater;
+        } else {
+            return false;
         }
+    } else if (value == -1 && is_signed) {
+        if (*rel == ir_relation_greater) {
+            *rel = ir_relation_greater_equal;
+        } else if (*rel == ir_relation_less_equal) {
+            *rel = ir_relation_less;
+        } else {
+            return false;
+        }
+    } else if (value != 0) {
+        return false;
+    }
+    if (!is_signed) {
+        if (*rel == ir_relation_greater) {
+            *rel = ir_relation_less_greater;
+        } else if (*rel == ir_relation_less_equal) {
+            *rel = ir_relation_equal;
+        }
+    }
+    return true;
+}
 
-        default:
-            TODO(node);
+// Materializes an integer compare as 0 or 1. If `*inverted` is set on return,
+// the result is 1 if the compare does not hold.
+static ir_node *transform_int_cmp_inverted(ir_node *const node, ir_node *l, ir_node *r, ir_relation rel,
+                                           bool *const inverted) {
+    dbg_info *const dbgi      = get_irn_dbg_info(node);
+    ir_node *const  block     = be_transform_nodes_block(node);
+    bool const      is_signed = mode_is_signed(get_irn_mode(l));
+    bool const      is_zero   = match_zero_cmp(&l, r, &rel);
+    ir_node *const  new_l     = extend_value(l);
+    int64_t         value     = 0;
+    bool const      has_imm   = is_zero || get_extended_int_const(r, &value);
+    ir_node        *cmp;
+    *inverted = false;
+    switch (rel) {
+    case ir_relation_equal:
+    case ir_relation_less_greater: {
+        // l == r <=> (l ^ r) <u 1, l != r <=> 0 <u (l ^ r)
+        ir_node *diff = new_l;
+        if (has_imm && is_uimm12(value)) {
+            if (value != 0)
+                diff = new_bd_loongarch64_xori(dbgi, block, new_l, NULL, value);
+        } else {
+            diff = new_bd_loongarch64_xor(dbgi, block, new_l, extend_value(r));
+        }
+        if (rel == ir_relation_equal)
+            return new_bd_loongarch64_sltui(dbgi, block, diff, NULL, 1);
+        return new_bd_loongarch64_sltu(dbgi, block, get_zero_register(node), diff);
+    }
+    case ir_relation_less_equal:
+        // l <= c <=> l < c + 1
+        if (has_imm && is_simm12(value) && is_simm12(value + 1) && (is_signed || value != -1)) {
+            cmp = (is_signed ? new_bd_loongarch64_slti : new_bd_loongarch64_sltui)(dbgi, block, new_l, NULL,
+                                                                                  value + 1);
+            break;
+        }
+        *inverted = true; /* FALLTHROUGH */
+    case ir_relation_greater: {
+        ir_node *const new_r = is_zero ? get_zero_register(node) : extend_value(r);
+        cmp = (is_signed ? new_bd_loongarch64_slt : new_bd_loongarch64_sltu)(dbgi, block, new_r, new_l);
+        break;
+    }
+    case ir_relation_greater_equal:
+        *inverted = true; /* FALLTHROUGH */
+    case ir_relation_less:
+        if (has_imm && is_simm12(value)) {
+            cmp = (is_signed ? new_bd_loongarch64_slti : new_bd_loongarch64_sltui)(dbgi, block, new_l, NULL, value);
+        } else {
+            ir_node *const new_r = extend_value(r);
+            cmp = (is_signed ? new_bd_loongarch64_slt : new_bd_loongarch64_sltu)(dbgi, block, new_l, new_r);
         }
+        break;
+    default:
+        TODO(node);
+    }
+    return cmp;
+}
+
+static ir_node *transform_int_cmp(ir_node *const node, ir_node *const l, ir_node *const r, ir_relation const rel) {
+    bool           inverted;
+    ir_node *const cmp = transform_int_cmp_inverted(node, l, r, rel, &inverted);
+    if (!inverted)
+        return cmp;
+    // The result of slt is 0 or 1, so flipping the lowest bit negates it.
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    return new_bd_loongarch64_xori(dbgi, block, cmp, NULL, 1);
+}
+
+TRANS_FUNC(Cmp) {
+    ir_node *const l    = get_Cmp_left(node);
+    ir_node *const r    = get_Cmp_right(node);
+    ir_mode *const mode = get_irn_mode(l);
+    if (be_mode_needs_gp_reg(mode)) {
+        return transform_int_cmp(node, l, r, get_Cmp_relation(node) & ir_relation_less_equal_greater);
+    } else if (mode_is_float(mode)) {
+        dbg_info *const dbgi  = get_irn_dbg_info(node);
+        ir_node *const  block = be_transform_nodes_block(node);
+        ir_node *const  fcmp  = transform_float_cmp(node);
+        return new_bd_loongarch64_movcf2gr(dbgi, block, fcmp);
     }
     TODO(node);
 }
@@ -417,27 +983,24 @@ TRANS_FUNC(Cond) {
     ir_node *const     sel   = get_Cond_selector(node);
     dbg_info *const    dbgi  = get_irn_dbg_info(node);
     ir_node *const     block = be_transform_nodes_block(node);
-    ir_relation const  rel   = get_Cmp_relation(sel) & ir_relation_less_equal_greater;
-    ir_node *const     l     = get_Cmp_left(sel);
+    ir_relation        rel   = get_Cmp_relation(sel) & ir_relation_less_equal_greater;
+    ir_node           *l     = get_Cmp_left(sel);
     ir_node *const     r     = get_Cmp_right(sel);
     ir_mode *const     mode  = get_irn_mode(l);
     loongarch64_cond_t cond  = loongarch64_invalid;
 
     if (is_Cmp(sel)) {
         if (be_mode_needs_gp_reg(mode)) {
-            // r == 0
-            if (is_irn_null(r)) {
-                if (rel == ir_relation_equal) {
-                    ir_node *const new_l = extend_value(l);
-                    return new_bd_loongarch64_b_cond(dbgi, block, new_l, get_zero_register(node), loongarch64_beqz);
-                } else if (rel == ir_relation_less_greater) {
-                    ir_node *const new_l = extend_value(l);
-                    return new_bd_loongarch64_b_cond(dbgi, block, new_l, get_zero_register(node), loongarch64_bnez);
-                }
+            bool const     is_zero = match_zero_cmp(&l, r, &rel);
+            ir_node *const new_l   = extend_value(l);
+            // beqz/bnez reach 21 bits, the other compares only 16 bits.
+            if (is_zero && rel == ir_relation_equal) {
+                return new_bd_loongarch64_b_cond(dbgi, block, new_l, get_zero_register(node), loongarch64_beqz);
+            } else if (is_zero && rel == ir_relation_less_greater) {
+                return new_bd_loongarch64_b_cond(dbgi, block, new_l, get_zero_register(node), loongarch64_bnez);
             }
             // Common compare
-            ir_node *const new_l     = extend_value(l);
-            ir_node *const new_r     = extend_value(r);
+            ir_node *const new_r     = is_zero ? get_zero_register(node) : extend_value(r);
             bool           need_swap = false;
             switch (rel) {
             case ir_relation_equal: {
@@ -475,19 +1038,111 @@ TRANS_FUNC(Cond) {
             }
             return need_swap ? new_bd_loongarch64_b_cond(dbgi, block, new_r, new_l, cond)
                              : new_bd_loongarch64_b_cond(dbgi, block, new_l, new_r, cond);
+        } else if (mode_is_float(mode)) {
+            ir_node *const fcmp = transform_float_cmp(sel);
+            return new_bd_loongarch64_b_fcc(dbgi, block, fcmp);
         }
     }
     TODO(node);
 }
 
+// Matches `x < 0 ? -x : x` and its variants.
+static ir_node *match_abs(ir_node *const sel, ir_node *const f_val, ir_node *const t_val) {
+    if (!is_Cmp(sel))
+        return NULL;
+    ir_node       *l   = get_Cmp_left(sel);
+    ir_relation    rel = get_Cmp_relation(sel) & ir_relation_less_equal_greater;
+    ir_mode *const mode = get_irn_mode(l);
+    if (!mode_is_int(mode) || !mode_is_signed(mode) || get_irn_mode(t_val) != mode)
+        return NULL;
+    if (get_mode_size_bits(mode) != 32 && get_mode_size_bits(mode) != 64)
+        return NULL;
+    if (!match_zero_cmp(&l, get_Cmp_right(sel), &rel))
+        return NULL;
+    if (rel == ir_relation_less || rel == ir_relation_less_equal) {
+        if (f_val == l && is_Minus(t_val) && get_Minus_op(t_val) == l)
+            return l;
+    } else if (rel == ir_relation_greater || rel == ir_relation_greater_equal) {
+        if (t_val == l && is_Minus(f_val) && get_Minus_op(f_val) == l)
+            return l;
+    }
+    return NULL;
+}
+
 TRANS_FUNC(Mux) {
-    dbg_info *const dbgi   = get_irn_dbg_info(node);
-    ir_node *const  block  = be_transform_nodes_block(node);
-    ir_node *const  sel    = be_transform_node(get_Mux_sel(node));
-    ir_node *const  f_val  = be_transform_node(get_Mux_false(node));
-    ir_node *const  f_copy = be_new_Copy(block, f_val);
-    ir_node *const  t_val  = be_transform_node(get_Mux_true(node));
-    return new_bd_loongarch64_mux(dbgi, block, sel, f_copy, t_val);
+    if (mode_is_float(get_irn_mode(node))) {
+        dbg_info *const dbgi  = get_irn_dbg_info(node);
+        ir_node *const  block = be_transform_nodes_block(node);
+        ir_node *const  sel   = get_Mux_sel(node);
+        ir_node        *flags;
+        if (is_float_Cmp(sel)) {
+            flags = transform_float_cmp(sel);
+        } else {
+            flags = new_bd_loongarch64_movgr2cf(dbgi, block, be_transform_node(sel));
+        }
+        ir_node *const f_val = be_transform_node(get_Mux_false(node));
+        ir_node *const t_val = be_transform_node(get_Mux_true(node));
+        return new_bd_loongarch64_fsel(dbgi, block, f_val, t_val, flags);
+    }
+
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    ir_node *const  sel   = get_Mux_sel(node);
+    ir_node        *f_val = get_Mux_false(node);
+    ir_node        *t_val = get_Mux_true(node);
+
+    // |x| = (x ^ (x >> 63)) - (x >> 63)
+    ir_node *const abs_op = match_abs(sel, f_val, t_val);
+    if (abs_op) {
+        ir_node *const op = be_transform_node(abs_op);
+        if (get_mode_size_bits(get_irn_mode(abs_op)) == 32) {
+            ir_node *const sign = new_bd_loongarch64_srai_w(dbgi, block, op, NULL, 31);
+            ir_node *const flip = new_bd_loongarch64_xor(dbgi, block, op, sign);
+            return new_bd_loongarch64_sub_w(dbgi, block, flip, sign);
+        }
+        ir_node *const sign = new_bd_loongarch64_srai_d(dbgi, block, op, NULL, 63);
+        ir_node *const flip = new_bd_loongarch64_xor(dbgi, block, op, sign);
+        return new_bd_loongarch64_sub_d(dbgi, block, flip, sign);
+    }
+
+    // Compares already are 0 or 1.
+    if (is_irn_null(f_val) && is_irn_one(t_val))
+        return be_transform_node(sel);
+    if (is_irn_one(f_val) && is_irn_null(t_val))
+        return new_bd_loongarch64_xori(dbgi, block, be_transform_node(sel), NULL, 1);
+
+    // Test a value against zero directly instead of materializing the compare,
+    // and swap the operands instead of negating the compare.
+    ir_node *cond = NULL;
+    bool     swap = false;
+    if (is_Cmp(sel) && be_mode_needs_gp_reg(get_irn_mode(get_Cmp_left(sel)))) {
+        ir_node    *l   = get_Cmp_left(sel);
+        ir_relation rel = get_Cmp_relation(sel) & ir_relation_less_equal_greater;
+        if (match_zero_cmp(&l, get_Cmp_right(sel), &rel) &&
+            (rel == ir_relation_equal || rel == ir_relation_less_greater)) {
+            cond = extend_value(l);
+            swap = rel == ir_relation_equal;
+        } else {
+            cond = transform_int_cmp_inverted(sel, get_Cmp_left(sel), get_Cmp_right(sel),
+                                              get_Cmp_relation(sel) & ir_relation_less_equal_greater, &swap);
+        }
+    } else {
+        cond = be_transform_node(sel);
+    }
+    if (swap) {
+        ir_node *const t = f_val;
+        f_val            = t_val;
+        t_val            = t;
+    }
+
+    // maskeqz: %D0 = %S1 != 0 ? %S0 : 0, masknez: %D0 = %S1 == 0 ? %S0 : 0
+    if (is_irn_null(f_val))
+        return new_bd_loongarch64_maskeqz(dbgi, block, be_transform_node(t_val), cond);
+    if (is_irn_null(t_val))
+        return new_bd_loongarch64_masknez(dbgi, block, be_transform_node(f_val), cond);
+    ir_node *const t_part = new_bd_loongarch64_maskeqz(dbgi, block, be_transform_node(t_val), cond);
+    ir_node *const f_part = new_bd_loongarch64_masknez(dbgi, block, be_transform_node(f_val), cond);
+    return new_bd_loongarch64_or(dbgi, block, t_part, f_part);
 }
 
 // ------------------- Control Flow -------------------
@@ -500,7 +1155,33 @@ TRANS_FUNC(Jmp) {
     return new_bd_loongarch64_b(dbgi, new_block);
 }
 
-TRANS_FUNC(Switch) { TODO(node); }
+// The table holds 32-bit offsets of the targets relative to the table itself:
+//   la.local $t, TBL
+//   alsl.d   $o, $sel, $t, 2
+//   ld.w     $o, $o, 0
+//   add.d    $o, $o, $t
+//   jr       $o
+TRANS_FUNC(Switch) {
+    ir_graph *const              irg   = get_irn_irg(node);
+    ir_switch_table const *const table = ir_switch_table_duplicate(irg, get_Switch_table(node));
+
+    ir_type *const   utype  = get_unknown_type();
+    ident *const     id     = id_unique("TBL");
+    ir_entity *const entity = new_global_entity(irp->dummy_owner, id, utype, ir_visibility_private,
+                                                IR_LINKAGE_CONSTANT | IR_LINKAGE_NO_IDENTITY);
+
+    dbg_info *const dbgi   = get_irn_dbg_info(node);
+    ir_node *const  block  = be_transform_nodes_block(node);
+    ir_node *const  nomem  = get_irg_no_mem(irg);
+    ir_node *const  sel    = be_transform_node(get_Switch_selector(node));
+    ir_node *const  base   = new_bd_loongarch64_load_address(dbgi, block, entity, 0);
+    ir_node *const  addr   = new_bd_loongarch64_alsl_d(dbgi, block, sel, base, NULL, 2);
+    ir_node *const  load   = new_bd_loongarch64_ld_w(dbgi, block, nomem, addr, NULL, 0);
+    ir_node *const  offset = be_new_Proj(load, pn_loongarch64_ld_w_res);
+    ir_node *const  target = new_bd_loongarch64_add_d(dbgi, block, offset, base);
+    unsigned const  n_outs = get_Switch_n_outs(node);
+    return new_bd_loongarch64_switch(dbgi, block, target, n_outs, table, entity);
+}
 
 // ------------------- Calling Convention -------------------
 
@@ -508,26 +1189,45 @@ static unsigned const reg_params[] = {
     REG_A0, REG_A1, REG_A2, REG_A3, REG_A4, REG_A5, REG_A6, REG_A7,
 };
 
+static unsigned const reg_fp_params[] = {
+    REG_FA0, REG_FA1, REG_FA2, REG_FA3, REG_FA4, REG_FA5, REG_FA6, REG_FA7,
+};
+
 static unsigned const reg_results[] = {
     REG_A0,
     REG_A1,
 };
 
-static unsigned const reg_callee_saves[] = {REG_S0, REG_S1, REG_S2, REG_S3, REG_S4, REG_S5, REG_S6, REG_S7, REG_S8};
+static unsigned const reg_fp_results[] = {
+    REG_FA0,
+    REG_FA1,
+};
+
+static unsigned const reg_callee_saves[] = {
+    REG_S0,  REG_S1,  REG_S2,  REG_S3,  REG_S4,  REG_S5,  REG_S6,  REG_S7, REG_S8,
+    REG_FS0, REG_FS1, REG_FS2, REG_FS3, REG_FS4, REG_FS5, REG_FS6, REG_FS7,
+};
 
 static unsigned const reg_caller_saves[] = {
-    REG_RA, REG_T0, REG_T1, REG_T2, REG_T3, REG_T4, REG_T5, REG_T6, REG_T7,
-    REG_T8, REG_A0, REG_A1, REG_A2, REG_A3, REG_A4, REG_A5, REG_A6, REG_A7,
+    REG_RA,   REG_T0,   REG_T1,   REG_T2,   REG_T3,   REG_T4,   REG_T5,   REG_T6,   REG_T7,   REG_T8,
+    REG_A0,   REG_A1,   REG_A2,   REG_A3,   REG_A4,   REG_A5,   REG_A6,   REG_A7,   REG_FA0,  REG_FA1,
+    REG_FA2,  REG_FA3,  REG_FA4,  REG_FA5,  REG_FA6,  REG_FA7,  REG_FT0,  REG_FT1,  REG_FT2,  REG_FT3,
+    REG_FT4,  REG_FT5,  REG_FT6,  REG_FT7,  REG_FT8,  REG_FT9,  REG_FT10, REG_FT11, REG_FT12, REG_FT13,
+    REG_FT14, REG_FT15,
 };
 
 typedef struct reg_or_slot_t {
     arch_register_t const *reg;
-    unsigned               offset;
+    int                    offset; // stack offset, or save area offset of unnamed register parameters
     ir_entity             *entity;
 } reg_or_slot_t;
 
 typedef struct calling_convention_t {
     size_t         n_params;
+    size_t         n_named_params;
+    size_t         n_mem_params;
+    unsigned       va_first_slot; // argument slot of the first unnamed parameter
+    ir_entity     *va_start;
     reg_or_slot_t *parameters;
     reg_or_slot_t *results;
 } calling_convention_t;
@@ -546,71 +1246,111 @@ static void set_allocatable_regs(ir_graph *const irg) {
     for (size_t r = 0, n = ARRAY_SIZE(reg_caller_saves); r < n; ++r) {
         rbitset_set(a_regs, reg_caller_saves[r]);
     }
+    // $r21 is the scratch register of Perm lowering and the emitter.
+    assert(!rbitset_is_set(a_regs, REG_R21));
 
     birg->allocatable_regs = a_regs;
 }
 
-static void setup_calling_convention(calling_convention_t *const cconv, ir_type *const fun_type) {
-    size_t const   n_params        = get_method_n_params(fun_type);
-    size_t const   n_max_gp_params = ARRAY_SIZE(reg_params);
-    reg_or_slot_t *arr             = NULL;
+// Float-point parameters are passed in float-point argument registers. When
+// those are exhausted, they are passed in general purpose argument registers
+// and finally on the stack like integer parameters. Unnamed parameters of
+// variadic functions never use float-point registers. Aggregates have already
+// been split into registers by loongarch64_lower_parameter().
+static void setup_calling_convention(calling_convention_t *const cconv, ir_type *const fun_type,
+                                     size_t const n_named_params) {
+    size_t const   n_params     = get_method_n_params(fun_type);
+    size_t         gp_param     = 0;
+    size_t         fp_param     = 0;
+    size_t         n_mem_params = 0;
+    reg_or_slot_t *arr          = NULL;
+    assert(n_named_params <= n_params);
+    cconv->va_first_slot = LOONGARCH64_N_PARAM_REGS;
     if (n_params > 0) {
         arr = XMALLOCNZ(reg_or_slot_t, n_params);
         for (size_t i = 0; i != n_params; ++i) {
+            if (i == n_named_params) {
+                cconv->va_first_slot = gp_param + n_mem_params;
+            }
             ir_type *const param_type = get_method_param_type(fun_type, i);
             ir_mode *const param_mode = get_type_mode(param_type);
-            if (!param_mode || mode_is_float(param_mode)) {
-                panic("TODO");
-            }
-            if (i < n_max_gp_params) {
-                arr[i].reg    = &loongarch64_registers[reg_params[i]];
-                arr[i].offset = 0;
+            if (!param_mode)
+                panic("parameter %zu of %+F has a compound type, which should have been lowered", i, fun_type);
+            bool const is_named = i < n_named_params;
+            if (is_named && mode_is_float(param_mode) && fp_param < ARRAY_SIZE(reg_fp_params)) {
+                arr[i].reg = &loongarch64_registers[reg_fp_params[fp_param++]];
+            } else if (gp_param < ARRAY_SIZE(reg_params)) {
+                if (!is_named) {
+                    arr[i].offset = ((int)gp_param - LOONGARCH64_N_PARAM_REGS) * 8;
+                }
+                arr[i].reg = &loongarch64_registers[reg_params[gp_param++]];
             } else {
-                arr[i].offset = (i - n_max_gp_params) * 8;
+                arr[i].offset = n_mem_params++ * 8;
             }
         }
     }
-    cconv->n_params   = n_params;
-    cconv->parameters = arr;
-
-    size_t const n_result = get_method_n_ress(fun_type);
-    arr                   = NULL;
+    if (n_named_params == n_params) {
+        cconv->va_first_slot = gp_param + n_mem_params;
+    }
+    cconv->n_params       = n_params;
+    cconv->n_named_params = n_named_params;
+    cconv->n_mem_params   = n_mem_params;
+    cconv->va_start       = NULL;
+    cconv->parameters     = arr;
+
+    size_t const n_result  = get_method_n_ress(fun_type);
+    size_t       gp_result = 0;
+    size_t       fp_result = 0;
+    arr                    = NULL;
     if (n_result > 0) {
         arr = XMALLOCNZ(reg_or_slot_t, n_result);
         for (size_t i = 0; i != n_result; ++i) {
             ir_type *const res_type = get_method_res_type(fun_type, i);
             ir_mode *const res_mode = get_type_mode(res_type);
-            if (!res_mode || mode_is_float(res_mode)) {
-                panic("TODO");
-            }
-            if (i >= ARRAY_SIZE(reg_results)) {
-                panic("Too many gp results");
+            if (!res_mode)
+                panic("result %zu of %+F has a compound type, which should have been lowered", i, fun_type);
+            if (mode_is_float(res_mode)) {
+                if (fp_result >= ARRAY_SIZE(reg_fp_results)) {
+                    panic("Too many fp results");
+                }
+                arr[i].reg = &loongarch64_registers[reg_fp_results[fp_result++]];
+            } else {
+                if (gp_result >= ARRAY_SIZE(reg_results)) {
+                    panic("Too many gp results");
+                }
+                arr[i].reg = &loongarch64_registers[reg_results[gp_result++]];
             }
-            arr[i].reg = &loongarch64_registers[reg_results[i]];
         }
     }
     cconv->results = arr;
 }
 
+static bool is_fp_reg(arch_register_t const *const reg) {
+    return reg->cls == &loongarch64_reg_classes[CLASS_loongarch64_fp];
+}
+
 static void free_calling_convention(calling_convention_t *const cconv) {
     free(cconv->parameters);
     free(cconv->results);
 }
 
-void layout_parameter_entities(calling_convention_t *const cconv, ir_graph *const irg) {
+// Variadic functions store the unnamed register parameters in a save area
+// right below the stack parameters, so va_arg can walk all of them.
+static void layout_parameter_entities(calling_convention_t *const cconv, ir_graph *const irg,
+                                      ir_type *const fun_type) {
     ir_entity **const param_map  = be_collect_parameter_entities(irg);
     ir_type *const    frame_type = get_irg_frame_type(irg);
-    ir_entity *const  fun_ent    = get_irg_entity(irg);
-    ir_type *const    fun_type   = get_entity_type(fun_ent);
     size_t const      n_params   = get_method_n_params(fun_type);
+    // The parameters added for unnamed register arguments have no entities yet.
+    size_t const      n_declared = get_method_n_params(get_entity_type(get_irg_entity(irg)));
 
     for (size_t i = 0; i != n_params; ++i) {
         reg_or_slot_t *const param      = &cconv->parameters[i];
         ir_type *const       param_type = get_method_param_type(fun_type, i);
         if (!is_atomic_type(param_type))
             panic("unhandled parameter type");
-        ir_entity *param_ent = param_map[i];
-        if (!param->reg) {
+        ir_entity *param_ent = i < n_declared ? param_map[i] : NULL;
+        if (!param->reg || i >= cconv->n_named_params) {
             if (!param_ent)
                 param_ent = new_parameter_entity(frame_type, i, param_type);
             assert(get_entity_offset(param_ent) == INVALID_OFFSET);
@@ -619,6 +1359,51 @@ void layout_parameter_entities(calling_convention_t *const cconv, ir_graph *cons
         param->entity = param_ent;
     }
     free(param_map);
+
+    if (is_method_variadic(fun_type)) {
+        int const offset = ((int)cconv->va_first_slot - LOONGARCH64_N_PARAM_REGS) * 8;
+        cconv->va_start  = be_make_va_start_entity(frame_type, offset);
+    }
+}
+
+// Returns the number of named parameters of a call. Either the called entity
+// or, for indirect calls, the type of the call tells whether the callee is
+// variadic.
+static size_t get_n_named_params(ir_node *const call) {
+    ir_type *const fun_type = get_Call_type(call);
+    ir_node *const ptr      = get_Call_ptr(call);
+    if (is_Address(ptr)) {
+        ir_type *const callee_type = get_entity_type(get_Address_entity(ptr));
+        if (is_Method_type(callee_type) && is_method_variadic(callee_type))
+            return get_method_variadic_index(callee_type);
+    }
+    if (is_method_variadic(fun_type))
+        return get_method_variadic_index(fun_type);
+    return get_method_n_params(fun_type);
+}
+
+// Float-point arguments in general purpose registers are passed bitwise.
+static ir_node *gen_register_argument(dbg_info *const dbgi, ir_node *const block, ir_node *const arg,
+                                      arch_register_t const *const reg) {
+    ir_mode *const mode = get_irn_mode(arg);
+    if (!mode_is_float(mode))
+        return extend_value(arg);
+    ir_node *const val = be_transform_node(arg);
+    if (is_fp_reg(reg))
+        return val;
+    return get_mode_size_bits(mode) == 64 ? new_bd_loongarch64_movfr2gr_d(dbgi, block, val)
+                                          : new_bd_loongarch64_movfr2gr_s(dbgi, block, val);
+}
+
+// The results of a call are the memory, the stack and all caller-save
+// registers.
+static void set_call_out_reqs(ir_node *const call, ir_node *const sp) {
+    arch_set_irn_register_req_out(call, pn_loongarch64_call_M, arch_memory_req);
+    arch_copy_irn_out_info(call, pn_loongarch64_call_stack, sp);
+    for (size_t i = 0; i != ARRAY_SIZE(reg_caller_saves); ++i) {
+        arch_set_irn_register_req_out(call, pn_loongarch64_call_first_result + i,
+                                      loongarch64_registers[reg_caller_saves[i]].single_req);
+    }
 }
 
 TRANS_FUNC(Call) {
@@ -633,7 +1418,7 @@ TRANS_FUNC(Call) {
     // Confirm callee. Global function or function pointer.
     ir_entity     *callee;
     ir_node *const ptr = get_Call_ptr(node);
-    if (is_Address(ptr)) {
+    if (is_direct_call_target(ptr)) {
         callee = get_Address_entity(ptr);
     } else {
         callee  = NULL;
@@ -646,16 +1431,16 @@ TRANS_FUNC(Call) {
     record_returns_twice(irg, fun_type);
 
     calling_convention_t cconv;
-    setup_calling_convention(&cconv, fun_type);
+    setup_calling_convention(&cconv, fun_type, get_n_named_params(node));
 
-    size_t   n_mem_param = cconv.n_params > ARRAY_SIZE(reg_params) ? cconv.n_params - ARRAY_SIZE(reg_params) : 0;
-    ir_node *mems[1 + n_mem_param];
+    size_t const n_mem_param = cconv.n_mem_params;
+    ir_node     *mems[1 + n_mem_param];
     unsigned m = 0;
 
     ir_node *const mem = get_Call_mem(node);
     mems[m++]          = be_transform_node(mem);
 
-    int const      frame_size = n_mem_param * 16;
+    int const      frame_size = round_up2(n_mem_param * 8, 16);
     ir_node *const block      = be_transform_nodes_block(node);
     ir_node *const sp         = get_Start_sp(irg);
     ir_node *const call_frame = be_new_IncSP(block, sp, frame_size, 0);
@@ -665,15 +1450,21 @@ TRANS_FUNC(Call) {
 
     dbg_info *const dbgi = get_irn_dbg_info(node);
     for (size_t i = 0; i != n_params; ++i) {
-        ir_node *const arg = get_Call_param(node, i);
-        ir_node *const val = extend_value(arg);
-
-        reg_or_slot_t const *const param = &cconv.parameters[i];
+        ir_node *const             arg      = get_Call_param(node, i);
+        ir_mode *const             arg_mode = get_irn_mode(arg);
+        reg_or_slot_t const *const param    = &cconv.parameters[i];
         if (param->reg) {
-            ins[p]  = val;
+            ins[p]  = gen_register_argument(dbgi, block, arg, param->reg);
             reqs[p] = param->reg->single_req;
             ++p;
+        } else if (mode_is_float(arg_mode)) {
+            ir_node *const     val   = be_transform_node(arg);
+            ir_node *const     nomem = get_irg_no_mem(irg);
+            cons_storeop const cons  = get_mode_size_bits(arg_mode) == 64 ? new_bd_loongarch64_fst_d
+                                                                          : new_bd_loongarch64_fst_s;
+            mems[m++] = cons(dbgi, block, nomem, call_frame, val, NULL, param->offset);
         } else {
+            ir_node *const val   = extend_value(arg);
             ir_node *const nomem = get_irg_no_mem(irg);
             mems[m++]            = new_bd_loongarch64_st_d(dbgi, block, nomem, call_frame, val, NULL, param->offset);
         }
@@ -689,12 +1480,7 @@ TRANS_FUNC(Call) {
     ir_node *const call = callee ? new_bd_loongarch64_call(dbgi, block, p, ins, reqs, n_res, callee, 0)
                                  : new_bd_loongarch64_call_pointer(dbgi, block, p, ins, reqs, n_res);
 
-    arch_set_irn_register_req_out(call, pn_loongarch64_call_M, arch_memory_req);
-    arch_copy_irn_out_info(call, pn_loongarch64_call_stack, sp);
-    for (size_t i = 0; i != ARRAY_SIZE(reg_caller_saves); ++i) {
-        arch_set_irn_register_req_out(call, pn_loongarch64_call_first_result + i,
-                                      loongarch64_registers[reg_caller_saves[i]].single_req);
-    }
+    set_call_out_reqs(call, sp);
 
     ir_node *const call_stack = be_new_Proj(call, pn_loongarch64_call_stack);
     ir_node *const new_stack  = be_new_IncSP(block, call_stack, -frame_size, 0);
@@ -703,7 +1489,181 @@ TRANS_FUNC(Call) {
     return call;
 }
 
+static ir_entity *tls_get_addr;
+
+static ir_entity *get_tls_get_addr(void) {
+    if (!tls_get_addr) {
+        ir_type *const ptr_type = get_type_for_mode(mode_P);
+        ir_type *const fun_type = new_type_method(1, 1, false, cc_cdecl_set, mtp_no_property);
+        set_method_param_type(fun_type, 0, ptr_type);
+        set_method_res_type(fun_type, 0, ptr_type);
+        tls_get_addr = create_compilerlib_entity("__tls_get_addr", fun_type);
+    }
+    return tls_get_addr;
+}
+
+// General-dynamic model: __tls_get_addr returns the address of the entity,
+// whose module and offset it reads from the GOT entry passed in $a0.
+static ir_node *gen_tls_get_addr(dbg_info *const dbgi, ir_node *const block, ir_entity *const entity) {
+    ir_entity *const callee = get_tls_get_addr();
+
+    ir_graph *const irg = get_irn_irg(block);
+    ir_node *const  sp  = get_Start_sp(irg);
+    ir_node *const  in[] = {
+        [n_loongarch64_call_mem]            = get_irg_no_mem(irg),
+        [n_loongarch64_call_stack]          = sp,
+        [n_loongarch64_call_first_argument] = new_bd_loongarch64_tls_gd(dbgi, block, entity, 0),
+    };
+    arch_register_req_t const **const reqs = be_allocate_in_reqs(irg, ARRAY_SIZE(in));
+    reqs[n_loongarch64_call_mem]            = arch_memory_req;
+    reqs[n_loongarch64_call_stack]          = &loongarch64_single_reg_req_gp_sp;
+    reqs[n_loongarch64_call_first_argument] = &loongarch64_single_reg_req_gp_a0;
+
+    unsigned const n_res = pn_loongarch64_call_first_result + ARRAY_SIZE(reg_caller_saves);
+    ir_node *const call  = new_bd_loongarch64_call(dbgi, block, ARRAY_SIZE(in), in, reqs, n_res, callee, 0);
+    set_call_out_reqs(call, sp);
+
+    ir_node *const call_stack = be_new_Proj(call, pn_loongarch64_call_stack);
+    be_stack_record_chain(&stack_env, call, n_loongarch64_call_stack, call_stack);
+    return be_new_Proj(call, be_get_out_for_reg(call, &loongarch64_registers[REG_A0]));
+}
+
+// Position independent code cannot know the offset of the TLS block of its
+// module and asks __tls_get_addr. Executables know the offsets of their own
+// entities at link time and load the ones of shared libraries from the GOT.
+static ir_node *gen_tls_address(dbg_info *const dbgi, ir_node *const block, ir_entity *const entity) {
+    if (ir_platform.pic_style != BE_PIC_NONE)
+        return gen_tls_get_addr(dbgi, block, entity);
+    ir_node *const tp = be_get_Start_proj(get_irn_irg(block), &loongarch64_registers[REG_TP]);
+    if (entity_has_definition(entity))
+        return new_bd_loongarch64_tls_le(dbgi, block, tp, entity, 0);
+    return new_bd_loongarch64_tls_ie(dbgi, block, tp, entity, 0);
+}
+
+// Returns true if nothing but `ret` uses the memory and the results of `call`.
+static bool is_only_used_by(ir_node const *const call, ir_node const *const ret) {
+    foreach_out_edge(call, edge) {
+        ir_node *const proj = get_edge_src_irn(edge);
+        switch (get_Proj_num(proj)) {
+        case pn_Call_M:
+            if (get_irn_n_edges(proj) != 1)
+                return false;
+            break;
+        case pn_Call_T_result:
+            foreach_out_edge(proj, res_edge) {
+                foreach_out_edge(get_edge_src_irn(res_edge), user_edge) {
+                    if (get_edge_src_irn(user_edge) != ret)
+                        return false;
+                }
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the call, which `node` directly returns the results of, if it can
+// be turned into a tail call. The callee must not take stack arguments, which
+// would overwrite our own ones, and our frame must not contain anything the
+// callee could have got the address of.
+static ir_node *find_tail_call(ir_node *const node) {
+    ir_node *const mem = get_Return_mem(node);
+    if (!is_Proj(mem))
+        return NULL;
+    ir_node *const call = get_Proj_pred(mem);
+    if (!is_Call(call) || get_nodes_block(call) != get_nodes_block(node) || ir_throws_exception(call))
+        return NULL;
+
+    ir_graph *const irg       = get_irn_irg(node);
+    ir_type *const  call_type = get_Call_type(call);
+    if (is_method_variadic(get_entity_type(get_irg_entity(irg)))
+        || (get_method_additional_properties(call_type) & mtp_property_returns_twice)
+        || !is_only_used_by(call, node))
+        return NULL;
+
+    // Stack parameters live in the frame of our caller, which stays intact.
+    ir_type *const frame_type = get_irg_frame_type(irg);
+    for (size_t i = 0, n = get_compound_n_members(frame_type); i != n; ++i) {
+        ir_entity *const member = get_compound_member(frame_type, i);
+        if (!is_parameter_entity(member) || get_entity_offset(member) == INVALID_OFFSET)
+            return NULL;
+    }
+
+    calling_convention_t callee_cconv;
+    setup_calling_convention(&callee_cconv, call_type, get_n_named_params(call));
+    bool valid = callee_cconv.n_mem_params == 0;
+    for (size_t i = 0, n = get_Return_n_ress(node); valid && i != n; ++i) {
+        ir_node *const res  = get_Return_res(node, i);
+        ir_node *const pred = is_Proj(res) ? get_Proj_pred(res) : NULL;
+        valid = pred && is_Proj(pred) && get_Proj_pred(pred) == call
+             && callee_cconv.results[get_Proj_num(res)].reg == cconv.results[i].reg;
+    }
+    free_calling_convention(&callee_cconv);
+    return valid ? call : NULL;
+}
+
+// Jumps to the callee after the epilogue, the callee returns directly to our
+// caller. Like Return, this keeps the callee-save registers alive.
+static ir_node *gen_tail_call(ir_node *const node, ir_node *const call) {
+    ir_graph *const irg      = get_irn_irg(node);
+    ir_node *const  ptr      = get_Call_ptr(call);
+    ir_entity      *callee   = is_direct_call_target(ptr) ? get_Address_entity(ptr) : NULL;
+    unsigned        p        = callee ? n_loongarch64_tail_call_first_argument
+                                      : n_loongarch64_tail_call_pointer_first_argument;
+    unsigned const  n_params = get_Call_n_params(call);
+    unsigned const  n_ins    = p + n_params + ARRAY_SIZE(reg_callee_saves);
+
+    arch_register_req_t const **const reqs = be_allocate_in_reqs(irg, n_ins);
+    ir_node **const                   in   = ALLOCAN(ir_node *, n_ins);
+
+    in[n_loongarch64_tail_call_mem]   = be_transform_node(get_Call_mem(call));
+    reqs[n_loongarch64_tail_call_mem] = arch_memory_req;
+
+    in[n_loongarch64_tail_call_stack]   = get_Start_sp(irg);
+    reqs[n_loongarch64_tail_call_stack] = &loongarch64_single_reg_req_gp_sp;
+
+    arch_register_t const *const ra = &loongarch64_registers[REG_RA];
+    in[n_loongarch64_tail_call_addr]   = be_get_Start_proj(irg, ra);
+    reqs[n_loongarch64_tail_call_addr] = ra->single_req;
+
+    if (!callee) {
+        in[n_loongarch64_tail_call_pointer_target]   = be_transform_node(ptr);
+        reqs[n_loongarch64_tail_call_pointer_target] = &loongarch64_class_reg_req_gp;
+    }
+
+    calling_convention_t callee_cconv;
+    setup_calling_convention(&callee_cconv, get_Call_type(call), get_n_named_params(call));
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    for (size_t i = 0; i != n_params; ++i) {
+        arch_register_t const *const reg = callee_cconv.parameters[i].reg;
+        in[p]                            = gen_register_argument(dbgi, block, get_Call_param(call, i), reg);
+        reqs[p]                          = reg->single_req;
+        ++p;
+    }
+    free_calling_convention(&callee_cconv);
+
+    for (size_t i = 0; i != ARRAY_SIZE(reg_callee_saves); ++i) {
+        arch_register_t const *const reg = &loongarch64_registers[reg_callee_saves[i]];
+        in[p]                            = be_get_Start_proj(irg, reg);
+        reqs[p]                          = reg->single_req;
+        ++p;
+    }
+
+    assert(p == n_ins);
+    ir_node *const tail = callee ? new_bd_loongarch64_tail_call(dbgi, block, n_ins, in, reqs, callee, 0)
+                                 : new_bd_loongarch64_tail_call_pointer(dbgi, block, n_ins, in, reqs);
+    be_stack_record_chain(&stack_env, tail, n_loongarch64_tail_call_stack, NULL);
+    return tail;
+}
+
 TRANS_FUNC(Return) {
+    ir_node *const call = find_tail_call(node);
+    if (call)
+        return gen_tail_call(node, call);
+
     unsigned       p     = n_loongarch64_return_first_result;
     unsigned const n_res = get_Return_n_ress(node);
     unsigned const n_ins = p + n_res + ARRAY_SIZE(reg_callee_saves);
@@ -747,14 +1707,12 @@ TRANS_FUNC(Return) {
 
 TRANS_FUNC(Start) {
     be_start_out outs[N_LOONGARCH64_REGISTERS] = {
-        [REG_ZERO] = BE_START_IGNORE, [REG_SP] = BE_START_IGNORE, [REG_TP] = BE_START_NO,
+        [REG_ZERO] = BE_START_IGNORE, [REG_SP] = BE_START_IGNORE, [REG_TP] = BE_START_IGNORE,
         [REG_R21] = BE_START_NO,      [REG_RA] = BE_START_REG,
     };
     /* function parameters in registers */
-    ir_graph *const  irg  = get_irn_irg(node);
-    ir_entity *const ent  = get_irg_entity(irg);
-    ir_type *const   type = get_entity_type(ent);
-    for (size_t i = 0, n = get_method_n_params(type); i != n; ++i) {
+    ir_graph *const irg = get_irn_irg(node);
+    for (size_t i = 0; i != cconv.n_params; ++i) {
         arch_register_t const *const reg = cconv.parameters[i].reg;
         if (reg)
             outs[reg->global_index] = BE_START_REG;
@@ -769,11 +1727,273 @@ TRANS_FUNC(Start) {
 
 // ------------------- Misc -------------------
 
+static void loongarch64_parse_constraint_letter(void const *const env, be_asm_constraint_t *const c, char const l) {
+    (void)env;
+
+    switch (l) {
+    case 'g':
+        c->all_registers_allowed = true;
+        c->memory_possible       = true;
+        /* FALLTHROUGH */
+    case 'I':
+    case 'J':
+    case 'K':
+    case 'i':
+    case 'n':
+        c->cls            = &loongarch64_reg_classes[CLASS_loongarch64_gp];
+        c->immediate_type = l;
+        break;
+
+    case 'm':
+        c->memory_possible = true;
+        break;
+
+    case 'r':
+        c->cls                   = &loongarch64_reg_classes[CLASS_loongarch64_gp];
+        c->all_registers_allowed = true;
+        break;
+
+    case 'f':
+        c->cls                   = &loongarch64_reg_classes[CLASS_loongarch64_fp];
+        c->all_registers_allowed = true;
+        break;
+
+    default:
+        panic("unknown asm constraint '%c'", l);
+    }
+}
+
+static bool loongarch64_check_immediate_constraint(int64_t const val, char const imm_type) {
+    switch (imm_type) {
+    case 'I': return is_simm12(val);
+    case 'J': return val == 0;
+    case 'K': return 0 <= val && val < 4096;
+
+    case 'g':
+    case 'i':
+    case 'n': return true;
+    default:
+        panic("invalid immediate constraint found");
+    }
+}
+
+static bool loongarch64_match_immediate(loongarch64_asm_operand_t *const operand, ir_node *const node,
+                                        char const imm_type) {
+    ir_tarval *offset;
+    ir_entity *entity;
+    unsigned   reloc_kind;
+    if (!be_match_immediate(node, &offset, &entity, &reloc_kind))
+        return false;
+    assert(reloc_kind == 0);
+
+    if (entity && imm_type != 'g' && imm_type != 'i')
+        return false;
+
+    int64_t value = 0;
+    if (offset) {
+        value = get_tarval_long(offset);
+        if (!loongarch64_check_immediate_constraint(value, imm_type))
+            return false;
+    }
+
+    operand->val = value;
+    operand->ent = entity;
+    return true;
+}
+
+TRANS_FUNC(ASM) {
+    be_asm_info_t info = be_asm_prepare_info(node);
+
+    ir_asm_constraint const *const   constraints   = get_ASM_constraints(node);
+    size_t const                     n_constraints = get_ASM_n_constraints(node);
+    ir_graph *const                  irg           = get_irn_irg(node);
+    struct obstack *const            obst          = get_irg_obstack(irg);
+    loongarch64_asm_operand_t *const operands      = NEW_ARR_DZ(loongarch64_asm_operand_t, obst, n_constraints);
+    for (size_t i = 0; i != n_constraints; ++i) {
+        ir_asm_constraint const *const c = &constraints[i];
+
+        be_asm_constraint_t be_constraint;
+        be_parse_asm_constraints_internal(&be_constraint, c->constraint, &loongarch64_parse_constraint_letter, NULL);
+
+        loongarch64_asm_operand_t *const op = &operands[i];
+
+        int const in_pos = c->in_pos;
+        if (in_pos >= 0) {
+            ir_node *const in  = get_ASM_input(node, in_pos);
+            char const     imm = be_constraint.immediate_type;
+            if (imm != '\0' && loongarch64_match_immediate(op, in, imm)) {
+                be_asm_add_immediate(&op->op);
+            } else if (be_constraint.same_as >= 0) {
+                int const                        out_pos = operands[be_constraint.same_as].op.pos;
+                arch_register_req_t const *const ireq    = info.out_reqs[out_pos];
+                be_asm_add_inout(&info, &op->op, obst, in, ireq, out_pos);
+            } else if (be_constraint.cls) {
+                arch_register_req_t const *const ireq = be_make_register_req(obst, &be_constraint);
+                be_asm_add_inout(&info, &op->op, obst, in, ireq, c->out_pos);
+            } else {
+                ir_node *const                   new_in = be_transform_node(in);
+                arch_register_req_t const *const ireq   = arch_get_irn_register_req(new_in)->cls->class_req;
+                be_asm_add_in(&info, &op->op, BE_ASM_OPERAND_MEMORY, new_in, ireq);
+            }
+        } else {
+            be_asm_add_out(&info, &op->op, obst, &be_constraint, c->out_pos);
+        }
+    }
+
+    return be_make_asm(node, &info, operands);
+}
+
+// The va_list points to the first unnamed parameter in the register save area
+// or in the stack parameters.
+static ir_node *gen_va_start(ir_node *const node) {
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    ir_graph *const irg   = get_irn_irg(node);
+    return new_bd_loongarch64_addi_d(dbgi, block, get_Start_sp(irg), cconv.va_start, 0);
+}
+
+// clz, ctz in the width of the parameter
+static ir_node *gen_bit_count(ir_node *const node, new_uniop_func const cons_w, new_uniop_func const cons_d) {
+    ir_node *const  param = get_Builtin_param(node, 0);
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    ir_node *const  op    = be_transform_node(param);
+    return (get_mode_size_bits(get_irn_mode(param)) == 64 ? cons_d : cons_w)(dbgi, block, op);
+}
+
+// ffs(x) = x == 0 ? 0 : ctz(x) + 1
+static ir_node *gen_ffs(ir_node *const node) {
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    ir_node *const  ctz   = gen_bit_count(node, new_bd_loongarch64_ctz_w, new_bd_loongarch64_ctz_d);
+    ir_node *const  inc   = new_bd_loongarch64_addi_d(dbgi, block, ctz, NULL, 1);
+    ir_node *const  op    = be_transform_node(get_Builtin_param(node, 0));
+    return new_bd_loongarch64_maskeqz(dbgi, block, inc, op);
+}
+
+// Counts the bits of the lowest LSX vector element, narrow values are zero
+// extended first.
+static ir_node *gen_popcount(ir_node *const node) {
+    ir_node *const  param = get_Builtin_param(node, 0);
+    ir_mode *const  mode  = get_irn_mode(param);
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    ir_node *const  op    = convert_value(dbgi, param, find_unsigned_mode(mode));
+    ir_node *const  vec   = new_bd_loongarch64_movgr2fr_d(dbgi, block, op);
+    if (get_mode_size_bits(mode) == 64) {
+        ir_node *const cnt = new_bd_loongarch64_vpcnt_d(dbgi, block, vec);
+        return new_bd_loongarch64_movfr2gr_d(dbgi, block, cnt);
+    }
+    ir_node *const cnt = new_bd_loongarch64_vpcnt_w(dbgi, block, vec);
+    return new_bd_loongarch64_movfr2gr_s(dbgi, block, cnt);
+}
+
+static ir_node *gen_parity(ir_node *const node) {
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    return new_bd_loongarch64_andi(dbgi, block, gen_popcount(node), NULL, 1);
+}
+
+static ir_node *gen_bswap(ir_node *const node) {
+    ir_node *const  param = get_Builtin_param(node, 0);
+    ir_mode *const  mode  = get_irn_mode(param);
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    ir_node *const  op    = be_transform_node(param);
+    switch (get_mode_size_bits(mode)) {
+    case 16: {
+        // The upper halfword holds the swapped extension bits
+        ir_node *const rev = new_bd_loongarch64_revb_2h(dbgi, block, op);
+        return mode_is_signed(mode) ? new_bd_loongarch64_sext_h(dbgi, block, rev) : rev;
+    }
+    case 32: {
+        // Unlike revb.2w, this keeps the result sign extended
+        ir_node *const rev = new_bd_loongarch64_revb_2h(dbgi, block, op);
+        return new_bd_loongarch64_rotri_w(dbgi, block, rev, NULL, 16);
+    }
+    case 64:
+        return new_bd_loongarch64_revb_d(dbgi, block, op);
+    }
+    panic("unexpected bswap mode %+F", mode);
+}
+
+// The locality is ignored, preld only distinguishes loads and stores.
+static ir_node *gen_prefetch(ir_node *const node) {
+    size_t const           n_params = get_Builtin_n_params(node);
+    long const             rw       = n_params > 1 ? get_Const_long(get_Builtin_param(node, 1)) : 0;
+    dbg_info *const        dbgi     = get_irn_dbg_info(node);
+    ir_node *const         block    = be_transform_nodes_block(node);
+    ir_node *const         mem      = be_transform_node(get_Builtin_mem(node));
+    loongarch64_addr const addr     = make_addr(get_Builtin_param(node, 0), block, false);
+    ir_node               *base     = addr.base;
+    if (addr.index)
+        base = new_bd_loongarch64_add_d(dbgi, block, addr.base, addr.index);
+    cons_loadop const cons = rw ? new_bd_loongarch64_preld_store : new_bd_loongarch64_preld_load;
+    return cons(dbgi, block, mem, base, addr.ent, addr.val);
+}
+
+static ir_node *gen_compare_swap(ir_node *const node) {
+    ir_node *const old  = get_Builtin_param(node, 1);
+    ir_mode *const mode = get_irn_mode(old);
+    unsigned const size = get_mode_size_bits(mode);
+    if (size != 32 && size != 64)
+        TODO(node);
+    dbg_info *const dbgi    = get_irn_dbg_info(node);
+    ir_node *const  block   = be_transform_nodes_block(node);
+    ir_node *const  mem     = be_transform_node(get_Builtin_mem(node));
+    ir_node *const  ptr     = be_transform_node(get_Builtin_param(node, 0));
+    ir_node *const  new_old = be_transform_node(old);
+    ir_node *const  new_new = be_transform_node(get_Builtin_param(node, 2));
+    if (size == 64)
+        return new_bd_loongarch64_cas_d(dbgi, block, mem, ptr, new_old, new_new);
+    // ll.w sign extends the loaded word, which bne compares with all 64 bits
+    // of `old`. An unsigned `old` may be zero extended, e.g. by ld.wu.
+    ir_node *const sext_old = new_bd_loongarch64_sext_w(dbgi, block, new_old);
+    return new_bd_loongarch64_cas_w(dbgi, block, mem, ptr, sext_old, new_new);
+}
+
+static ir_node *gen_break(ir_node *const node) {
+    dbg_info *const dbgi  = get_irn_dbg_info(node);
+    ir_node *const  block = be_transform_nodes_block(node);
+    ir_node *const  mem   = be_transform_node(get_Builtin_mem(node));
+    return new_bd_loongarch64_break(dbgi, block, mem, NULL, 0);
+}
+
+TRANS_FUNC(Builtin) {
+    switch (get_Builtin_kind(node)) {
+    case ir_bk_bswap:
+        return gen_bswap(node);
+    case ir_bk_clz:
+        return gen_bit_count(node, new_bd_loongarch64_clz_w, new_bd_loongarch64_clz_d);
+    case ir_bk_compare_swap:
+        return gen_compare_swap(node);
+    case ir_bk_ctz:
+        return gen_bit_count(node, new_bd_loongarch64_ctz_w, new_bd_loongarch64_ctz_d);
+    case ir_bk_debugbreak:
+    case ir_bk_trap:
+        return gen_break(node);
+    case ir_bk_ffs:
+        return gen_ffs(node);
+    case ir_bk_parity:
+        return gen_parity(node);
+    case ir_bk_popcount:
+        return gen_popcount(node);
+    case ir_bk_prefetch:
+        return gen_prefetch(node);
+    case ir_bk_va_start:
+        return gen_va_start(node);
+    default:
+        TODO(node);
+    }
+}
+
 TRANS_FUNC(Phi) {
     ir_mode                   *mode = get_irn_mode(node);
     const arch_register_req_t *req;
     if (be_mode_needs_gp_reg(mode)) {
         req = &loongarch64_class_reg_req_gp;
+    } else if (mode_is_float(mode)) {
+        req = &loongarch64_class_reg_req_fp;
     } else if (mode == mode_M) {
         req = arch_memory_req;
     } else {
@@ -788,12 +2008,50 @@ TRANS_FUNC(Unknown) {
     ir_mode *const mode  = get_irn_mode(node);
     if (be_mode_needs_gp_reg(mode)) {
         return be_new_Unknown(block, &loongarch64_class_reg_req_gp);
+    } else if (mode_is_float(mode)) {
+        return be_new_Unknown(block, &loongarch64_class_reg_req_fp);
     }
     TODO(node);
 }
 
 // ------------------- Projections -------------------
 
+TRANS_FUNC(Proj_Builtin) {
+    ir_node *const pred = get_Proj_pred(node);
+    switch (get_Builtin_kind(pred)) {
+    case ir_bk_bswap:
+    case ir_bk_clz:
+    case ir_bk_ctz:
+    case ir_bk_ffs:
+    case ir_bk_parity:
+    case ir_bk_popcount:
+    case ir_bk_va_start:
+        if (get_Proj_num(node) == pn_Builtin_M)
+            return be_transform_node(get_Builtin_mem(pred));
+        assert(get_Proj_num(node) == pn_Builtin_max + 1);
+        return be_transform_node(pred);
+    case ir_bk_compare_swap: {
+        // Both widths share the projection numbers
+        ir_node *const new_pred = be_transform_node(pred);
+        if (get_Proj_num(node) == pn_Builtin_M)
+            return be_new_Proj(new_pred, pn_loongarch64_cas_w_M);
+        assert(get_Proj_num(node) == pn_Builtin_max + 1);
+        ir_node *const res = be_new_Proj(new_pred, pn_loongarch64_cas_w_res);
+        // Like ld.wu, zero extend the sign extended result of ll.w.
+        if (get_irn_mode(node) == mode_Iu)
+            return new_bd_loongarch64_zext_w(get_irn_dbg_info(node), get_nodes_block(new_pred), res);
+        return res;
+    }
+    case ir_bk_debugbreak:
+    case ir_bk_prefetch:
+    case ir_bk_trap:
+        assert(get_Proj_num(node) == pn_Builtin_M);
+        return be_transform_node(pred);
+    default:
+        TODO(node);
+    }
+}
+
 TRANS_FUNC(Proj_Call) {
     ir_node *const pred = get_Proj_pred(node);
     ir_node *const call = be_transform_node(pred);
@@ -840,7 +2098,7 @@ TRANS_FUNC(Proj_Proj_Call) {
     ir_type *const fun_type = get_Call_type(ocall);
 
     calling_convention_t cconv;
-    setup_calling_convention(&cconv, fun_type);
+    setup_calling_convention(&cconv, fun_type, get_n_named_params(ocall));
 
     ir_node *const               call = be_transform_node(ocall);
     unsigned const               num  = get_Proj_num(node);
@@ -858,14 +2116,30 @@ TRANS_FUNC(Proj_Proj_Start) {
     ir_graph *const      irg   = get_irn_irg(node);
     unsigned const       num   = get_Proj_num(node);
     reg_or_slot_t *const param = &cconv.parameters[num];
+    ir_mode *const       mode  = get_irn_mode(node);
     if (param->reg) {
-        return be_get_Start_proj(irg, param->reg);
+        ir_node *const val = be_get_Start_proj(irg, param->reg);
+        if (mode_is_float(mode) && !is_fp_reg(param->reg)) {
+            // Float-point parameter passed in general purpose register
+            dbg_info *const dbgi  = get_irn_dbg_info(node);
+            ir_node *const  block = be_transform_nodes_block(node);
+            if (get_mode_size_bits(mode) == 32) {
+                return new_bd_loongarch64_movgr2fr_w(dbgi, block, val);
+            }
+            return new_bd_loongarch64_movgr2fr_d(dbgi, block, val);
+        }
+        return val;
     } else {
         dbg_info *const dbgi  = get_irn_dbg_info(node);
         ir_node *const  block = be_transform_nodes_block(node);
         ir_node *const  mem   = be_get_Start_mem(irg);
         ir_node *const  base  = get_Start_sp(irg);
-        ir_node *const  load  = new_bd_loongarch64_ld_d(dbgi, block, mem, base, param->entity, 0);
+        if (mode_is_float(mode)) {
+            cons_loadop const cons = get_mode_size_bits(mode) == 32 ? new_bd_loongarch64_fld_s : new_bd_loongarch64_fld_d;
+            ir_node *const    load = cons(dbgi, block, mem, base, param->entity, 0);
+            return be_new_Proj(load, pn_loongarch64_fld_d_res);
+        }
+        ir_node *const load = new_bd_loongarch64_ld_d(dbgi, block, mem, base, param->entity, 0);
         return be_new_Proj(load, pn_loongarch64_ld_d_res);
     }
 }
@@ -921,6 +2195,79 @@ TRANS_FUNC(Proj_Start) {
     TODO(node);
 }
 
+// Returns a copy of the method type with parameters added for the general
+// purpose argument registers, that may hold unnamed arguments of a variadic
+// function. The copy is only used to set up the calling convention, the entity
+// keeps its type.
+static ir_type *add_unnamed_register_params(ir_type *const mtp, unsigned const va_first_slot) {
+    if (va_first_slot >= LOONGARCH64_N_PARAM_REGS)
+        return mtp;
+
+    size_t const                    n_params     = get_method_n_params(mtp);
+    size_t const                    n_ress       = get_method_n_ress(mtp);
+    size_t const                    new_n_params = n_params + LOONGARCH64_N_PARAM_REGS - va_first_slot;
+    unsigned const                  cc_mask      = get_method_calling_convention(mtp);
+    mtp_additional_properties const props        = get_method_additional_properties(mtp);
+    ir_type *const                  new_mtp      = new_type_method(new_n_params, n_ress, true, cc_mask, props);
+    set_method_variadic_index(new_mtp, get_method_variadic_index(mtp));
+    set_type_dbg_info(new_mtp, get_type_dbg_info(mtp));
+
+    for (size_t i = 0; i != n_ress; ++i) {
+        set_method_res_type(new_mtp, i, get_method_res_type(mtp, i));
+    }
+    for (size_t i = 0; i != n_params; ++i) {
+        set_method_param_type(new_mtp, i, get_method_param_type(mtp, i));
+    }
+    ir_type *const gp_type = get_type_for_mode(mode_Lu);
+    for (size_t i = n_params; i != new_n_params; ++i) {
+        set_method_param_type(new_mtp, i, gp_type);
+    }
+
+    return new_mtp;
+}
+
+// Stores the parameters, whose address is taken, to their frame entities.
+static void add_parameter_entity_stores(calling_convention_t const *const cconv, ir_graph *const irg) {
+    ir_type *const    frame_type = get_irg_frame_type(irg);
+    size_t const      n_members  = get_compound_n_members(frame_type);
+    ir_entity **const entities   = XMALLOCN(ir_entity *, n_members);
+    unsigned          n_entities = 0;
+    for (size_t i = 0; i != n_members; ++i) {
+        ir_entity *const entity = get_compound_member(frame_type, i);
+        if (!is_parameter_entity(entity))
+            continue;
+        size_t const num = get_entity_parameter_number(entity);
+        if (num == IR_VA_START_PARAMETER_NUMBER)
+            continue;
+        if (get_entity_offset(entity) == INVALID_OFFSET && num < cconv->n_named_params)
+            entities[n_entities++] = entity;
+    }
+    be_add_parameter_entity_stores_list(irg, n_entities, entities);
+    free(entities);
+}
+
+// Stores the general purpose argument registers, which may hold unnamed
+// arguments, to the save area. No firm parameter stands for them, so the stores
+// are added after the transformation, in front of all other memory operations.
+static void store_unnamed_register_params(calling_convention_t const *const cconv, ir_graph *const irg) {
+    ir_node *const block       = get_irg_start_block(irg);
+    ir_node *const sp          = get_Start_sp(irg);
+    ir_node *const initial_mem = get_irg_initial_mem(irg);
+    ir_node       *mem         = initial_mem;
+    ir_node       *first_store = NULL;
+    for (size_t i = cconv->n_named_params; i != cconv->n_params; ++i) {
+        reg_or_slot_t const *const param = &cconv->parameters[i];
+        ir_node *const             value = be_get_Start_proj(irg, param->reg);
+        mem = new_bd_loongarch64_st_d(NULL, block, mem, sp, value, param->entity, 0);
+        if (!first_store)
+            first_store = mem;
+    }
+    if (mem != initial_mem) {
+        edges_reroute_except(initial_mem, mem, first_store);
+        set_irg_initial_mem(irg, initial_mem);
+    }
+}
+
 static void loongarch64_register_transformers(void) {
     be_start_transform_setup();
 
@@ -947,6 +2294,7 @@ static void loongarch64_register_transformers(void) {
     // Load/Store or Memory related
     be_set_transform_function(op_Load, gen_Load);
     be_set_transform_function(op_Store, gen_Store);
+    be_set_transform_function(op_CopyB, gen_CopyB);
     be_set_transform_function(op_Address, gen_Address);
     be_set_transform_function(op_Member, gen_Member);
     // Compare or Conditional
@@ -960,10 +2308,13 @@ static void loongarch64_register_transformers(void) {
     be_set_transform_function(op_Call, gen_Call);
     be_set_transform_function(op_Return, gen_Return);
     // Misc
+    be_set_transform_function(op_ASM, gen_ASM);
+    be_set_transform_function(op_Builtin, gen_Builtin);
     be_set_transform_function(op_Phi, gen_Phi);
     be_set_transform_function(op_Start, gen_Start);
     be_set_transform_function(op_Unknown, gen_Unknown);
     // Projection
+    be_set_transform_proj_function(op_Builtin, gen_Proj_Builtin);
     be_set_transform_proj_function(op_Call, gen_Proj_Call);
     be_set_transform_proj_function(op_Div, gen_Proj_Div);
     be_set_transform_proj_function(op_Load, gen_Proj_Load);
@@ -977,21 +2328,30 @@ static void loongarch64_register_transformers(void) {
  * Transform generic IR-nodes into loongarch64 machine instructions
  */
 void loongarch64_transform_graph(ir_graph *irg) {
-    assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_TUPLES | IR_GRAPH_PROPERTY_NO_BADS);
+    assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_TUPLES | IR_GRAPH_PROPERTY_NO_BADS | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
 
     loongarch64_register_transformers();
 
     set_allocatable_regs(irg);
     be_stack_init(&stack_env);
-    ir_entity *const fun_ent  = get_irg_entity(irg);
-    ir_type *const   fun_type = get_entity_type(fun_ent);
-    setup_calling_convention(&cconv, fun_type);
-    layout_parameter_entities(&cconv, irg);
-    be_add_parameter_entity_stores(irg);
+    ir_type *const fun_type = get_entity_type(get_irg_entity(irg));
+    size_t const   n_named  = get_method_n_params(fun_type);
+    ir_type       *cc_type  = fun_type;
+    if (is_method_variadic(fun_type)) {
+        setup_calling_convention(&cconv, fun_type, n_named);
+        cc_type = add_unnamed_register_params(fun_type, cconv.va_first_slot);
+        free_calling_convention(&cconv);
+    }
+    setup_calling_convention(&cconv, cc_type, n_named);
+    layout_parameter_entities(&cconv, irg, cc_type);
+    add_parameter_entity_stores(&cconv, irg);
 
     be_transform_graph(irg, NULL);
+    store_unnamed_register_params(&cconv, irg);
 
     free_calling_convention(&cconv);
+    if (cc_type != fun_type)
+        free_type(cc_type);
     be_stack_finish(&stack_env);
 }
 
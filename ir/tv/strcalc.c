@@ -603,7 +603,7 @@ void sc_val_from_bytes(unsigned char const *const bytes, size_t n_bytes,
 	sc_word *p = buffer;
 	assert(SC_BITS == CHAR_BIT);
 	memcpy(p, bytes, n_bytes);
-	memset(p+n_bytes, 0, buffer+calc_buffer_size-p);
+	memset(p+n_bytes, 0, calc_buffer_size-n_bytes);
 }
 
 void sc_val_to_bytes(const sc_word *buffer, unsigned char *const dest,
@@ -0,0 +1,28 @@
+double axpy(double a, double x, double y) { return a * x + y; }
+
+float average(float *v, int n) {
+    float sum = 0.0f;
+    for (int i = 0; i < n; i++)
+        sum += v[i];
+    return sum / n;
+}
+
+double mix(int i, double a, long l, float f, unsigned long u) { return i + a + l + f + (double)u; }
+
+int less(double a, double b) { return a < b; }
+
+int main() {
+    float v[4] = {1.0f, 2.0f, 3.0f, 4.5f};
+
+    if (axpy(2.0, 3.0, 0.5) != 6.5)
+        return 1;
+    if (average(v, 4) != 2.625f)
+        return 2;
+    if (mix(1, 0.5, -4, 2.5f, 18446744073709551615UL) != 18446744073709551616.0)
+        return 3;
+    if (!less(-1.5, 1.0) || less(2.0, 2.0))
+        return 4;
+    if ((int)-7.9 != -7 || (unsigned long)1e19 != 10000000000000000000UL)
+        return 5;
+    return 0;
+}
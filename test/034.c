@@ -0,0 +1,54 @@
+enum { OP_PUSH, OP_ADD, OP_SUB, OP_MUL, OP_DUP, OP_SWAP, OP_NEG, OP_HALT };
+
+int run(const int *code) {
+    int stack[16];
+    int sp = 0;
+    for (int pc = 0;; pc++) {
+        switch (code[pc]) {
+        case OP_PUSH:
+            stack[sp++] = code[++pc];
+            break;
+        case OP_ADD:
+            sp--;
+            stack[sp - 1] += stack[sp];
+            break;
+        case OP_SUB:
+            sp--;
+            stack[sp - 1] -= stack[sp];
+            break;
+        case OP_MUL:
+            sp--;
+            stack[sp - 1] *= stack[sp];
+            break;
+        case OP_DUP:
+            stack[sp] = stack[sp - 1];
+            sp++;
+            break;
+        case OP_SWAP: {
+            int t         = stack[sp - 1];
+            stack[sp - 1] = stack[sp - 2];
+            stack[sp - 2] = t;
+            break;
+        }
+        case OP_NEG:
+            stack[sp - 1] = -stack[sp - 1];
+            break;
+        case OP_HALT:
+            return stack[sp - 1];
+        default:
+            return -1;
+        }
+    }
+}
+
+int main() {
+    // (3 + 4) * (3 + 4) - 10 = 39, then 2 - 39 = -37, negated = 37
+    int code[] = {OP_PUSH, 3, OP_PUSH, 4, OP_ADD, OP_DUP, OP_MUL, OP_PUSH, 10, OP_SUB,
+                  OP_PUSH, 2, OP_SWAP, OP_SUB, OP_NEG, OP_HALT};
+    int bad[]  = {OP_PUSH, 1, 42};
+    if (run(code) != 37)
+        return 1;
+    if (run(bad) != -1)
+        return 2;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <stdarg.h>
+
+struct pair {
+    long a;
+    long b;
+};
+
+struct big {
+    long v[4];
+};
+
+struct fpair {
+    double x;
+    double y;
+};
+
+struct mixed {
+    float f;
+    int i;
+};
+
+long sum(int n, ...) {
+    va_list ap;
+    va_start(ap, n);
+    long s = 0;
+    for (int i = 0; i < n; i++)
+        s += va_arg(ap, long);
+    va_end(ap);
+    return s;
+}
+
+double dsum(int n, ...) {
+    va_list ap;
+    va_start(ap, n);
+    double s = 0.0;
+    for (int i = 0; i < n; i++)
+        s += va_arg(ap, double);
+    va_end(ap);
+    return s;
+}
+
+long psum(int n, ...) {
+    va_list ap;
+    va_start(ap, n);
+    long s = 0;
+    for (int i = 0; i < n; i++) {
+        struct pair p = va_arg(ap, struct pair);
+        s += p.a - p.b;
+    }
+    va_end(ap);
+    return s;
+}
+
+struct pair make_pair(long a, long b) {
+    struct pair p = {a, b};
+    return p;
+}
+
+struct big make_big(long x) {
+    struct big r = {{x, x + 1, x + 2, x + 3}};
+    return r;
+}
+
+long big_sum(struct big b) { return b.v[0] + b.v[1] + b.v[2] + b.v[3]; }
+
+struct fpair scale(struct fpair p, double k) {
+    struct fpair r = {p.x * k, p.y * k};
+    return r;
+}
+
+struct mixed bump(struct mixed m) {
+    struct mixed r = {m.f + 1.0f, m.i + 1};
+    return r;
+}
+
+int main() {
+    double (*fp)(int, ...) = dsum;
+
+    if (sum(4, 1L, 2L, 3L, 4L) != 10)
+        return 1;
+    if (sum(10, 1L, 2L, 3L, 4L, 5L, 6L, 7L, 8L, 9L, 10L) != 55)
+        return 2;
+    if (dsum(3, 0.5, 1.5, 2.0) != 4.0)
+        return 3;
+    if (fp(2, 1.25, 2.5) != 3.75)
+        return 4;
+    struct pair p = make_pair(7, 3);
+    if (p.a != 7 || p.b != 3)
+        return 5;
+    if (psum(2, p, make_pair(10, 1)) != 13)
+        return 6;
+    if (big_sum(make_big(5)) != 26)
+        return 7;
+    struct fpair f = scale((struct fpair){1.5, -2.0}, 2.0);
+    if (f.x != 3.0 || f.y != -4.0)
+        return 8;
+    struct mixed m = bump((struct mixed){2.5f, 41});
+    if (m.f != 3.5f || m.i != 42)
+        return 9;
+    return 0;
+}
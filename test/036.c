@@ -0,0 +1,47 @@
+int data[16];
+
+int never(int x) { return x == 12345; }
+
+int main(int argc, char **argv) {
+    (void)argv;
+    volatile unsigned u = 0x00f00000u;
+    volatile unsigned long ul = 0x0000100000000000ul;
+
+    if (__builtin_clz(u) != 8)
+        return 1;
+    if (__builtin_clzl(ul) != 19)
+        return 2;
+    if (__builtin_ctz(u) != 20)
+        return 3;
+    if (__builtin_ctzl(ul) != 44)
+        return 4;
+    if (__builtin_ffs(0) != 0 || __builtin_ffs((int)u) != 21)
+        return 5;
+    if (__builtin_ffsl((long)ul) != 45)
+        return 6;
+    if (__builtin_popcount(u) != 4 || __builtin_popcountl(ul | 7) != 4)
+        return 7;
+    if (__builtin_parity(u) != 0 || __builtin_parityl(ul | 3) != 1)
+        return 8;
+    if (__builtin_bswap16((unsigned short)0x1234) != 0x3412)
+        return 9;
+    if (__builtin_bswap32(0x12345678u) != 0x78563412u)
+        return 10;
+    if (__builtin_bswap64(0x0102030405060708ul) != 0x0807060504030201ul)
+        return 11;
+
+    int s = 0;
+    for (int i = 0; i < 16; i++) {
+        __builtin_prefetch(&data[i + 4], 0);
+        __builtin_prefetch(&data[i], 1);
+        data[i] = i;
+        s += data[i];
+    }
+    if (s != 120)
+        return 12;
+
+    // Never taken, but the trap still has to be emitted.
+    if (never(argc))
+        __builtin_trap();
+    return 0;
+}
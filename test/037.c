@@ -0,0 +1,71 @@
+long cell = 40;
+
+long add(long a, long b) {
+    long r;
+    asm("add.d %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+    return r;
+}
+
+long add_imm(long a) {
+    long r;
+    asm("addi.d %0, %1, %2" : "=r"(r) : "r"(a), "I"(-7));
+    return r;
+}
+
+long mask(long a) {
+    long r;
+    asm("andi %0, %1, %2" : "=r"(r) : "r"(a), "K"(0xff));
+    return r;
+}
+
+long load(long *p) {
+    long r;
+    asm("ld.d %0, %1" : "=r"(r) : "m"(*p));
+    return r;
+}
+
+void store(long *p, long v) {
+    asm("st.d %z1, %0" : "=m"(*p) : "rJ"(v));
+}
+
+long twice(long a) {
+    asm("slli.d %0, %0, 1" : "+r"(a));
+    return a;
+}
+
+// The clobbered registers must be saved or left unused by the compiler.
+long clobber(long a) {
+    long b = a + 1;
+    asm volatile("li.d $t0, 0\n\tli.d $s0, 0\n\tli.d $a1, 0" : : : "t0", "s0", "a1", "memory");
+    return a + b;
+}
+
+double fadd(double a, double b) {
+    double r;
+    asm("fadd.d %0, %1, %2" : "=f"(r) : "f"(a), "f"(b));
+    return r;
+}
+
+int main() {
+    if (add(40, 2) != 42)
+        return 1;
+    if (add_imm(49) != 42)
+        return 2;
+    if (mask(0x12a) != 0x2a)
+        return 3;
+    if (load(&cell) != 40)
+        return 4;
+    store(&cell, 42);
+    if (cell != 42)
+        return 5;
+    store(&cell, 0);
+    if (cell != 0)
+        return 6;
+    if (twice(21) != 42)
+        return 7;
+    if (clobber(20) != 41)
+        return 8;
+    if (fadd(40.5, 1.5) != 42.0)
+        return 9;
+    return 0;
+}
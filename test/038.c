@@ -0,0 +1,37 @@
+// One long dependence chain and independent loads in the same block, for the
+// latency driven scheduler.
+
+#define STEP(x) x = x * 3 + (x >> 7) + 1;
+#define STEP4(x) STEP(x) STEP(x) STEP(x) STEP(x)
+#define STEP16(x) STEP4(x) STEP4(x) STEP4(x) STEP4(x)
+#define STEP64(x) STEP16(x) STEP16(x) STEP16(x) STEP16(x)
+#define STEP256(x) STEP64(x) STEP64(x) STEP64(x) STEP64(x)
+
+unsigned long chain(unsigned long x) {
+    STEP256(x) STEP256(x) STEP256(x) STEP256(x)
+    return x;
+}
+
+unsigned long chain_loop(unsigned long x) {
+    for (int i = 0; i < 1024; i++)
+        x = x * 3 + (x >> 7) + 1;
+    return x;
+}
+
+long mixed(long const *a, long b) {
+    long const c = b * b;
+    long const d = c * b;
+    long const e = d / 7;
+    return a[0] + a[1] * e + a[2] - a[3] * c + (a[4] ^ d);
+}
+
+int main() {
+    if (chain(12345) != chain_loop(12345))
+        return 1;
+    if (chain(0) != chain_loop(0))
+        return 2;
+    long a[5] = {1, 2, 3, 4, 5};
+    if (mixed(a, 3) != 1 + 2 * 3 + 3 - 4 * 9 + (5 ^ 27))
+        return 3;
+    return 0;
+}
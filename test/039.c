@@ -0,0 +1,54 @@
+// Values live across calls are spilled and reloaded, which gives the peephole
+// pass stores to forward to loads, copies and extensions to remove.
+
+long id(long x) { return x; }
+
+double did(double x) { return x; }
+
+long pressure(long a, long b) {
+    long v0 = a + 1, v1 = a + 2, v2 = a + 3, v3 = a + 4, v4 = a + 5, v5 = a + 6;
+    long v6 = b + 1, v7 = b + 2, v8 = b + 3, v9 = b + 4, v10 = b + 5, v11 = b + 6;
+    long s = id(v0 ^ v11);
+    s += id(v1 * v10) + id(v2 - v9);
+    s += v3 + v4 + v5 + v6 + v7 + v8 + v9 + v10 + v11 + v0 + v1 + v2;
+    return s;
+}
+
+double fpressure(double a, double b) {
+    float  f0 = (float)a, f1 = (float)b;
+    double d0 = a * 2, d1 = b * 3, d2 = a + b, d3 = a - b;
+    double s = did(d0) + did(f0 * f1);
+    s += d0 + d1 + d2 + d3 + f0 + f1;
+    return s;
+}
+
+int narrow(signed char const *c, short const *h, unsigned char const *uc) {
+    int const a = c[0];
+    int const b = h[1];
+    unsigned const u = uc[2];
+    return (signed char)a + (short)b + (unsigned char)u;
+}
+
+long locals(int n) {
+    long buf[8];
+    for (int i = 0; i < 8; i++)
+        buf[i] = i * n;
+    long x = buf[3];
+    buf[3] = x + 1;
+    return buf[3] + buf[7];
+}
+
+int main() {
+    if (pressure(1, 10) != 161)
+        return 1;
+    if (fpressure(1.5, 2.0) != 3.0 + 3.0 + 3.0 + 6.0 + 3.5 - 0.5 + 1.5 + 2.0)
+        return 2;
+    signed char   c[1]  = {-5};
+    short         h[2]  = {0, -300};
+    unsigned char uc[3] = {0, 0, 200};
+    if (narrow(c, h, uc) != -5 - 300 + 200)
+        return 3;
+    if (locals(3) != 10 + 21)
+        return 4;
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Constants that need different li sequences and immediates of ALU operations.
+
+unsigned long c_min(void) { return 0x8000000000000000ul; }
+unsigned long c_lu32i(void) { return 0x0000000500000000ul; }
+unsigned long c_lu32i_neg(void) { return 0xfffff12300000000ul; }
+unsigned long c_lu52i(void) { return 0x1230000000000000ul; }
+unsigned long c_all(void) { return 0x123456789abcdef0ul; }
+long c_neg12(void) { return -2048; }
+unsigned long c_ori(void) { return 0xfff; }
+long c_lu12i(void) { return 0x7ffff000; }
+unsigned c_u32(void) { return 0x80000000u; }
+
+long add_big(long x) { return x + 0x12345678; }
+long add_hi(long x) { return x + 0x7fff0000; }
+long add_neg(long x) { return x - 0x10000; }
+long and_imm(long x) { return x & 0xabc; }
+long or_imm(long x) { return x | 0x800; }
+long xor_imm(long x) { return x ^ 0xfff; }
+int slt_imm(long x) { return x < -5; }
+int sltu_imm(unsigned long x) { return x < 100; }
+long mul_imm(long x) { return x * 10; }
+
+int main() {
+    if (c_min() != 1ul << 63)
+        return 1;
+    if (c_lu32i() != 5ul << 32)
+        return 2;
+    if (c_lu32i_neg() >> 32 != 0xfffff123ul || (unsigned)c_lu32i_neg() != 0)
+        return 3;
+    if (c_lu52i() >> 52 != 0x123 || (c_lu52i() & ((1ul << 52) - 1)) != 0)
+        return 4;
+    if ((c_all() >> 32) != 0x12345678 || (unsigned)c_all() != 0x9abcdef0u)
+        return 5;
+    if (c_neg12() + 2048 != 0 || c_ori() != 4095 || c_lu12i() != 2147479552)
+        return 6;
+    if (c_u32() >> 31 != 1 || (unsigned long)c_u32() != 2147483648ul)
+        return 7;
+    if (add_big(1) != 305419897 || add_hi(0) != 2147418112 || add_neg(0) != -65536)
+        return 8;
+    if (and_imm(0xffff) != 0xabc || or_imm(1) != 0x801 || xor_imm(0xf0f) != 0x0f0)
+        return 9;
+    if (slt_imm(-6) != 1 || slt_imm(-5) != 0 || sltu_imm(99) != 1 || sltu_imm(-1ul) != 0)
+        return 10;
+    if (mul_imm(-7) != -70)
+        return 11;
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Struct copies of odd sizes, which LSX/LASX copy with overlapping vectors.
+
+#define COPY(n)                                                                                                        \
+    struct s##n {                                                                                                      \
+        unsigned char b[n];                                                                                            \
+    };                                                                                                                 \
+    void copy##n(struct s##n *d, struct s##n const *s) { *d = *s; }                                                    \
+    int check##n(void) {                                                                                               \
+        struct s##n src, dst;                                                                                          \
+        for (int i = 0; i < n; i++) {                                                                                  \
+            src.b[i] = (unsigned char)(i * 7 + 1);                                                                     \
+            dst.b[i] = 0;                                                                                              \
+        }                                                                                                              \
+        copy##n(&dst, &src);                                                                                           \
+        for (int i = 0; i < n; i++) {                                                                                  \
+            if (dst.b[i] != (unsigned char)(i * 7 + 1))                                                                \
+                return 1;                                                                                              \
+        }                                                                                                              \
+        return 0;                                                                                                      \
+    }
+
+COPY(9)
+COPY(16)
+COPY(17)
+COPY(31)
+COPY(33)
+COPY(48)
+COPY(65)
+COPY(100)
+COPY(255)
+COPY(513)
+
+// The copy must not touch the bytes around the destination.
+struct guarded {
+    unsigned char before[3];
+    struct s33    v;
+    unsigned char after[3];
+};
+
+int main() {
+    if (check9() || check16() || check17())
+        return 1;
+    if (check31() || check33() || check48())
+        return 2;
+    if (check65() || check100() || check255() || check513())
+        return 3;
+    struct guarded g = {{1, 2, 3}, {{0}}, {4, 5, 6}};
+    struct s33     s;
+    for (int i = 0; i < 33; i++)
+        s.b[i] = 0xaa;
+    copy33(&g.v, &s);
+    if (g.before[2] != 3 || g.after[0] != 4 || g.v.b[0] != 0xaa || g.v.b[32] != 0xaa)
+        return 4;
+    return 0;
+}
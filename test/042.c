@@ -0,0 +1,57 @@
+// Compares against zero, setcc with slt/sltu and selects.
+
+int lt(long a, long b) { return a < b; }
+int ge(long a, long b) { return a >= b; }
+int ltu(unsigned long a, unsigned long b) { return a < b; }
+int geu(unsigned long a, unsigned long b) { return a >= b; }
+int eq(int a, int b) { return a == b; }
+int ne(int a, int b) { return a != b; }
+int eqz(long a) { return a == 0; }
+int nez(long a) { return a != 0; }
+int ltz(long a) { return a < 0; }
+int gtz(long a) { return a > 0; }
+int lti(long a) { return a < 100; }
+int gtui(unsigned a) { return a > 7u; }
+
+long max(long a, long b) { return a > b ? a : b; }
+unsigned long minu(unsigned long a, unsigned long b) { return a < b ? a : b; }
+long sel0(long c, long a) { return c ? a : 0; }
+long sel0n(long c, long a) { return c ? 0 : a; }
+long sel(int c, long a, long b) { return c == 3 ? a : b; }
+long absv(long a) { return a < 0 ? -a : a; }
+
+int count_zero(long const *a, int n) {
+    int c = 0;
+    for (int i = 0; i < n; i++) {
+        if (a[i] == 0)
+            c++;
+        else if (a[i] < 0)
+            c += 10;
+    }
+    return c;
+}
+
+int main() {
+    if (lt(-1, 0) != 1 || lt(0, -1) != 0 || ge(5, 5) != 1 || ge(4, 5) != 0)
+        return 1;
+    if (ltu(1, -1ul) != 1 || ltu(-1ul, 1) != 0 || geu(-1ul, 1) != 1 || geu(0, 1) != 0)
+        return 2;
+    if (eq(3, 3) != 1 || eq(3, 4) != 0 || ne(3, 4) != 1 || ne(-2, -2) != 0)
+        return 3;
+    if (eqz(0) != 1 || eqz(5) != 0 || nez(-5) != 1 || nez(0) != 0)
+        return 4;
+    if (ltz(-1) != 1 || ltz(0) != 0 || gtz(1) != 1 || gtz(0) != 0 || gtz(-3) != 0)
+        return 5;
+    if (lti(99) != 1 || lti(100) != 0 || gtui(8) != 1 || gtui(7) != 0 || gtui(-1u) != 1)
+        return 6;
+    if (max(-3, 2) != 2 || max(7, -7) != 7 || minu(-1ul, 3) != 3 || minu(2, 9) != 2)
+        return 7;
+    if (sel0(1, 42) != 42 || sel0(0, 42) != 0 || sel0n(1, 42) != 0 || sel0n(0, 42) != 42)
+        return 8;
+    if (sel(3, 1, 2) != 1 || sel(4, 1, 2) != 2 || absv(-9) != 9 || absv(9) != 9)
+        return 9;
+    long a[6] = {0, 1, -1, 0, 5, -7};
+    if (count_zero(a, 6) != 22)
+        return 10;
+    return 0;
+}
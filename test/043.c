@@ -0,0 +1,52 @@
+// Early returns that do not need the stack frame, so the frame is only set up
+// on the paths with calls or stack accesses.
+
+int calls;
+
+long leaf(long x) { return x * 2; }
+
+long work(long x) {
+    calls++;
+    return x + 100;
+}
+
+long early(long x) {
+    if (x < 0)
+        return -1;
+    if (x == 0)
+        return 0;
+    long const a = work(x);
+    long const b = work(a);
+    return a + b + x;
+}
+
+long early_local(int n) {
+    if (n <= 0)
+        return n;
+    long buf[16];
+    for (int i = 0; i < 16; i++)
+        buf[i] = i + n;
+    return buf[n & 15];
+}
+
+long both(long x, long y) {
+    if (x == y)
+        return leaf(x);
+    if (x > y)
+        return work(x) - y;
+    return work(y) - x;
+}
+
+int main() {
+    if (early(-5) != -1 || early(0) != 0 || calls != 0)
+        return 1;
+    if (early(1) != 101 + 201 + 1 || calls != 2)
+        return 2;
+    if (early_local(-3) != -3 || early_local(0) != 0 || early_local(5) != 10 || early_local(17) != 18)
+        return 3;
+    if (both(4, 4) != 8 || calls != 2)
+        return 4;
+    if (both(9, 4) != 105 || both(4, 9) != 105 || calls != 4)
+        return 5;
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Sibling calls, which jump to the callee instead of calling it. Calls with
+// stack arguments stay normal calls.
+
+long add3(long a, long b, long c) { return a + b + c; }
+
+double fma3(double a, double b, double c) { return a * b + c; }
+
+long many(long a, long b, long c, long d, long e, long f, long g, long h, long i, long j) {
+    return a + 2 * b + 3 * c + 4 * d + 5 * e + 6 * f + 7 * g + 8 * h + 9 * i + 10 * j;
+}
+
+long tail_reg(long x, long y) { return add3(y, x, 1); }
+
+double tail_fp(double x) { return fma3(x, x, 0.5); }
+
+long tail_stack(long x) { return many(x, x, x, x, x, x, x, x, x + 1, x + 2); }
+
+long (*volatile fptr)(long, long, long) = add3;
+
+long tail_ptr(long x) { return fptr(x, x, x); }
+
+// The argument is in the frame of the caller, which survives the tail call.
+long from_stack(long a, long b, long c, long d, long e, long f, long g, long h, long i) {
+    return add3(a, h, i);
+}
+
+long count(long n, long acc) {
+    if (n == 0)
+        return acc;
+    return count(n - 1, acc + n);
+}
+
+int main() {
+    if (tail_reg(2, 3) != 6)
+        return 1;
+    if (tail_fp(2.0) != 4.5)
+        return 2;
+    if (tail_stack(1) != 55 + 9 + 20)
+        return 3;
+    if (tail_ptr(7) != 21)
+        return 4;
+    if (from_stack(1, 2, 3, 4, 5, 6, 7, 8, 9) != 18)
+        return 5;
+    if (count(100000, 0) != 5000050000)
+        return 6;
+    return 0;
+}
@@ -0,0 +1,35 @@
+// Compare-and-swap of 32 and 64 bit values, including unsigned values with the
+// sign bit set, which ll.w loads sign extended.
+
+unsigned u = 0x80000000u;
+int      i = -5;
+long     l = 0x123456789l;
+
+unsigned long set_flag(unsigned *p, unsigned flag) {
+    unsigned old;
+    do {
+        old = *p;
+    } while (!__sync_bool_compare_and_swap(p, old, old | flag));
+    return old;
+}
+
+int main() {
+    if (!__sync_bool_compare_and_swap(&u, 0x80000000u, 0xfffffff0u) || u != 0xfffffff0u)
+        return 1;
+    if (__sync_bool_compare_and_swap(&u, 0x80000000u, 1u) || u != 0xfffffff0u)
+        return 2;
+    unsigned long const old = __sync_val_compare_and_swap(&u, 0xfffffff0u, 0x80000001u);
+    if (old != 0xfffffff0ul || u != 0x80000001u)
+        return 3;
+    if (set_flag(&u, 0x40000000u) != 0x80000001ul || u != 0xc0000001u)
+        return 4;
+    if (!__sync_bool_compare_and_swap(&i, -5, 7) || i != 7)
+        return 5;
+    if (__sync_val_compare_and_swap(&i, 8, 9) != 7 || i != 7)
+        return 6;
+    if (!__sync_bool_compare_and_swap(&l, 0x123456789l, -1l) || l != -1)
+        return 7;
+    if (__sync_val_compare_and_swap(&l, -1l, 0x8000000000000000l) != -1 || l != (long)0x8000000000000000ul)
+        return 8;
+    return 0;
+}
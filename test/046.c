@@ -0,0 +1,37 @@
+// Global data and functions accessed through the GOT and PLT. Run it with
+// `-fPIC`.
+
+#include <stdio.h>
+
+long        counter  = 10;
+static long hidden   = 20;
+long        table[4] = {1, 2, 3, 4};
+char const *message  = "pic";
+
+__attribute__((visibility("hidden"))) long local_sym = 30;
+
+long bump(long x) {
+    counter += x;
+    return counter;
+}
+
+static long twice(long x) { return 2 * x; }
+
+long (*pick(int which))(long) { return which ? bump : twice; }
+
+long *slot(int i) { return &table[i]; }
+
+int main() {
+    if (bump(5) != 15 || counter != 15)
+        return 1;
+    if (pick(0)(hidden) != 40 || pick(1)(1) != 16)
+        return 2;
+    *slot(2) += local_sym;
+    if (table[2] != 33 || slot(3) - slot(0) != 3)
+        return 3;
+    if (message[0] != 'p' || message[2] != 'c')
+        return 4;
+    if (printf("%s %ld\n", message, table[2]) != 7)
+        return 5;
+    return 0;
+}
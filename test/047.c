@@ -0,0 +1,39 @@
+// Thread-local variables. Run it as it is and as `./run-cparser.sh 047 -fPIC`,
+// which reaches them through `__tls_get_addr`.
+
+__thread long        counter = 5;
+static __thread int  hidden;
+__thread char        name[4] = "tls";
+__thread long        array[8];
+
+long *counter_address(void) { return &counter; }
+
+long bump(long x) {
+    counter += x;
+    ++hidden;
+    return counter;
+}
+
+long sum(void) {
+    long s = 0;
+    for (int i = 0; i < 8; ++i) {
+        array[i] = i * counter;
+        s += array[i];
+    }
+    return s;
+}
+
+int main() {
+    if (counter != 5 || hidden != 0)
+        return 1;
+    if (bump(3) != 8 || bump(-1) != 7 || hidden != 2)
+        return 2;
+    *counter_address() = 10;
+    if (counter != 10 || counter_address() != &counter)
+        return 3;
+    if (sum() != 280 || array[7] != 70)
+        return 4;
+    if (name[0] != 't' || name[2] != 's' || name[3] != 0)
+        return 5;
+    return 0;
+}
@@ -0,0 +1,43 @@
+// Values that live in callee-saved registers across calls on one path only,
+// which then joins a path without calls. Run it with `-g` to emit the call
+// frame information, which has to agree on both paths into the join.
+
+int calls;
+
+long work(long x) {
+    calls++;
+    return x + 1;
+}
+
+long join(long x, long y, int slow) {
+    long r = x ^ y;
+    if (slow) {
+        long const a = work(x);
+        long const b = work(y);
+        r += a * b + x - y;
+    } else {
+        r += x + y;
+    }
+    return r * 2 + x;
+}
+
+long join_loop(long n) {
+    long s = 0;
+    for (long i = 0; i < n; ++i) {
+        if (i & 1)
+            s += work(i) + n;
+        else
+            s -= i;
+    }
+    return s + n;
+}
+
+int main() {
+    if (join(3, 5, 0) != 31 || calls != 0)
+        return 1;
+    if (join(3, 5, 1) != 59 || calls != 2)
+        return 2;
+    if (join_loop(6) != 30 || calls != 5)
+        return 3;
+    return 0;
+}
@@ -0,0 +1,43 @@
+// Narrow values live across calls. There are more of them than callee-saved
+// registers, so some are spilled with stores of their own width and reloaded
+// with the load, which extends them again.
+
+int calls;
+
+long touch(long x) {
+    calls++;
+    return x;
+}
+
+long narrow(signed char *c, unsigned short *h, int *w, unsigned *u, float *f) {
+    signed char    c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3];
+    unsigned short h0 = h[0], h1 = h[1], h2 = h[2], h3 = h[3];
+    int            w0 = w[0], w1 = w[1], w2 = w[2], w3 = w[3];
+    unsigned       u0 = u[0], u1 = u[1], u2 = u[2], u3 = u[3];
+    float          f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4], f5 = f[5], f6 = f[6], f7 = f[7],
+                   f8 = f[8], f9 = f[9];
+    long s = touch(1);
+    s += c0 + c1 + c2 + c3;
+    s += h0 + h1 + h2 + h3;
+    s += (long)w0 + w1 + w2 + w3;
+    s += (long)u0 + u1 + u2 + u3;
+    s += (long)(f0 + f1 + f2 + f3 + f4 + f5 + f6 + f7 + f8 + f9);
+    s += touch(c0) + touch(h3) + touch(w1) + touch(u2) + touch((long)f9);
+    return s;
+}
+
+int main() {
+    signed char    c[4] = {-1, -128, 127, 5};
+    unsigned short h[4] = {65535, 1, 32768, 7};
+    int            w[4] = {-1, -2147483647 - 1, 2147483647, 9};
+    unsigned       u[4] = {4294967295u, 2147483648u, 1, 11};
+    float          f[10];
+    for (int i = 0; i < 10; ++i)
+        f[i] = i + 0.5f;
+    long const r = narrow(c, h, w, u, f);
+    if (calls != 6)
+        return 1;
+    if (r != 1 + 3 + 98311 + 7 + 6442450955L + 50 + (-1 + 7 - 2147483648L + 1 + 9))
+        return 2;
+    return 0;
+}
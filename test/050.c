@@ -0,0 +1,89 @@
+// Register pressure for the linear scan allocator: more values than registers
+// live across calls and loops, loop-carried values which swap their places,
+// so the copies on the back edge form cycles, and float-point values next to
+// integer ones.
+
+int calls;
+
+unsigned mix(unsigned x) {
+    calls++;
+    return x * 2654435761u ^ x >> 7;
+}
+
+double scale(double x) {
+    calls++;
+    return x * 0.5;
+}
+
+unsigned rotate(unsigned a, unsigned b, unsigned c, unsigned d, int n) {
+    unsigned e = a ^ c, f = b + d;
+    for (int i = 0; i < n; ++i) {
+        unsigned const t = a;
+        a = b;
+        b = c;
+        c = d;
+        d = t + i;
+        unsigned const u = e;
+        e = f;
+        f = u;
+    }
+    return a * 1 + b * 3 + c * 5 + d * 7 + e * 11 + f * 13;
+}
+
+unsigned pressure(unsigned const *v, int n) {
+    unsigned v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3], v4 = v[4], v5 = v[5], v6 = v[6], v7 = v[7], v8 = v[8],
+             v9 = v[9], v10 = v[10], v11 = v[11], v12 = v[12], v13 = v[13], v14 = v[14], v15 = v[15], v16 = v[16],
+             v17 = v[17], v18 = v[18], v19 = v[19];
+    unsigned s = 0;
+    for (int i = 0; i < n; ++i) {
+        s += mix(s + i);
+        if (i & 1) {
+            v0 += v19;
+            v5 ^= v14;
+            v10 += mix(v3);
+        } else {
+            v1 -= v18;
+            v15 ^= v4;
+            v11 += mix(v7);
+        }
+        s += v0 ^ v1 ^ v2 ^ v3 ^ v4 ^ v5 ^ v6 ^ v7 ^ v8 ^ v9;
+    }
+    return s + v0 + v1 * 3 + v2 + v3 * 5 + v4 + v5 * 7 + v6 + v7 * 11 + v8 + v9 * 13 + v10 + v11 * 17 + v12 +
+           v13 * 19 + v14 + v15 * 23 + v16 + v17 * 29 + v18 + v19 * 31;
+}
+
+double fpressure(double const *d, long k) {
+    double d0 = d[0], d1 = d[1], d2 = d[2], d3 = d[3], d4 = d[4], d5 = d[5], d6 = d[6], d7 = d[7], d8 = d[8],
+           d9 = d[9], d10 = d[10], d11 = d[11];
+    long   l0 = k, l1 = k + 1, l2 = k * 3;
+    double s  = scale(d0 + d11);
+    for (int i = 0; i < 4; ++i) {
+        double const t = d0;
+        d0 = d1;
+        d1 = d2;
+        d2 = t;
+        s += scale(d3 + i) + l0;
+        l0 += l1;
+        l1 += l2;
+    }
+    return s + d0 + d1 * 2 + d2 * 4 + d3 + d4 + d5 + d6 + d7 + d8 + d9 + d10 + d11 + (double)(l0 + l1 + l2);
+}
+
+int main() {
+    unsigned v[20];
+    double   d[12];
+    for (int i = 0; i < 20; ++i)
+        v[i] = i * 0x01010101u + 3;
+    for (int i = 0; i < 12; ++i)
+        d[i] = i + 0.25;
+
+    if (rotate(1, 2, 3, 4, 10) != 337)
+        return 1;
+    if (pressure(v, 16) != 1357371740u)
+        return 2;
+    if (fpressure(d, 5) != 403.25)
+        return 3;
+    if (calls != 5 + 32)
+        return 4;
+    return 0;
+}
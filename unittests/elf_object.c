@@ -0,0 +1,187 @@
+#include "firm.h"
+#include "util.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+	EM_LOONGARCH       = 258,
+	SHT_SYMTAB         = 2,
+	SHT_RELA           = 4,
+	STB_GLOBAL         = 1,
+	STT_OBJECT         = 1,
+	STT_FUNC           = 2,
+	R_LARCH_B26        = 66,
+	R_LARCH_PCALA_HI20 = 71,
+	R_LARCH_PCALA_LO12 = 72,
+};
+
+static unsigned char *image;
+static size_t         image_size;
+
+static uint64_t get_u(size_t const offset, unsigned const size)
+{
+	assert(offset + size <= image_size);
+	uint64_t res = 0;
+	for (unsigned i = size; i-- > 0;)
+		res = res << 8 | image[offset + i];
+	return res;
+}
+
+static size_t get_shdr(unsigned const idx)
+{
+	return get_u(0x28, 8) + idx * get_u(0x3A, 2);
+}
+
+static char const *get_str(unsigned const strtab, size_t const offset)
+{
+	return (char const*)&image[get_u(get_shdr(strtab) + 0x18, 8) + offset];
+}
+
+static unsigned find_section(char const *const name)
+{
+	unsigned const n_sections = get_u(0x3C, 2);
+	unsigned const shstrtab   = get_u(0x3E, 2);
+	for (unsigned i = 1; i < n_sections; ++i) {
+		if (strcmp(get_str(shstrtab, get_u(get_shdr(i), 4)), name) == 0)
+			return i;
+	}
+	return 0;
+}
+
+/** Returns the offset of the symbol table entry for @p name. */
+static size_t find_symbol(unsigned const symtab, char const *const name)
+{
+	size_t   const shdr   = get_shdr(symtab);
+	unsigned const strtab = get_u(shdr + 0x28, 4);
+	size_t   const begin  = get_u(shdr + 0x18, 8);
+	size_t   const end    = begin + get_u(shdr + 0x20, 8);
+	for (size_t sym = begin; sym < end; sym += 24) {
+		if (strcmp(get_str(strtab, get_u(sym, 4)), name) == 0)
+			return sym;
+	}
+	return 0;
+}
+
+/** Returns whether @p rela contains a relocation of @p type against the
+ * symbol with index @p sym_idx. */
+static bool has_relocation(unsigned const rela, uint64_t const sym_idx,
+                           uint32_t const type)
+{
+	size_t const shdr  = get_shdr(rela);
+	size_t const begin = get_u(shdr + 0x18, 8);
+	size_t const end   = begin + get_u(shdr + 0x20, 8);
+	for (size_t r = begin; r < end; r += 24) {
+		uint64_t const info = get_u(r + 8, 8);
+		if (info >> 32 == sym_idx && (uint32_t)info == type)
+			return true;
+	}
+	return false;
+}
+
+/* int counter = 41; int get(void) { return ext(counter) + 1; } */
+static void build_program(void)
+{
+	ir_type *const type_int = get_type_for_mode(mode_Is);
+	ir_type *const glob     = get_glob_type();
+
+	ir_entity *const counter = new_global_entity(glob, new_id_from_str("counter"), type_int, ir_visibility_external, IR_LINKAGE_DEFAULT);
+	set_entity_initializer(counter, create_initializer_tarval(new_tarval_from_long(41, mode_Is)));
+
+	ir_type *const ext_type = new_type_method(1, 1, false, cc_cdecl_set, mtp_no_property);
+	set_method_param_type(ext_type, 0, type_int);
+	set_method_res_type(ext_type, 0, type_int);
+	ir_entity *const ext = new_global_entity(glob, new_id_from_str("ext"), ext_type, ir_visibility_external, IR_LINKAGE_DEFAULT);
+
+	ir_type *const get_type = new_type_method(0, 1, false, cc_cdecl_set, mtp_no_property);
+	set_method_res_type(get_type, 0, type_int);
+	ir_entity *const get = new_global_entity(glob, new_id_from_str("get"), get_type, ir_visibility_external, IR_LINKAGE_DEFAULT);
+
+	ir_graph *const irg = new_ir_graph(get, 0);
+	set_current_ir_graph(irg);
+	ir_node *const load     = new_Load(get_store(), new_Address(counter), mode_Is, type_int, cons_none);
+	ir_node *const value    = new_Proj(load, mode_Is, pn_Load_res);
+	set_store(new_Proj(load, mode_M, pn_Load_M));
+	ir_node *const call_in[] = { value };
+	ir_node *const call     = new_Call(get_store(), new_Address(ext), ARRAY_SIZE(call_in), call_in, ext_type);
+	set_store(new_Proj(call, mode_M, pn_Call_M));
+	ir_node *const results  = new_Proj(call, mode_T, pn_Call_T_result);
+	ir_node *const result   = new_Proj(results, mode_Is, 0);
+	ir_node *const sum      = new_Add(result, new_Const_long(mode_Is, 1));
+	ir_node *const ret_in[] = { sum };
+	ir_node *const ret      = new_Return(get_store(), ARRAY_SIZE(ret_in), ret_in);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_cur_block());
+	irg_finalize_cons(irg);
+}
+
+int main(void)
+{
+	ir_init();
+	if (!ir_target_set("loongarch64-linux-gnu"))
+		return 1;
+	ir_target_init();
+
+	build_program();
+	lower_highlevel();
+	be_lower_for_target();
+
+	FILE *const file = tmpfile();
+	assert(file != NULL);
+	int const written = be_main_object(file, "elf_object.c");
+	assert(written);
+	image_size = ftell(file);
+	image      = malloc(image_size);
+	rewind(file);
+	size_t const n_read = fread(image, 1, image_size, file);
+	assert(n_read == image_size);
+	fclose(file);
+
+	/* header: 64 bit little endian relocatable LoongArch object */
+	assert(memcmp(image, "\177ELF\2\1", 6) == 0);
+	assert(get_u(0x10, 2) == 1);
+	assert(get_u(0x12, 2) == EM_LOONGARCH);
+
+	unsigned const text   = find_section(".text");
+	unsigned const data   = find_section(".data");
+	unsigned const symtab = find_section(".symtab");
+	unsigned const rela   = find_section(".rela.text");
+	assert(text != 0 && data != 0 && symtab != 0 && rela != 0);
+	assert(get_u(get_shdr(symtab) + 4, 4) == SHT_SYMTAB);
+	assert(get_u(get_shdr(rela) + 4, 4) == SHT_RELA);
+	assert(get_u(get_shdr(rela) + 0x28, 4) == symtab);
+	assert(get_u(get_shdr(rela) + 0x2C, 4) == text);
+	assert(get_u(get_shdr(text) + 0x20, 8) > 0);
+
+	size_t const get_sym = find_symbol(symtab, "get");
+	assert(get_sym != 0);
+	assert(image[get_sym + 4] == (STB_GLOBAL << 4 | STT_FUNC));
+	assert(get_u(get_sym + 6, 2) == text);
+	assert(get_u(get_sym + 16, 8) > 0);
+
+	size_t const counter_sym = find_symbol(symtab, "counter");
+	assert(counter_sym != 0);
+	assert(image[counter_sym + 4] == (STB_GLOBAL << 4 | STT_OBJECT));
+	assert(get_u(counter_sym + 6, 2) == data);
+	assert(get_u(counter_sym + 16, 8) == 4);
+	size_t const counter_data = get_u(get_shdr(data) + 0x18, 8) + get_u(counter_sym + 8, 8);
+	assert(get_u(counter_data, 4) == 41);
+
+	size_t const ext_sym = find_symbol(symtab, "ext");
+	assert(ext_sym != 0);
+	assert(get_u(ext_sym + 6, 2) == 0);
+
+	size_t const sym_begin = get_u(get_shdr(symtab) + 0x18, 8);
+	uint64_t const counter_idx = (counter_sym - sym_begin) / 24;
+	uint64_t const ext_idx     = (ext_sym - sym_begin) / 24;
+	assert(has_relocation(rela, counter_idx, R_LARCH_PCALA_HI20));
+	assert(has_relocation(rela, counter_idx, R_LARCH_PCALA_LO12));
+	assert(has_relocation(rela, ext_idx, R_LARCH_B26));
+
+	free(image);
+	ir_finish();
+	return 0;
+}